@@ -3,8 +3,21 @@ setlocal
 
 glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o solid_color_vert.spv solid_color.vert
 glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o solid_color_frag.spv solid_color.frag
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o material_frag.spv material.frag
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o material_bindless_frag.spv material_bindless.frag
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o virtual_texture_frag.spv virtual_texture.frag
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o fullscreen_vert.spv fullscreen.vert
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o present_frag.spv present.frag
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o fxaa_comp.spv fxaa.comp
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o smaa_edges_comp.spv smaa_edges.comp
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o smaa_weights_comp.spv smaa_weights.comp
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o smaa_blend_comp.spv smaa_blend.comp
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o easu_comp.spv easu.comp
+glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o rcas_comp.spv rcas.comp
 
 glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o triangle_without_vbo_vert.spv triangle_without_vbo.vert
 glslangValidator.exe --target-env opengl --client opengl100 --glsl-version 460 --entry-point main -o triangle_without_vbo_frag.spv triangle_without_vbo.frag
 
+REM Workshop reads modules from shaders.pack. Build the ShaderPack CMake target to regenerate it.
+
 endlocal
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 460
+
+layout(location = 0) out vec2 v_TexCoord;
+
+// Built-in output block has to be redeclared when the stage is linked into a separable program
+out gl_PerVertex {
+  vec4 gl_Position;
+};
+
+// One counter-clockwise triangle covering the viewport, drawn without vertex buffers
+void main() {
+  const vec2 texCoord = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  v_TexCoord = texCoord;
+  gl_Position = vec4(texCoord * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,32 @@
+#version 460
+#extension GL_ARB_bindless_texture : require
+
+layout(location = 0) in vec3 v_WorldPosition;
+layout(location = 1) in vec3 v_Normal;
+layout(location = 2) in vec2 v_TexCoord1;
+layout(location = 3) flat in uint v_MaterialId;
+
+layout (location = 0) out vec4 outColor;
+
+// See MaterialGpu in material.hpp. Same as material.frag, but texture arrays come from resident handles in the table,
+// so their number is not limited by texture units.
+struct Material {
+    vec4 baseColorFactor;
+    uint baseColorArray;
+    uint baseColorLayer;
+    uvec2 baseColorHandle;
+};
+
+layout(std430, binding = 2) readonly buffer MaterialTable {
+    Material materials[];
+} b_Materials;
+
+void main() {
+  const Material material = b_Materials.materials[v_MaterialId];
+  vec4 baseColor = material.baseColorFactor;
+  if (material.baseColorArray != 0xFFFFFFFFu)
+    baseColor *= texture(sampler2DArray(material.baseColorHandle), vec3(v_TexCoord1, float(material.baseColorLayer)));
+
+  const float diffuse = max(dot(normalize(v_Normal), normalize(vec3(1.0, 2.0, 1.0))), 0.0);
+  outColor = vec4(baseColor.rgb * (0.3 + 0.7 * diffuse), baseColor.a);
+}
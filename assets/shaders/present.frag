@@ -0,0 +1,11 @@
+#version 460
+
+layout(location = 0) in vec2 v_TexCoord;
+
+layout (location = 0) out vec4 outColor;
+
+layout(binding = 0) uniform sampler2D u_Color;
+
+void main() {
+  outColor = vec4(textureLod(u_Color, v_TexCoord, 0.0).rgb, 1.0);
+}
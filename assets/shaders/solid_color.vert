@@ -17,6 +17,13 @@ layout(std140, binding = 1) uniform PerObjectData {
 layout(location = 0) out vec3 v_WorldPosition;
 layout(location = 1) out vec3 v_Normal;
 layout(location = 2) out vec2 v_TexCoord1;
+// Draws pass their material ID as base instance
+layout(location = 3) flat out uint v_MaterialId;
+
+// Built-in output block has to be redeclared when the stage is linked into a separable program
+out gl_PerVertex {
+  vec4 gl_Position;
+};
 
 void main() {
   const vec4 worldPos = u_ObjectData.worldFromObject * vec4(a_Position, 1.0);
@@ -41,6 +48,7 @@ void main() {
   v_WorldPosition = vec3(worldPos);
   v_Normal = a_Normal;
   v_TexCoord1 = a_TexCoord1;
+  v_MaterialId = uint(gl_BaseInstance);
 
   gl_Position = fishEyePos;
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#version 460
+
+// Only fragments that pass the depth test should request pages
+layout(early_fragment_tests) in;
+
+layout(location = 0) in vec3 v_WorldPosition;
+layout(location = 1) in vec3 v_Normal;
+layout(location = 2) in vec2 v_TexCoord1;
+
+layout (location = 0) out vec4 outColor;
+
+// See virtual_texture.hpp
+const float kTileSize = 128.0;
+const float kTileBorder = 2.0;
+const float kTileStride = kTileSize + 2.0 * kTileBorder;
+
+layout(binding = 0) uniform sampler2D u_PhysicalTexture;
+
+layout(std430, binding = 0) readonly buffer VirtualTexturePageTable {
+    // width, height, number of levels, physical slots per side
+    uvec4 info;
+    // tilesX, tilesY, first page
+    uvec4 levels[16];
+    // slot x | slot y << 8 | resident level << 16 | resident bit
+    uint entries[];
+} b_PageTable;
+
+layout(std430, binding = 1) buffer VirtualTextureFeedback {
+    uint requested[];
+} b_Feedback;
+
+uint findPage(uint level, vec2 uv, out vec2 texelInTile) {
+  const uvec4 levelInfo = b_PageTable.levels[level];
+  const vec2 levelSize = max(floor(vec2(b_PageTable.info.xy) / exp2(float(level))), vec2(1.0));
+  const vec2 texel = uv * levelSize;
+  const uvec2 tile = min(uvec2(texel / kTileSize), levelInfo.xy - 1);
+  texelInTile = texel - vec2(tile) * kTileSize;
+  return levelInfo.z + tile.y * levelInfo.x + tile.x;
+}
+
+void main() {
+  const vec2 virtualTexel = v_TexCoord1 * vec2(b_PageTable.info.xy);
+  const vec2 dx = dFdx(virtualTexel);
+  const vec2 dy = dFdy(virtualTexel);
+  const float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy)));
+  const uint level = uint(clamp(lod, 0.0, float(b_PageTable.info.z - 1)));
+  const vec2 uv = fract(v_TexCoord1);
+
+  vec2 texelInTile;
+  const uint page = findPage(level, uv, texelInTile);
+  // Reading first keeps most fragments from writing
+  if (b_Feedback.requested[page] == 0)
+    b_Feedback.requested[page] = 1;
+
+  // Falls back to the closest resident ancestor
+  const uint entry = b_PageTable.entries[page];
+  const uint residentLevel = (entry >> 16) & 0xFF;
+  if (residentLevel != level)
+    findPage(residentLevel, uv, texelInTile);
+  const vec2 slot = vec2(entry & 0xFF, (entry >> 8) & 0xFF);
+  const vec2 physicalUv = (slot * kTileStride + kTileBorder + texelInTile) / (kTileStride * float(b_PageTable.info.w));
+  const vec3 albedo = textureLod(u_PhysicalTexture, physicalUv, 0.0).rgb;
+
+  const float diffuse = max(dot(normalize(v_Normal), normalize(vec3(1.0, 2.0, 1.0))), 0.0);
+  outColor = vec4(albedo * (0.3 + 0.7 * diffuse), 1);
+}
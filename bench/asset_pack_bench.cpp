@@ -0,0 +1,51 @@
+#include "asset_pack.hpp"
+#include "bench_common.hpp"
+#include "mesh.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <vector>
+
+namespace {
+// Vertex and index data of a welded mesh, which has about half as many vertices as triangles
+uint64_t getMeshBytes(int64_t numTriangles) {
+  return static_cast<uint64_t>(numTriangles) * (sizeof(Vertex) / 2 + 3 * sizeof(uint32_t));
+}
+
+// Args: triangles, for a file the size of such a mesh. The file is read once before timing, so this measures reads
+// from the page cache, not from the disk.
+void BM_ReadBinaryFile(benchmark::State& state) {
+  const uint64_t numBytes = getMeshBytes(state.range(0));
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / std::format("workshop_bench_{}.bin", numBytes);
+  {
+    std::ofstream file(path, std::ios::binary);
+    const std::vector<char> chunk(1 << 20, 'x');
+    for (uint64_t written = 0; written < numBytes; written += chunk.size())
+      file.write(chunk.data(), static_cast<std::streamsize>(std::min<uint64_t>(chunk.size(), numBytes - written)));
+  }
+  std::vector<std::byte> buffer;
+  readBinaryFile(path, buffer);
+  for (auto _ : state) {
+    if (!readBinaryFile(path, buffer)) {
+      state.SkipWithError("Reading the file failed");
+      break;
+    }
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  std::error_code error;
+  std::filesystem::remove(path, error);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * numBytes));
+}
+BENCHMARK(BM_ReadBinaryFile)
+    ->ArgName("triangles")
+    ->Arg(kTeapotTriangles)
+    ->Arg(1'000'000)
+    ->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace
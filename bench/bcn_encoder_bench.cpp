@@ -0,0 +1,86 @@
+#include "bcn_encoder.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+// Smooth color waves plus a little hash noise, closer to photographic content than a plain gradient
+std::vector<std::byte> makeTestImage(uint32_t width, uint32_t height, uint32_t numChannels) {
+  std::vector<std::byte> image(size_t{width} * height * numChannels);
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      for (uint32_t c = 0; c < numChannels; ++c) {
+        const uint32_t hash = (x * 73856093u) ^ (y * 19349663u) ^ (c * 83492791u);
+        const float wave = 127.5f + 120.f * std::sin(static_cast<float>(x) * 0.031f * static_cast<float>(c + 1) + static_cast<float>(y) * 0.017f);
+        image[(size_t{y} * width + x) * numChannels + c] = static_cast<std::byte>(std::clamp(static_cast<int>(wave) + static_cast<int>(hash & 7) - 4, 0, 255));
+      }
+    }
+  }
+  return image;
+}
+
+uint32_t getNumChannels(BcFormat format) {
+  switch (format) {
+    case BcFormat::BC4:
+      return 1;
+    case BcFormat::BC5:
+      return 2;
+    case BcFormat::BC1:
+      return 3;
+    default:
+      return 4;
+  }
+}
+
+// Over the channels the format stores
+double computePsnr(const std::vector<std::byte>& image, const std::vector<std::byte>& decodedRgba, uint32_t numChannels) {
+  double squaredError = 0.0;
+  const size_t numPixels = image.size() / numChannels;
+  for (size_t p = 0; p < numPixels; ++p) {
+    for (uint32_t c = 0; c < numChannels; ++c) {
+      const double diff = static_cast<double>(image[p * numChannels + c]) - static_cast<double>(decodedRgba[p * 4 + c]);
+      squaredError += diff * diff;
+    }
+  }
+  const double mse = squaredError / static_cast<double>(numPixels * numChannels);
+  return mse == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+JobSystem& getBenchJobSystem() {
+  static JobSystem jobs;
+  return jobs;
+}
+
+// Args: format, size (square), use SIMD, use job system. Reports PSNR of the decoded result as a counter.
+void BM_BcEncode(benchmark::State& state) {
+  const auto format = static_cast<BcFormat>(state.range(0));
+  const auto size = static_cast<uint32_t>(state.range(1));
+  BcEncoderOptions options;
+  options.allowSimd = state.range(2) != 0;
+  JobSystem* jobs = state.range(3) != 0 ? &getBenchJobSystem() : nullptr;
+  state.SetLabel(getBcFormatName(format));
+
+  const uint32_t numChannels = getNumChannels(format);
+  const std::vector<std::byte> image = makeTestImage(size, size, numChannels);
+  std::vector<std::byte> blocks(computeBcImageSize(format, size, size));
+  for (auto _ : state) {
+    encodeBcImage(format, image.data(), size, size, numChannels, blocks.data(), options, jobs);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size * size * numChannels);
+  state.counters["Mpix/s"] = benchmark::Counter(static_cast<double>(state.iterations()) * size * size / 1e6, benchmark::Counter::kIsRate);
+
+  std::vector<std::byte> decoded(size_t{size} * size * 4);
+  decodeBcImage(format, blocks.data(), size, size, decoded.data());
+  state.counters["psnr"] = computePsnr(image, decoded, numChannels);
+}
+BENCHMARK(BM_BcEncode)
+    ->ArgNames({"format", "size", "simd", "threads"})
+    ->ArgsProduct({{static_cast<int64_t>(BcFormat::BC1), static_cast<int64_t>(BcFormat::BC3), static_cast<int64_t>(BcFormat::BC4), static_cast<int64_t>(BcFormat::BC5), static_cast<int64_t>(BcFormat::BC7)}, {256, 1024}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+// Benchmarks that need OpenGL share one invisible window created in main. Works on software rasterizers like llvmpipe.
+bool hasBenchGlContext();
+
+// Triangles of assets/models/teapot/teapot.obj after triangulation. Mesh benchmarks run at this size, 1M and 10M
+// triangles, to show how they scale.
+constexpr int64_t kTeapotTriangles = 6320;
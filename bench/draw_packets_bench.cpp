@@ -0,0 +1,36 @@
+#include "draw_packets.hpp"
+#include "job_system.hpp"
+
+#include <benchmark/benchmark.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+// Args: objects, use job system. Records a packet per object and writes its matrix, like the scene pass in main.
+void BM_RecordDrawPackets(benchmark::State& state) {
+  const auto count = static_cast<uint32_t>(state.range(0));
+  JobSystem jobs;
+  JobSystem* recordJobs = state.range(1) != 0 ? &jobs : nullptr;
+  const std::vector<glm::mat4> worlds(count, glm::mat4{1.f});
+  std::vector<glm::mat4> objectData(count);
+  DrawPacketList list;
+  for (auto _ : state) {
+    recordDrawPackets(list, recordJobs, count, 256, [&](uint32_t begin, uint32_t end, std::vector<DrawPacket>& out) {
+      for (uint32_t ix = begin; ix < end; ++ix) {
+        objectData[ix] = worlds[ix];
+        out.push_back({.vertexArray = 1 + ix % 4, .positionVertexArray = 5 + ix % 4, .numIndices = 3 * 1024, .materialId = ix % 8, .objectIx = ix, .meshHandle = ix % 4});
+      }
+    });
+    benchmark::DoNotOptimize(list.chunks.data());
+    benchmark::DoNotOptimize(objectData.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+BENCHMARK(BM_RecordDrawPackets)
+    ->ArgNames({"objects", "threads"})
+    ->ArgsProduct({{81, 100'000}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+}  // namespace
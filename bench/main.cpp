@@ -0,0 +1,49 @@
+#include "bench_common.hpp"
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+#include <benchmark/benchmark.h>
+
+#include <print>
+
+namespace {
+GLFWwindow* gWindow{};
+}
+
+bool hasBenchGlContext() {
+  return gWindow != nullptr;
+}
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  if (glfwInit()) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    gWindow = glfwCreateWindow(64, 64, "WorkshopBench", nullptr, nullptr);
+    if (gWindow) {
+      glfwMakeContextCurrent(gWindow);
+      if (gladLoadGL(glfwGetProcAddress) == 0) {
+        glfwDestroyWindow(gWindow);
+        gWindow = nullptr;
+      } else {
+        std::println("GL benchmarks run on: {} {}", reinterpret_cast<const char*>(glGetString(GL_RENDERER)), reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+      }
+    }
+  }
+  if (!gWindow)
+    std::println("No OpenGL context, GL benchmarks will be skipped.");
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  if (gWindow)
+    glfwDestroyWindow(gWindow);
+  glfwTerminate();
+  return 0;
+}
@@ -0,0 +1,121 @@
+#include "matrix_batch.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+// Arg value 0 runs the plain glm loop the kernels replace, the others are MatrixIsa values
+constexpr int64_t kGlmLoop = 0;
+
+bool skipUnsupported(benchmark::State& state, int64_t isaArg) {
+  if (isaArg == kGlmLoop || isMatrixIsaSupported(static_cast<MatrixIsa>(isaArg)))
+    return false;
+  state.SkipWithError("Instruction set not supported by this CPU");
+  return true;
+}
+
+struct TrsArrays {
+  std::vector<glm::vec3> translations;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> scales;
+};
+
+TrsArrays makeTrsArrays(uint32_t count) {
+  TrsArrays trs;
+  for (uint32_t i = 0; i < count; ++i) {
+    const auto x = static_cast<float>(i);
+    trs.translations.emplace_back(x, 0.5f * x, -x);
+    trs.rotations.push_back(glm::angleAxis(0.01f * x, glm::normalize(glm::vec3{1.f, 2.f, 3.f})));
+    trs.scales.emplace_back(1.f + 0.001f * x);
+  }
+  return trs;
+}
+
+// Args: instruction set, matrices
+void BM_ComposeTrsMatrices(benchmark::State& state) {
+  const int64_t isaArg = state.range(0);
+  if (skipUnsupported(state, isaArg))
+    return;
+  const auto count = static_cast<uint32_t>(state.range(1));
+  const TrsArrays trs = makeTrsArrays(count);
+  std::vector<glm::mat4> out(count);
+  for (auto _ : state) {
+    if (isaArg == kGlmLoop) {
+      for (uint32_t i = 0; i < count; ++i)
+        out[i] = glm::translate(glm::mat4(1.f), trs.translations[i]) * glm::mat4_cast(trs.rotations[i]) * glm::scale(glm::mat4(1.f), trs.scales[i]);
+    } else
+      composeTrsMatrices(trs.translations.data(), trs.rotations.data(), trs.scales.data(), out.data(), count, static_cast<MatrixIsa>(isaArg));
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+  state.SetLabel(isaArg == kGlmLoop ? "glm" : getMatrixIsaName(static_cast<MatrixIsa>(isaArg)));
+}
+BENCHMARK(BM_ComposeTrsMatrices)
+    ->ArgNames({"isa", "count"})
+    ->ArgsProduct({{kGlmLoop, static_cast<int64_t>(MatrixIsa::Scalar), static_cast<int64_t>(MatrixIsa::Simd128), static_cast<int64_t>(MatrixIsa::Avx2), static_cast<int64_t>(MatrixIsa::Avx512)}, {1024, 1 << 20}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// View projection times world. Args: instruction set, matrices
+void BM_MultiplyMatrices(benchmark::State& state) {
+  const int64_t isaArg = state.range(0);
+  if (skipUnsupported(state, isaArg))
+    return;
+  const auto count = static_cast<uint32_t>(state.range(1));
+  const TrsArrays trs = makeTrsArrays(count);
+  std::vector<glm::mat4> worlds(count);
+  composeTrsMatrices(trs.translations.data(), trs.rotations.data(), trs.scales.data(), worlds.data(), count);
+  const glm::mat4 viewProjection = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f) * glm::lookAt(glm::vec3{6.f, 4.5f, 0.f}, glm::vec3{0.f}, glm::vec3{0.f, 1.f, 0.f});
+  std::vector<glm::mat4> out(count);
+  for (auto _ : state) {
+    if (isaArg == kGlmLoop) {
+      for (uint32_t i = 0; i < count; ++i)
+        out[i] = viewProjection * worlds[i];
+    } else
+      multiplyMatrices(viewProjection, worlds.data(), out.data(), count, static_cast<MatrixIsa>(isaArg));
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+  state.SetLabel(isaArg == kGlmLoop ? "glm" : getMatrixIsaName(static_cast<MatrixIsa>(isaArg)));
+}
+BENCHMARK(BM_MultiplyMatrices)
+    ->ArgNames({"isa", "count"})
+    ->ArgsProduct({{kGlmLoop, static_cast<int64_t>(MatrixIsa::Scalar), static_cast<int64_t>(MatrixIsa::Simd128), static_cast<int64_t>(MatrixIsa::Avx2), static_cast<int64_t>(MatrixIsa::Avx512)}, {1024, 1 << 20}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// Chains of four nodes below each root, parent times local. Args: instruction set, nodes
+void BM_MultiplyByParents(benchmark::State& state) {
+  const int64_t isaArg = state.range(0);
+  if (skipUnsupported(state, isaArg))
+    return;
+  const auto count = static_cast<uint32_t>(state.range(1));
+  const TrsArrays trs = makeTrsArrays(count);
+  std::vector<glm::mat4> locals(count), worlds(count);
+  composeTrsMatrices(trs.translations.data(), trs.rotations.data(), trs.scales.data(), locals.data(), count);
+  std::vector<int32_t> parents(count);
+  for (uint32_t i = 0; i < count; ++i)
+    parents[i] = i % 4 == 0 ? -1 : static_cast<int32_t>(i - 1);
+  for (auto _ : state) {
+    if (isaArg == kGlmLoop) {
+      for (uint32_t i = 0; i < count; ++i)
+        worlds[i] = parents[i] >= 0 ? worlds[static_cast<size_t>(parents[i])] * locals[i] : locals[i];
+    } else
+      multiplyByParents(parents.data(), locals.data(), worlds.data(), 0, count, static_cast<MatrixIsa>(isaArg));
+    benchmark::DoNotOptimize(worlds.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+  state.SetLabel(isaArg == kGlmLoop ? "glm" : getMatrixIsaName(static_cast<MatrixIsa>(isaArg)));
+}
+BENCHMARK(BM_MultiplyByParents)
+    ->ArgNames({"isa", "count"})
+    ->ArgsProduct({{kGlmLoop, static_cast<int64_t>(MatrixIsa::Scalar), static_cast<int64_t>(MatrixIsa::Simd128), static_cast<int64_t>(MatrixIsa::Avx2), static_cast<int64_t>(MatrixIsa::Avx512)}, {1024, 1 << 20}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+}  // namespace
@@ -0,0 +1,198 @@
+#include "bench_common.hpp"
+#include "job_system.hpp"
+#include "mesh.hpp"
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+uint32_t getQuadsPerSide(int64_t numTriangles) {
+  return static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(numTriangles) / 2.0)));
+}
+
+// Quads split into two triangles on the XZ plane, each interior vertex is shared by six triangles like in a welded mesh
+aiMesh* makeGridMesh(uint32_t quadsPerSide, float offset) {
+  auto* mesh = new aiMesh;
+  const uint32_t side = quadsPerSide + 1;
+  mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+  mesh->mNumVertices = side * side;
+  mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+  mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+  mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+  mesh->mNumUVComponents[0] = 2;
+  for (uint32_t y = 0; y < side; ++y) {
+    for (uint32_t x = 0; x < side; ++x) {
+      const uint32_t vertIx = y * side + x;
+      const float u = static_cast<float>(x) / static_cast<float>(quadsPerSide);
+      const float v = static_cast<float>(y) / static_cast<float>(quadsPerSide);
+      mesh->mVertices[vertIx] = {u + offset, 0.f, v};
+      mesh->mNormals[vertIx] = {0.f, 1.f, 0.f};
+      mesh->mTextureCoords[0][vertIx] = {u, v, 0.f};
+    }
+  }
+  mesh->mNumFaces = 2 * quadsPerSide * quadsPerSide;
+  mesh->mFaces = new aiFace[mesh->mNumFaces];
+  for (uint32_t y = 0; y < quadsPerSide; ++y) {
+    for (uint32_t x = 0; x < quadsPerSide; ++x) {
+      const uint32_t corner = y * side + x;
+      const uint32_t faceIx = 2 * (y * quadsPerSide + x);
+      for (const uint32_t triIx : {0u, 1u}) {
+        aiFace& face = mesh->mFaces[faceIx + triIx];
+        face.mNumIndices = 3;
+        face.mIndices = new unsigned int[3];
+        face.mIndices[0] = corner;
+        face.mIndices[1] = triIx == 0 ? corner + side : corner + side + 1;
+        face.mIndices[2] = triIx == 0 ? corner + side + 1 : corner + 1;
+      }
+    }
+  }
+  return mesh;
+}
+
+// Root node with one child node per mesh, the triangles are split evenly among the meshes
+std::unique_ptr<aiScene> makeGridScene(int64_t numTriangles, uint32_t numMeshes) {
+  auto scene = std::make_unique<aiScene>();
+  scene->mNumMaterials = 1;
+  scene->mMaterials = new aiMaterial*[1]{new aiMaterial};
+  scene->mNumMeshes = numMeshes;
+  scene->mMeshes = new aiMesh*[numMeshes];
+  scene->mRootNode = new aiNode("Root");
+  scene->mRootNode->mNumChildren = numMeshes;
+  scene->mRootNode->mChildren = new aiNode*[numMeshes];
+  const uint32_t quadsPerSide = getQuadsPerSide(numTriangles / numMeshes);
+  for (uint32_t meshIx = 0; meshIx < numMeshes; ++meshIx) {
+    scene->mMeshes[meshIx] = makeGridMesh(quadsPerSide, static_cast<float>(meshIx));
+    aiNode* node = new aiNode(std::format("Grid {}", meshIx));
+    node->mParent = scene->mRootNode;
+    node->mNumMeshes = 1;
+    node->mMeshes = new unsigned int[1]{meshIx};
+    scene->mRootNode->mChildren[meshIx] = node;
+  }
+  return scene;
+}
+
+uint64_t countTriangles(const aiScene& scene) {
+  uint64_t numTriangles = 0;
+  for (uint32_t meshIx = 0; meshIx < scene.mNumMeshes; ++meshIx)
+    numTriangles += scene.mMeshes[meshIx]->mNumFaces;
+  return numTriangles;
+}
+
+// Same grid as makeGridMesh, as OBJ text. The OBJ importer gives every face corner its own vertex, so welding has to
+// merge them again.
+std::string makeGridObj(int64_t numTriangles) {
+  const uint32_t quadsPerSide = getQuadsPerSide(numTriangles);
+  const uint32_t side = quadsPerSide + 1;
+  std::string obj;
+  for (uint32_t y = 0; y < side; ++y) {
+    for (uint32_t x = 0; x < side; ++x)
+      obj += std::format("v {} 0 {}\nvt {} {}\n", x, y, static_cast<float>(x) / static_cast<float>(quadsPerSide), static_cast<float>(y) / static_cast<float>(quadsPerSide));
+  }
+  // OBJ indices start at 1
+  for (uint32_t y = 0; y < quadsPerSide; ++y) {
+    for (uint32_t x = 0; x < quadsPerSide; ++x) {
+      const uint32_t corner = y * side + x + 1;
+      obj += std::format("f {0}/{0} {1}/{1} {2}/{2} {3}/{3}\n", corner, corner + side, corner + side + 1, corner + 1);
+    }
+  }
+  return obj;
+}
+
+// Post processing of the Workshop's model import, welding is optional
+unsigned int getImportFlags(bool weld) {
+  constexpr unsigned int kFlags = aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_CalcTangentSpace | aiProcess_SortByPType;
+  return weld ? kFlags | aiProcess_JoinIdenticalVertices : kFlags;
+}
+
+// Args: triangles
+void BM_ProcessMesh(benchmark::State& state) {
+  const std::unique_ptr<aiScene> scene = makeGridScene(state.range(0), 1);
+  for (auto _ : state) {
+    Mesh mesh = processMesh(scene->mMeshes[0], scene.get());
+    benchmark::DoNotOptimize(mesh.vertices.data());
+  }
+  state.counters["triangles"] = static_cast<double>(countTriangles(*scene));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * countTriangles(*scene)));
+}
+BENCHMARK(BM_ProcessMesh)
+    ->ArgName("triangles")
+    ->Arg(kTeapotTriangles)
+    ->Arg(1'000'000)
+    ->Arg(10'000'000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Args: triangles, meshes, use job system. Walks the node hierarchy and converts every mesh, as done after the import.
+void BM_LoadMeshesFromAiNode(benchmark::State& state) {
+  const std::unique_ptr<aiScene> scene = makeGridScene(state.range(0), static_cast<uint32_t>(state.range(1)));
+  JobSystem jobs;
+  JobSystem* meshJobs = state.range(2) != 0 ? &jobs : nullptr;
+  for (auto _ : state) {
+    std::vector<Mesh> meshes;
+    loadMeshesFromAiNode(scene->mRootNode, scene.get(), meshes, meshJobs);
+    benchmark::DoNotOptimize(meshes.data());
+  }
+  state.counters["triangles"] = static_cast<double>(countTriangles(*scene));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * countTriangles(*scene)));
+}
+BENCHMARK(BM_LoadMeshesFromAiNode)
+    ->ArgNames({"triangles", "meshes", "jobs"})
+    ->ArgsProduct({{kTeapotTriangles, 1'000'000, 10'000'000}, {1, 64}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Args: weld. The teapot the Workshop loads, welding is Assimp's aiProcess_JoinIdenticalVertices.
+void BM_ImportTeapot(benchmark::State& state) {
+  const std::filesystem::path modelFile = std::filesystem::path{ASSETS_DIR} / "models/teapot/teapot.obj";
+  const unsigned int flags = getImportFlags(state.range(0) != 0);
+  for (auto _ : state) {
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(modelFile.string(), flags);
+    if (scene == nullptr) {
+      state.SkipWithError(importer.GetErrorString());
+      return;
+    }
+    benchmark::DoNotOptimize(scene);
+  }
+}
+BENCHMARK(BM_ImportTeapot)
+    ->ArgName("weld")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Args: triangles, weld. Parsing is included, the difference between weld 0 and 1 is the cost of welding. 10M
+// triangles are left out, the OBJ text alone would take minutes to parse per iteration.
+void BM_ImportGridObj(benchmark::State& state) {
+  const std::string obj = makeGridObj(state.range(0));
+  const unsigned int flags = getImportFlags(state.range(1) != 0);
+  uint64_t numVertices = 0;
+  for (auto _ : state) {
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFileFromMemory(obj.data(), obj.size(), flags, "obj");
+    if (scene == nullptr) {
+      state.SkipWithError(importer.GetErrorString());
+      return;
+    }
+    numVertices = scene->mMeshes[0]->mNumVertices;
+    benchmark::DoNotOptimize(scene);
+  }
+  state.counters["vertices"] = static_cast<double>(numVertices);
+}
+BENCHMARK(BM_ImportGridObj)
+    ->ArgNames({"triangles", "weld"})
+    ->ArgsProduct({{kTeapotTriangles, 1'000'000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace
@@ -0,0 +1,83 @@
+#include "bench_common.hpp"
+#include "mip_generator.hpp"
+
+#include <glad/gl.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+// Smooth gradient plus hash noise, so that neither filter gets a trivially constant input
+std::vector<std::byte> makeTestMipChain(uint32_t width, uint32_t height, uint32_t numChannels, std::vector<MipLevel>& outLevels) {
+  outLevels = computeMipChainLayout(width, height, numChannels);
+  std::vector<std::byte> chain(computeMipChainSize(outLevels, numChannels));
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      for (uint32_t c = 0; c < numChannels; ++c) {
+        const uint32_t hash = (x * 73856093u) ^ (y * 19349663u) ^ (c * 83492791u);
+        chain[(size_t{y} * width + x) * numChannels + c] = static_cast<std::byte>((x + y + c * 64 + (hash & 31)) & 0xFF);
+      }
+    }
+  }
+  return chain;
+}
+
+JobSystem& getBenchJobSystem() {
+  static JobSystem jobs;
+  return jobs;
+}
+
+// Args: size (square), filter, use SIMD, use job system
+void BM_CpuMipChain(benchmark::State& state) {
+  const auto size = static_cast<uint32_t>(state.range(0));
+  MipGeneratorOptions options;
+  options.filter = static_cast<MipFilter>(state.range(1));
+  options.allowSimd = state.range(2) != 0;
+  JobSystem* jobs = state.range(3) != 0 ? &getBenchJobSystem() : nullptr;
+
+  std::vector<MipLevel> levels;
+  std::vector<std::byte> chain = makeTestMipChain(size, size, 4, levels);
+  for (auto _ : state) {
+    generateMipChain(chain, levels, 4, options, jobs);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size * size * 4);
+}
+BENCHMARK(BM_CpuMipChain)
+    ->ArgNames({"size", "kaiser", "simd", "threads"})
+    ->ArgsProduct({{256, 1000, 1024, 2048}, {0, 1}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Args: size (square). Same sRGB-correct downsampling done by the driver, timed until the GPU is done.
+void BM_GlGenerateMipmap(benchmark::State& state) {
+  if (!hasBenchGlContext()) {
+    state.SkipWithError("No OpenGL context");
+    return;
+  }
+  const auto size = static_cast<uint32_t>(state.range(0));
+  std::vector<MipLevel> levels;
+  const std::vector<std::byte> chain = makeTestMipChain(size, size, 4, levels);
+
+  GLuint texture{};
+  glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+  glTextureStorage2D(texture, static_cast<GLsizei>(levels.size()), GL_SRGB8_ALPHA8, static_cast<GLsizei>(size), static_cast<GLsizei>(size));
+  glTextureSubImage2D(texture, 0, 0, 0, static_cast<GLsizei>(size), static_cast<GLsizei>(size), GL_RGBA, GL_UNSIGNED_BYTE, chain.data());
+  glFinish();
+  for (auto _ : state) {
+    glGenerateTextureMipmap(texture);
+    glFinish();
+  }
+  glDeleteTextures(1, &texture);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size * size * 4);
+}
+BENCHMARK(BM_GlGenerateMipmap)
+    ->ArgName("size")
+    ->Arg(256)
+    ->Arg(1000)
+    ->Arg(1024)
+    ->Arg(2048)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace
@@ -0,0 +1,44 @@
+#include "job_system.hpp"
+#include "scene_graph.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace {
+// Roots with a chain of children below each, like the grid cells holding a model's node hierarchy
+SceneGraph makeSceneGraph(uint32_t numRoots, uint32_t depth) {
+  SceneGraph graph;
+  for (uint32_t rootIx = 0; rootIx < numRoots; ++rootIx) {
+    auto parent = static_cast<int32_t>(addSceneNode(graph, kNoParent, "Root", glm::vec3{static_cast<float>(rootIx), 0.f, 0.f}));
+    for (uint32_t level = 1; level < depth; ++level)
+      parent = static_cast<int32_t>(addSceneNode(graph, parent, "Child", glm::vec3{0.f, 1.f, 0.f}));
+  }
+  return graph;
+}
+
+// Args: roots, nodes per root, whether every root is dirtied each iteration, whether the update uses the job system
+void BM_UpdateWorldMatrices(benchmark::State& state) {
+  const auto numRoots = static_cast<uint32_t>(state.range(0));
+  const auto depth = static_cast<uint32_t>(state.range(1));
+  const bool dirty = state.range(2) != 0;
+  JobSystem jobs;
+  JobSystem* updateJobs = state.range(3) != 0 ? &jobs : nullptr;
+  SceneGraph graph = makeSceneGraph(numRoots, depth);
+  updateWorldMatrices(graph, updateJobs);
+  for (auto _ : state) {
+    if (dirty) {
+      for (const uint32_t root : graph.roots)
+        setLocalTranslation(graph, root, graph.translations[root]);
+    }
+    updateWorldMatrices(graph, updateJobs);
+    benchmark::DoNotOptimize(graph.worldMatrices.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * numRoots * depth);
+}
+BENCHMARK(BM_UpdateWorldMatrices)
+    ->ArgNames({"roots", "depth", "dirty", "threads"})
+    ->ArgsProduct({{81, 100'000}, {4}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+}  // namespace
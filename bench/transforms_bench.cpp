@@ -0,0 +1,25 @@
+#include "transforms.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+// Args: cells per side. 9 is the Workshop's grid, 1000 and 3163 give about 1M and 10M instances.
+void BM_MakeGridTransforms(benchmark::State& state) {
+  const auto cellCnt = static_cast<uint32_t>(state.range(0));
+  for (auto _ : state) {
+    std::vector<glm::mat4> transforms = makeGridTransforms(cellCnt, 2.f);
+    benchmark::DoNotOptimize(transforms.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * cellCnt * cellCnt);
+}
+BENCHMARK(BM_MakeGridTransforms)
+    ->ArgName("cells")
+    ->Arg(9)
+    ->Arg(1000)
+    ->Arg(3163)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+}  // namespace
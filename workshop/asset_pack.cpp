@@ -0,0 +1,205 @@
+#include "asset_pack.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <print>
+#include <string>
+
+bool readBinaryFile(const std::filesystem::path& path, std::vector<std::byte>& outBuffer) {
+  if (!std::filesystem::exists(path)) {
+    std::println("File does not exist: {}", path.string());
+    return false;
+  }
+  const auto fileSize = std::filesystem::file_size(path);
+  if (fileSize == 0) {
+    std::println("File is empty: {}", path.string());
+    return false;
+  }
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    std::println("Error opening shader file: {}", path.string());
+    return false;
+  }
+
+  file.seekg(0, std::ios::beg);
+  outBuffer.resize(fileSize);
+  file.read(reinterpret_cast<char*>(outBuffer.data()), fileSize);
+  file.close();
+
+  return true;
+}
+
+namespace {
+bool mapFile(const std::filesystem::path& path, AssetPack& pack) {
+#ifdef _WIN32
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER fileSize{};
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    CloseHandle(file);
+    return false;
+  }
+  const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  pack.fileHandle = file;
+  pack.mappingHandle = mapping;
+  pack.data = static_cast<const std::byte*>(view);
+  pack.size = static_cast<size_t>(fileSize.QuadPart);
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st{};
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  if (view == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  // Whole pack is going to be touched during startup, prefetch it in one go
+  madvise(view, static_cast<size_t>(st.st_size), MADV_WILLNEED);
+  pack.fileDescriptor = fd;
+  pack.data = static_cast<const std::byte*>(view);
+  pack.size = static_cast<size_t>(st.st_size);
+#endif
+  return true;
+}
+}  // namespace
+
+bool openAssetPack(const std::filesystem::path& path, AssetPack& outPack) {
+  if (!mapFile(path, outPack)) {
+    std::println("Error mapping asset pack: {}", path.string());
+    return false;
+  }
+
+  const auto fail = [&](std::string_view reason) {
+    std::println("Invalid asset pack {}: {}", path.string(), reason);
+    closeAssetPack(outPack);
+    return false;
+  };
+
+  if (outPack.size < sizeof(AssetPackHeader))
+    return fail("truncated header");
+  const auto* header = reinterpret_cast<const AssetPackHeader*>(outPack.data);
+  if (std::memcmp(header->magic, kAssetPackMagic, sizeof(kAssetPackMagic)) != 0)
+    return fail("bad magic");
+  if (header->version != kAssetPackVersion)
+    return fail("unsupported version");
+  if (outPack.size < sizeof(AssetPackHeader) + sizeof(AssetPackEntry) * header->entryCount)
+    return fail("truncated entry table");
+
+  const auto* entries = reinterpret_cast<const AssetPackEntry*>(outPack.data + sizeof(AssetPackHeader));
+  outPack.entries = {entries, header->entryCount};
+  for (const AssetPackEntry& entry : outPack.entries) {
+    if (entry.name[kAssetPackMaxNameLength - 1] != '\0')
+      return fail("unterminated entry name");
+    if (entry.offset > outPack.size || entry.size > outPack.size - entry.offset)
+      return fail("entry out of bounds");
+  }
+
+  std::println("Opened asset pack {} with {} entries.", path.string(), outPack.entries.size());
+  return true;
+}
+
+void closeAssetPack(AssetPack& pack) {
+#ifdef _WIN32
+  if (pack.data != nullptr)
+    UnmapViewOfFile(pack.data);
+  if (pack.mappingHandle != nullptr)
+    CloseHandle(pack.mappingHandle);
+  if (pack.fileHandle != nullptr)
+    CloseHandle(pack.fileHandle);
+#else
+  if (pack.data != nullptr)
+    munmap(const_cast<std::byte*>(pack.data), pack.size);
+  if (pack.fileDescriptor >= 0)
+    close(pack.fileDescriptor);
+#endif
+  pack = AssetPack{};
+}
+
+std::span<const std::byte> findAsset(const AssetPack& pack, std::string_view name) {
+  const auto it = std::ranges::lower_bound(pack.entries, name, {}, [](const AssetPackEntry& entry) { return std::string_view{entry.name}; });
+  if (it == pack.entries.end() || std::string_view{it->name} != name)
+    return {};
+  return {pack.data + it->offset, it->size};
+}
+
+bool writeAssetPack(const std::filesystem::path& outPath, const std::filesystem::path& dir, std::string_view extension) {
+  std::vector<std::filesystem::path> files;
+  for (const auto& dirEntry : std::filesystem::directory_iterator(dir)) {
+    if (dirEntry.is_regular_file() && dirEntry.path().extension() == extension)
+      files.push_back(dirEntry.path());
+  }
+  std::ranges::sort(files, {}, [](const std::filesystem::path& p) { return p.filename().string(); });
+
+  std::vector<AssetPackEntry> entries(files.size());
+  std::vector<std::vector<std::byte>> blobs(files.size());
+  uint64_t offset = sizeof(AssetPackHeader) + sizeof(AssetPackEntry) * entries.size();
+  for (size_t ix = 0; ix < files.size(); ++ix) {
+    const std::string name = files[ix].filename().string();
+    if (name.size() >= kAssetPackMaxNameLength) {
+      std::println("Asset name is too long: {}", name);
+      return false;
+    }
+    if (!readBinaryFile(files[ix], blobs[ix]))
+      return false;
+    AssetPackEntry& entry = entries[ix];
+    std::memset(&entry, 0, sizeof(entry));
+    std::memcpy(entry.name, name.data(), name.size());
+    offset = (offset + kAssetPackAlignment - 1) / kAssetPackAlignment * kAssetPackAlignment;
+    entry.offset = offset;
+    entry.size = blobs[ix].size();
+    offset += entry.size;
+  }
+
+  std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    std::println("Error opening asset pack for writing: {}", outPath.string());
+    return false;
+  }
+  AssetPackHeader header{};
+  std::memcpy(header.magic, kAssetPackMagic, sizeof(kAssetPackMagic));
+  header.version = kAssetPackVersion;
+  header.entryCount = static_cast<uint32_t>(entries.size());
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(sizeof(AssetPackEntry) * entries.size()));
+  for (size_t ix = 0; ix < entries.size(); ++ix) {
+    const auto padding = static_cast<size_t>(entries[ix].offset - static_cast<uint64_t>(out.tellp()));
+    static constexpr char zeros[kAssetPackAlignment]{};
+    out.write(zeros, static_cast<std::streamsize>(padding));
+    out.write(reinterpret_cast<const char*>(blobs[ix].data()), static_cast<std::streamsize>(blobs[ix].size()));
+  }
+  if (!out.good()) {
+    std::println("Error writing asset pack: {}", outPath.string());
+    return false;
+  }
+
+  std::println("Wrote {} assets into {} ({} bytes).", entries.size(), outPath.string(), offset);
+  return true;
+}
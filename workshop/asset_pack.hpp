@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+bool readBinaryFile(const std::filesystem::path& path, std::vector<std::byte>& outBuffer);
+
+// Pack file layout:
+//   AssetPackHeader | AssetPackEntry[entryCount] sorted by name | blobs, each aligned to kAssetPackAlignment
+// All offsets are from the beginning of the file.
+constexpr char kAssetPackMagic[4] = {'G', 'W', 'P', 'K'};
+constexpr uint32_t kAssetPackVersion = 1;
+constexpr uint32_t kAssetPackAlignment = 16;
+constexpr uint32_t kAssetPackMaxNameLength = 64;
+
+struct AssetPackHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t entryCount;
+  uint32_t reserved;
+};
+
+struct AssetPackEntry {
+  // null-terminated
+  char name[kAssetPackMaxNameLength];
+  uint64_t offset;
+  uint64_t size;
+};
+
+// Read-only pack file mapped into the address space. Assets are served as spans into the mapping, no copies are made.
+struct AssetPack {
+  const std::byte* data{};
+  size_t size{};
+  std::span<const AssetPackEntry> entries;
+#ifdef _WIN32
+  void* fileHandle{};
+  void* mappingHandle{};
+#else
+  int fileDescriptor{-1};
+#endif
+};
+
+bool openAssetPack(const std::filesystem::path& path, AssetPack& outPack);
+void closeAssetPack(AssetPack& pack);
+// Return empty span if there is no asset with given name
+std::span<const std::byte> findAsset(const AssetPack& pack, std::string_view name);
+
+// Pack all files in given directory with given extension into a single pack file. Assets are named by their file names.
+bool writeAssetPack(const std::filesystem::path& outPath, const std::filesystem::path& dir, std::string_view extension);
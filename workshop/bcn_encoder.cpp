@@ -0,0 +1,590 @@
+#include "bcn_encoder.hpp"
+
+#include "bcn_encoder_kernels.hpp"
+#include "cpu_features.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+float selectIndicesScalar(const BcBlockPixels& pixels, const BcPalette& palette, const float weights[4], uint8_t* outIndices) {
+  float totalError = 0.f;
+  for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+    float bestError = 3.4e38f;
+    uint8_t bestIndex = 0;
+    for (uint32_t e = 0; e < palette.numEntries; ++e) {
+      float error = 0.f;
+      for (uint32_t c = 0; c < 4; ++c) {
+        const float diff = pixels.c[c][i] - palette.c[c][e];
+        error += weights[c] * diff * diff;
+      }
+      if (error < bestError) {
+        bestError = error;
+        bestIndex = static_cast<uint8_t>(e);
+      }
+    }
+    outIndices[i] = bestIndex;
+    totalError += bestError;
+  }
+  return totalError;
+}
+
+// Little-endian bit stream of a single block
+struct BlockBitWriter {
+  uint8_t* out;
+  uint32_t bitPos{};
+
+  void write(uint32_t value, uint32_t numBits) {
+    for (uint32_t b = 0; b < numBits; ++b, ++bitPos) {
+      if ((value >> b) & 1u)
+        out[bitPos / 8] |= static_cast<uint8_t>(1u << (bitPos % 8));
+    }
+  }
+};
+
+struct BlockBitReader {
+  const uint8_t* in;
+  uint32_t bitPos{};
+
+  uint32_t read(uint32_t numBits) {
+    uint32_t value = 0;
+    for (uint32_t b = 0; b < numBits; ++b, ++bitPos)
+      value |= ((in[bitPos / 8] >> (bitPos % 8)) & 1u) << b;
+    return value;
+  }
+};
+
+void loadBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t numChannels, uint32_t blockX, uint32_t blockY, BcBlockPixels& out) {
+  for (uint32_t py = 0; py < 4; ++py) {
+    for (uint32_t px = 0; px < 4; ++px) {
+      const uint32_t x = std::min(blockX * 4 + px, width - 1);
+      const uint32_t y = std::min(blockY * 4 + py, height - 1);
+      const uint8_t* src = pixels + (size_t{y} * width + x) * numChannels;
+      const uint32_t i = py * 4 + px;
+      out.c[0][i] = src[0];
+      out.c[1][i] = numChannels >= 2 ? src[1] : src[0];
+      out.c[2][i] = numChannels >= 3 ? src[2] : (numChannels == 1 ? src[0] : 0.f);
+      out.c[3][i] = numChannels == 4 ? src[3] : 255.f;
+    }
+  }
+}
+
+void computePrincipalAxis(const BcBlockPixels& px, uint32_t numChannels, float mean[4], float axis[4]) {
+  for (uint32_t c = 0; c < 4; ++c) {
+    mean[c] = 0.f;
+    axis[c] = 0.f;
+  }
+  for (uint32_t c = 0; c < numChannels; ++c) {
+    for (uint32_t i = 0; i < kBcBlockPixels; ++i)
+      mean[c] += px.c[c][i];
+    mean[c] /= kBcBlockPixels;
+  }
+
+  float cov[4][4]{};
+  for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+    for (uint32_t a = 0; a < numChannels; ++a)
+      for (uint32_t b = a; b < numChannels; ++b)
+        cov[a][b] += (px.c[a][i] - mean[a]) * (px.c[b][i] - mean[b]);
+  }
+  for (uint32_t a = 0; a < numChannels; ++a)
+    for (uint32_t b = 0; b < a; ++b)
+      cov[a][b] = cov[b][a];
+
+  // Power iteration, starting from the covariance row of the channel with the largest variance
+  uint32_t start = 0;
+  for (uint32_t c = 1; c < numChannels; ++c)
+    if (cov[c][c] > cov[start][start])
+      start = c;
+  float v[4]{};
+  for (uint32_t c = 0; c < numChannels; ++c)
+    v[c] = cov[start][c];
+  for (uint32_t iter = 0; iter < 8; ++iter) {
+    float next[4]{};
+    for (uint32_t a = 0; a < numChannels; ++a)
+      for (uint32_t b = 0; b < numChannels; ++b)
+        next[a] += cov[a][b] * v[b];
+    float norm = 0.f;
+    for (uint32_t c = 0; c < numChannels; ++c)
+      norm += next[c] * next[c];
+    if (norm < 1e-12f)
+      break;
+    norm = 1.f / std::sqrt(norm);
+    for (uint32_t c = 0; c < numChannels; ++c)
+      v[c] = next[c] * norm;
+  }
+  float norm = 0.f;
+  for (uint32_t c = 0; c < numChannels; ++c)
+    norm += v[c] * v[c];
+  if (norm < 1e-12f) {
+    // Flat block, any axis works
+    for (uint32_t c = 0; c < numChannels; ++c)
+      axis[c] = 1.f / std::sqrt(static_cast<float>(numChannels));
+    return;
+  }
+  norm = 1.f / std::sqrt(norm);
+  for (uint32_t c = 0; c < numChannels; ++c)
+    axis[c] = v[c] * norm;
+}
+
+// Endpoints at the extents of the pixels projected onto the principal axis
+void computeAxisEndpoints(const BcBlockPixels& px, uint32_t firstChannel, uint32_t numChannels, float e0[4], float e1[4]) {
+  BcBlockPixels shifted{};
+  for (uint32_t c = 0; c < numChannels; ++c)
+    std::memcpy(shifted.c[c], px.c[firstChannel + c], sizeof(shifted.c[c]));
+  float mean[4], axis[4];
+  computePrincipalAxis(shifted, numChannels, mean, axis);
+  float tMin = 3.4e38f, tMax = -3.4e38f;
+  for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+    float t = 0.f;
+    for (uint32_t c = 0; c < numChannels; ++c)
+      t += (shifted.c[c][i] - mean[c]) * axis[c];
+    tMin = std::min(tMin, t);
+    tMax = std::max(tMax, t);
+  }
+  for (uint32_t c = 0; c < numChannels; ++c) {
+    e0[firstChannel + c] = std::clamp(mean[c] + axis[c] * tMax, 0.f, 255.f);
+    e1[firstChannel + c] = std::clamp(mean[c] + axis[c] * tMin, 0.f, 255.f);
+  }
+}
+
+// Endpoints minimizing sum_i (w_i * e0 + (1 - w_i) * e1 - x_i)^2 per channel, w_i being the weight of e0 for the index of
+// pixel i. Return false when all pixels use the same weight and the system is singular.
+bool solveEndpoints(const BcBlockPixels& px, const float* w, uint32_t firstChannel, uint32_t numChannels, float e0[4], float e1[4]) {
+  float saa = 0.f, sbb = 0.f, sab = 0.f;
+  for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+    saa += w[i] * w[i];
+    sbb += (1.f - w[i]) * (1.f - w[i]);
+    sab += w[i] * (1.f - w[i]);
+  }
+  const float det = saa * sbb - sab * sab;
+  if (std::abs(det) < 1e-6f)
+    return false;
+  for (uint32_t c = firstChannel; c < firstChannel + numChannels; ++c) {
+    float sax = 0.f, sbx = 0.f;
+    for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+      sax += w[i] * px.c[c][i];
+      sbx += (1.f - w[i]) * px.c[c][i];
+    }
+    e0[c] = std::clamp((sbb * sax - sab * sbx) / det, 0.f, 255.f);
+    e1[c] = std::clamp((saa * sbx - sab * sax) / det, 0.f, 255.f);
+  }
+  return true;
+}
+
+// BC1 -------------------------------------------------------------------------
+
+uint16_t packRgb565(const float rgb[3]) {
+  const auto r = static_cast<uint32_t>(std::lround(rgb[0] * 31.f / 255.f));
+  const auto g = static_cast<uint32_t>(std::lround(rgb[1] * 63.f / 255.f));
+  const auto b = static_cast<uint32_t>(std::lround(rgb[2] * 31.f / 255.f));
+  return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void unpackRgb565(uint16_t c, uint32_t rgb[3]) {
+  const uint32_t r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+  rgb[0] = (r << 3) | (r >> 2);
+  rgb[1] = (g << 2) | (g >> 4);
+  rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Four color mode, which is what c0 > c1 selects in BC1 and what BC3 always uses
+void computeBc1Colors(uint16_t c0, uint16_t c1, uint32_t colors[4][3]) {
+  unpackRgb565(c0, colors[0]);
+  unpackRgb565(c1, colors[1]);
+  for (uint32_t c = 0; c < 3; ++c) {
+    colors[2][c] = (2 * colors[0][c] + colors[1][c]) / 3;
+    colors[3][c] = (colors[0][c] + 2 * colors[1][c]) / 3;
+  }
+}
+
+constexpr float kBc1EndpointWeights[4] = {1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+
+void encodeBc1Block(const BcBlockPixels& px, uint8_t* out, const BcEncoderOptions& options, const BcKernels& kernels) {
+  constexpr float weights[4] = {1.f, 1.f, 1.f, 0.f};
+  uint16_t bestC0{}, bestC1{};
+  uint8_t bestIndices[kBcBlockPixels]{};
+  float bestError = 3.4e38f;
+  const auto evaluate = [&](const float e0[4], const float e1[4]) {
+    const uint16_t c0 = packRgb565(e0);
+    const uint16_t c1 = packRgb565(e1);
+    uint32_t colors[4][3];
+    computeBc1Colors(c0, c1, colors);
+    BcPalette palette{};
+    palette.numEntries = 4;
+    for (uint32_t e = 0; e < 4; ++e)
+      for (uint32_t c = 0; c < 3; ++c)
+        palette.c[c][e] = static_cast<float>(colors[e][c]);
+    uint8_t indices[kBcBlockPixels];
+    const float error = kernels.selectIndices(px, palette, weights, indices);
+    if (error < bestError) {
+      bestError = error;
+      bestC0 = c0;
+      bestC1 = c1;
+      std::memcpy(bestIndices, indices, sizeof(indices));
+    }
+  };
+
+  float e0[4]{}, e1[4]{};
+  computeAxisEndpoints(px, 0, 3, e0, e1);
+  evaluate(e0, e1);
+  for (uint32_t iter = 0; iter < options.refineIterations && bestError > 0.f; ++iter) {
+    float w[kBcBlockPixels];
+    for (uint32_t i = 0; i < kBcBlockPixels; ++i)
+      w[i] = kBc1EndpointWeights[bestIndices[i]];
+    if (!solveEndpoints(px, w, 0, 3, e0, e1))
+      break;
+    evaluate(e0, e1);
+  }
+
+  // Four color mode requires c0 > c1. Equal endpoints would select three color mode, where index 3 is black.
+  if (bestC0 == bestC1) {
+    std::ranges::fill(bestIndices, uint8_t{0});
+  } else if (bestC0 < bestC1) {
+    std::swap(bestC0, bestC1);
+    for (uint8_t& index : bestIndices)
+      index ^= 1;
+  }
+
+  std::memset(out, 0, 8);
+  BlockBitWriter writer{out};
+  writer.write(bestC0, 16);
+  writer.write(bestC1, 16);
+  for (const uint8_t index : bestIndices)
+    writer.write(index, 2);
+}
+
+void decodeBc1Block(const uint8_t* in, uint8_t rgba[kBcBlockPixels][4], bool alwaysFourColor) {
+  BlockBitReader reader{in};
+  const auto c0 = static_cast<uint16_t>(reader.read(16));
+  const auto c1 = static_cast<uint16_t>(reader.read(16));
+  uint32_t colors[4][3];
+  computeBc1Colors(c0, c1, colors);
+  const bool threeColor = !alwaysFourColor && c0 <= c1;
+  if (threeColor) {
+    for (uint32_t c = 0; c < 3; ++c) {
+      colors[2][c] = (colors[0][c] + colors[1][c]) / 2;
+      colors[3][c] = 0;
+    }
+  }
+  for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+    const uint32_t index = reader.read(2);
+    for (uint32_t c = 0; c < 3; ++c)
+      rgba[i][c] = static_cast<uint8_t>(colors[index][c]);
+    rgba[i][3] = threeColor && index == 3 ? 0 : 255;
+  }
+}
+
+// BC4 -------------------------------------------------------------------------
+
+// Eight value mode, selected by e0 > e1
+void computeBc4Values(uint32_t e0, uint32_t e1, uint32_t values[8]) {
+  values[0] = e0;
+  values[1] = e1;
+  for (uint32_t i = 1; i < 7; ++i)
+    values[i + 1] = ((7 - i) * e0 + i * e1 + 3) / 7;
+}
+
+float bc4EndpointWeight(uint32_t index) {
+  return index == 0 ? 1.f : (index == 1 ? 0.f : static_cast<float>(8 - index) / 7.f);
+}
+
+void encodeBc4Block(const BcBlockPixels& px, uint32_t channel, uint8_t* out, const BcEncoderOptions& options, const BcKernels& kernels) {
+  float weights[4]{};
+  weights[channel] = 1.f;
+  uint32_t bestE0{}, bestE1{};
+  uint8_t bestIndices[kBcBlockPixels]{};
+  float bestError = 3.4e38f;
+  const auto evaluate = [&](float e0f, float e1f) {
+    auto e0 = static_cast<uint32_t>(std::lround(e0f));
+    auto e1 = static_cast<uint32_t>(std::lround(e1f));
+    if (e0 < e1)
+      std::swap(e0, e1);
+    uint32_t values[8];
+    computeBc4Values(e0, e1, values);
+    BcPalette palette{};
+    // Equal endpoints select six value mode, where only index 0 is guaranteed to be e0
+    palette.numEntries = e0 == e1 ? 1 : 8;
+    for (uint32_t e = 0; e < palette.numEntries; ++e)
+      palette.c[channel][e] = static_cast<float>(values[e]);
+    uint8_t indices[kBcBlockPixels];
+    const float error = kernels.selectIndices(px, palette, weights, indices);
+    if (error < bestError) {
+      bestError = error;
+      bestE0 = e0;
+      bestE1 = e1;
+      std::memcpy(bestIndices, indices, sizeof(indices));
+    }
+  };
+
+  const auto [minIt, maxIt] = std::minmax_element(px.c[channel], px.c[channel] + kBcBlockPixels);
+  evaluate(*maxIt, *minIt);
+  for (uint32_t iter = 0; iter < options.refineIterations && bestError > 0.f; ++iter) {
+    float w[kBcBlockPixels];
+    for (uint32_t i = 0; i < kBcBlockPixels; ++i)
+      w[i] = bc4EndpointWeight(bestIndices[i]);
+    float e0[4]{}, e1[4]{};
+    if (!solveEndpoints(px, w, channel, 1, e0, e1))
+      break;
+    evaluate(e0[channel], e1[channel]);
+  }
+
+  std::memset(out, 0, 8);
+  BlockBitWriter writer{out};
+  writer.write(bestE0, 8);
+  writer.write(bestE1, 8);
+  for (const uint8_t index : bestIndices)
+    writer.write(index, 3);
+}
+
+void decodeBc4Block(const uint8_t* in, uint8_t values[kBcBlockPixels]) {
+  BlockBitReader reader{in};
+  const uint32_t e0 = reader.read(8);
+  const uint32_t e1 = reader.read(8);
+  uint32_t palette[8];
+  if (e0 > e1) {
+    computeBc4Values(e0, e1, palette);
+  } else {
+    palette[0] = e0;
+    palette[1] = e1;
+    for (uint32_t i = 1; i < 5; ++i)
+      palette[i + 1] = ((5 - i) * e0 + i * e1 + 2) / 5;
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+  for (uint32_t i = 0; i < kBcBlockPixels; ++i)
+    values[i] = static_cast<uint8_t>(palette[reader.read(3)]);
+}
+
+// BC7 mode 6 ------------------------------------------------------------------
+
+constexpr uint32_t kBc7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+uint32_t interpolateBc7(uint32_t e0, uint32_t e1, uint32_t weight) {
+  return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+void encodeBc7Block(const BcBlockPixels& px, uint8_t* out, const BcEncoderOptions& options, const BcKernels& kernels) {
+  constexpr float weights[4] = {1.f, 1.f, 1.f, 1.f};
+  // 7-bit endpoints per channel, one p-bit per endpoint
+  uint32_t bestQ0[4]{}, bestQ1[4]{};
+  uint32_t bestP0{}, bestP1{};
+  uint8_t bestIndices[kBcBlockPixels]{};
+  float bestError = 3.4e38f;
+  const auto evaluate = [&](const float e0[4], const float e1[4]) {
+    for (uint32_t p0 = 0; p0 < 2; ++p0) {
+      for (uint32_t p1 = 0; p1 < 2; ++p1) {
+        uint32_t q0[4], q1[4];
+        BcPalette palette{};
+        palette.numEntries = 16;
+        for (uint32_t c = 0; c < 4; ++c) {
+          q0[c] = static_cast<uint32_t>(std::clamp<long>(std::lround((e0[c] - static_cast<float>(p0)) / 2.f), 0, 127));
+          q1[c] = static_cast<uint32_t>(std::clamp<long>(std::lround((e1[c] - static_cast<float>(p1)) / 2.f), 0, 127));
+          const uint32_t v0 = (q0[c] << 1) | p0;
+          const uint32_t v1 = (q1[c] << 1) | p1;
+          for (uint32_t e = 0; e < 16; ++e)
+            palette.c[c][e] = static_cast<float>(interpolateBc7(v0, v1, kBc7Weights4[e]));
+        }
+        uint8_t indices[kBcBlockPixels];
+        const float error = kernels.selectIndices(px, palette, weights, indices);
+        if (error < bestError) {
+          bestError = error;
+          std::memcpy(bestQ0, q0, sizeof(q0));
+          std::memcpy(bestQ1, q1, sizeof(q1));
+          bestP0 = p0;
+          bestP1 = p1;
+          std::memcpy(bestIndices, indices, sizeof(indices));
+        }
+      }
+    }
+  };
+
+  float e0[4]{}, e1[4]{};
+  computeAxisEndpoints(px, 0, 4, e0, e1);
+  evaluate(e0, e1);
+  for (uint32_t iter = 0; iter < options.refineIterations && bestError > 0.f; ++iter) {
+    float w[kBcBlockPixels];
+    for (uint32_t i = 0; i < kBcBlockPixels; ++i)
+      w[i] = 1.f - static_cast<float>(kBc7Weights4[bestIndices[i]]) / 64.f;
+    if (!solveEndpoints(px, w, 0, 4, e0, e1))
+      break;
+    evaluate(e0, e1);
+  }
+
+  // Most significant bit of the first index is implicitly 0
+  if (bestIndices[0] & 8) {
+    std::swap(bestQ0, bestQ1);
+    std::swap(bestP0, bestP1);
+    for (uint8_t& index : bestIndices)
+      index = static_cast<uint8_t>(15 - index);
+  }
+
+  std::memset(out, 0, 16);
+  BlockBitWriter writer{out};
+  writer.write(1u << 6, 7);
+  for (uint32_t c = 0; c < 4; ++c) {
+    writer.write(bestQ0[c], 7);
+    writer.write(bestQ1[c], 7);
+  }
+  writer.write(bestP0, 1);
+  writer.write(bestP1, 1);
+  writer.write(bestIndices[0], 3);
+  for (uint32_t i = 1; i < kBcBlockPixels; ++i)
+    writer.write(bestIndices[i], 4);
+}
+
+void decodeBc7Block(const uint8_t* in, uint8_t rgba[kBcBlockPixels][4]) {
+  if ((in[0] & 0x7F) != (1u << 6)) {
+    for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+      rgba[i][0] = 255;
+      rgba[i][1] = 0;
+      rgba[i][2] = 255;
+      rgba[i][3] = 255;
+    }
+    return;
+  }
+  BlockBitReader reader{in, 7};
+  uint32_t q0[4], q1[4];
+  for (uint32_t c = 0; c < 4; ++c) {
+    q0[c] = reader.read(7);
+    q1[c] = reader.read(7);
+  }
+  const uint32_t p0 = reader.read(1);
+  const uint32_t p1 = reader.read(1);
+  for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+    const uint32_t index = reader.read(i == 0 ? 3 : 4);
+    for (uint32_t c = 0; c < 4; ++c)
+      rgba[i][c] = static_cast<uint8_t>(interpolateBc7((q0[c] << 1) | p0, (q1[c] << 1) | p1, kBc7Weights4[index]));
+  }
+}
+
+void encodeBlock(BcFormat format, const BcBlockPixels& px, uint8_t* out, const BcEncoderOptions& options, const BcKernels& kernels) {
+  switch (format) {
+    case BcFormat::BC1:
+      encodeBc1Block(px, out, options, kernels);
+      break;
+    case BcFormat::BC3:
+      encodeBc4Block(px, 3, out, options, kernels);
+      encodeBc1Block(px, out + 8, options, kernels);
+      break;
+    case BcFormat::BC4:
+      encodeBc4Block(px, 0, out, options, kernels);
+      break;
+    case BcFormat::BC5:
+      encodeBc4Block(px, 0, out, options, kernels);
+      encodeBc4Block(px, 1, out + 8, options, kernels);
+      break;
+    case BcFormat::BC7:
+      encodeBc7Block(px, out, options, kernels);
+      break;
+  }
+}
+
+void decodeBlock(BcFormat format, const uint8_t* in, uint8_t rgba[kBcBlockPixels][4]) {
+  uint8_t values[kBcBlockPixels];
+  switch (format) {
+    case BcFormat::BC1:
+      decodeBc1Block(in, rgba, false);
+      break;
+    case BcFormat::BC3:
+      decodeBc1Block(in + 8, rgba, true);
+      decodeBc4Block(in, values);
+      for (uint32_t i = 0; i < kBcBlockPixels; ++i)
+        rgba[i][3] = values[i];
+      break;
+    case BcFormat::BC4:
+      decodeBc4Block(in, values);
+      for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+        rgba[i][0] = values[i];
+        rgba[i][1] = rgba[i][2] = 0;
+        rgba[i][3] = 255;
+      }
+      break;
+    case BcFormat::BC5:
+      decodeBc4Block(in, values);
+      for (uint32_t i = 0; i < kBcBlockPixels; ++i)
+        rgba[i][0] = values[i];
+      decodeBc4Block(in + 8, values);
+      for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+        rgba[i][1] = values[i];
+        rgba[i][2] = 0;
+        rgba[i][3] = 255;
+      }
+      break;
+    case BcFormat::BC7:
+      decodeBc7Block(in, rgba);
+      break;
+  }
+}
+}  // namespace
+
+const BcKernels& getBcKernelsScalar() {
+  static constexpr BcKernels kernels{selectIndicesScalar};
+  return kernels;
+}
+
+const char* getBcFormatName(BcFormat format) {
+  switch (format) {
+    case BcFormat::BC1:
+      return "BC1";
+    case BcFormat::BC3:
+      return "BC3";
+    case BcFormat::BC4:
+      return "BC4";
+    case BcFormat::BC5:
+      return "BC5";
+    case BcFormat::BC7:
+      return "BC7";
+  }
+  return "?";
+}
+
+uint32_t getBcBlockBytes(BcFormat format) {
+  return format == BcFormat::BC1 || format == BcFormat::BC4 ? 8 : 16;
+}
+
+size_t computeBcImageSize(BcFormat format, uint32_t width, uint32_t height) {
+  return size_t{(width + 3) / 4} * ((height + 3) / 4) * getBcBlockBytes(format);
+}
+
+bool usesSimdBcKernels(const BcEncoderOptions& options) {
+  return options.allowSimd && getCpuFeatures().avx2 && getCpuFeatures().fma;
+}
+
+void encodeBcImage(BcFormat format, const std::byte* pixels, uint32_t width, uint32_t height, uint32_t numChannels, std::byte* outBlocks, const BcEncoderOptions& options, JobSystem* jobs) {
+  const BcKernels& kernels = usesSimdBcKernels(options) ? getBcKernelsAvx2() : getBcKernelsScalar();
+  const uint32_t blocksX = (width + 3) / 4;
+  const uint32_t blocksY = (height + 3) / 4;
+  const uint32_t blockBytes = getBcBlockBytes(format);
+  const auto* src = reinterpret_cast<const uint8_t*>(pixels);
+  auto* dst = reinterpret_cast<uint8_t*>(outBlocks);
+  parallelFor(jobs, blocksY, 4, [&](uint32_t blockYBegin, uint32_t blockYEnd) {
+    BcBlockPixels px;
+    for (uint32_t by = blockYBegin; by < blockYEnd; ++by) {
+      for (uint32_t bx = 0; bx < blocksX; ++bx) {
+        loadBlock(src, width, height, numChannels, bx, by, px);
+        encodeBlock(format, px, dst + (size_t{by} * blocksX + bx) * blockBytes, options, kernels);
+      }
+    }
+  });
+}
+
+void decodeBcImage(BcFormat format, const std::byte* blocks, uint32_t width, uint32_t height, std::byte* outRgba) {
+  const uint32_t blocksX = (width + 3) / 4;
+  const uint32_t blocksY = (height + 3) / 4;
+  const uint32_t blockBytes = getBcBlockBytes(format);
+  const auto* src = reinterpret_cast<const uint8_t*>(blocks);
+  auto* dst = reinterpret_cast<uint8_t*>(outRgba);
+  uint8_t rgba[kBcBlockPixels][4];
+  for (uint32_t by = 0; by < blocksY; ++by) {
+    for (uint32_t bx = 0; bx < blocksX; ++bx) {
+      decodeBlock(format, src + (size_t{by} * blocksX + bx) * blockBytes, rgba);
+      for (uint32_t i = 0; i < kBcBlockPixels; ++i) {
+        const uint32_t x = bx * 4 + i % 4;
+        const uint32_t y = by * 4 + i / 4;
+        if (x < width && y < height)
+          std::memcpy(dst + (size_t{y} * width + x) * 4, rgba[i], 4);
+      }
+    }
+  }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "job_system.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+enum class BcFormat : uint8_t {
+  // RGB, 4 bpp
+  BC1,
+  // RGBA, BC1 color + BC4 alpha, 8 bpp
+  BC3,
+  // R, 4 bpp. Masks, roughness
+  BC4,
+  // RG, two BC4 blocks, 8 bpp. Tangent space normals
+  BC5,
+  // RGBA, 8 bpp. Only mode 6 (single subset, 7-bit endpoints + p-bit, 4-bit indices) is emitted
+  BC7,
+};
+
+const char* getBcFormatName(BcFormat format);
+// 8 for BC1 and BC4, 16 for others. Blocks cover 4x4 texels.
+uint32_t getBcBlockBytes(BcFormat format);
+size_t computeBcImageSize(BcFormat format, uint32_t width, uint32_t height);
+
+struct BcEncoderOptions {
+  // Least squares endpoint refinement rounds after the initial principal axis fit
+  uint32_t refineIterations{2};
+  // Use AVX2 kernels when the CPU supports them
+  bool allowSimd{true};
+};
+
+// Whether encodeBcImage runs the AVX2 kernels. They round differently from the scalar ones, so blocks can differ.
+bool usesSimdBcKernels(const BcEncoderOptions& options);
+// Encode an 8-bit image with 1-4 channels. One channel replicates as gray, two channels are RG, missing alpha is opaque.
+// Edges of sizes that are not multiples of 4 are clamped. Block rows are split across the job system, which can be null.
+void encodeBcImage(BcFormat format, const std::byte* pixels, uint32_t width, uint32_t height, uint32_t numChannels, std::byte* outBlocks, const BcEncoderOptions& options, JobSystem* jobs);
+// Decode into 8-bit RGBA. For quality measurements, BC7 blocks other than mode 6 decode as opaque magenta.
+void decodeBcImage(BcFormat format, const std::byte* blocks, uint32_t width, uint32_t height, std::byte* outRgba);
@@ -0,0 +1,53 @@
+// Compiled with AVX2 and FMA enabled on x64. Only called after getCpuFeatures() confirmed support.
+#include "bcn_encoder_kernels.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+
+namespace {
+float selectIndicesAvx2(const BcBlockPixels& pixels, const BcPalette& palette, const float weights[4], uint8_t* outIndices) {
+  __m256 totalError = _mm256_setzero_ps();
+  // 8 pixels per register, two halves per block
+  for (uint32_t half = 0; half < 2; ++half) {
+    __m256 px[4];
+    for (uint32_t c = 0; c < 4; ++c)
+      px[c] = _mm256_load_ps(pixels.c[c] + half * 8);
+
+    __m256 bestError = _mm256_set1_ps(3.4e38f);
+    __m256i bestIndex = _mm256_setzero_si256();
+    for (uint32_t e = 0; e < palette.numEntries; ++e) {
+      __m256 error = _mm256_setzero_ps();
+      for (uint32_t c = 0; c < 4; ++c) {
+        if (weights[c] == 0.f)
+          continue;
+        const __m256 diff = _mm256_sub_ps(px[c], _mm256_set1_ps(palette.c[c][e]));
+        error = _mm256_fmadd_ps(_mm256_mul_ps(diff, diff), _mm256_set1_ps(weights[c]), error);
+      }
+      const __m256 better = _mm256_cmp_ps(error, bestError, _CMP_LT_OQ);
+      bestError = _mm256_blendv_ps(bestError, error, better);
+      bestIndex = _mm256_blendv_epi8(bestIndex, _mm256_set1_epi32(static_cast<int>(e)), _mm256_castps_si256(better));
+    }
+    totalError = _mm256_add_ps(totalError, bestError);
+
+    alignas(32) int32_t indices[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(indices), bestIndex);
+    for (uint32_t i = 0; i < 8; ++i)
+      outIndices[half * 8 + i] = static_cast<uint8_t>(indices[i]);
+  }
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(totalError), _mm256_extractf128_ps(totalError, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  return _mm_cvtss_f32(sum);
+}
+}  // namespace
+
+const BcKernels& getBcKernelsAvx2() {
+  static constexpr BcKernels kernels{selectIndicesAvx2};
+  return kernels;
+}
+#else
+// Other architectures get no AVX flags, and the CPU check never selects these
+const BcKernels& getBcKernelsAvx2() {
+  return getBcKernelsScalar();
+}
+#endif
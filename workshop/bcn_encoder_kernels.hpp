@@ -0,0 +1,27 @@
+#pragma once
+
+// Internal to bcn_encoder*.cpp. See mip_generator_kernels.hpp for why kernels are split per instruction set.
+
+#include <cstdint>
+
+constexpr uint32_t kBcBlockPixels = 16;
+constexpr uint32_t kBcMaxPaletteEntries = 16;
+
+// 4x4 block, channel-major, values in [0, 255]
+struct BcBlockPixels {
+  alignas(32) float c[4][kBcBlockPixels];
+};
+
+// Colors an index can select, channel-major
+struct BcPalette {
+  alignas(32) float c[4][kBcMaxPaletteEntries];
+  uint32_t numEntries{};
+};
+
+struct BcKernels {
+  // Pick the palette entry with the smallest channel-weighted squared distance for each pixel. Return the summed error.
+  float (*selectIndices)(const BcBlockPixels& pixels, const BcPalette& palette, const float weights[4], uint8_t* outIndices);
+};
+
+const BcKernels& getBcKernelsScalar();
+const BcKernels& getBcKernelsAvx2();
@@ -0,0 +1,176 @@
+#include "benchmark.hpp"
+
+#include "gpu_profiler.hpp"
+#include "json.hpp"
+#include "pipeline_statistics.hpp"
+#include "post_process.hpp"
+#include "startup_timeline.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <print>
+#include <string_view>
+
+namespace {
+template <typename T>
+bool parseNumber(std::string_view text, T& value) {
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc{} && end == text.data() + text.size();
+}
+
+void printUsage(const char* program) {
+  std::println("Usage: {} [--benchmark] [--warmup-frames N] [--frames N] [--time-step SECONDS] [--depth-prepass] [--msaa 1|2|4|8] [--post-aa none|fxaa|smaa] [--target-frame-ms MS] [--upscaler bilinear|fsr1] [--report PATH]", program);
+}
+
+std::string formatSummary(const std::vector<double>& samplesMs) {
+  const FrameTimeSummary summary = summarizeFrameTimes(samplesMs);
+  return std::format(R"({{"samples":{},"mean":{:.4f},"min":{:.4f},"max":{:.4f},"p50":{:.4f},"p95":{:.4f},"p99":{:.4f}}})", summary.numSamples, summary.meanMs, summary.minMs, summary.maxMs, summary.p50Ms, summary.p95Ms, summary.p99Ms);
+}
+
+std::string formatSamples(const std::vector<double>& samplesMs) {
+  std::string json = "[";
+  for (size_t sampleIx = 0; sampleIx < samplesMs.size(); ++sampleIx)
+    json += std::format("{}{:.4f}", sampleIx == 0 ? "" : ",", samplesMs[sampleIx]);
+  return json + "]";
+}
+}  // namespace
+
+bool parseBenchmarkOptions(int argc, char** argv, BenchmarkOptions& options) {
+  for (int argIx = 1; argIx < argc; ++argIx) {
+    const std::string_view arg = argv[argIx];
+    const std::string_view value = argIx + 1 < argc ? argv[argIx + 1] : "";
+    bool valid = true;
+    if (arg == "--benchmark" || arg == "--depth-prepass") {
+      (arg == "--benchmark" ? options.enabled : options.depthPrepass) = true;
+      continue;
+    }
+    if (arg == "--warmup-frames")
+      valid = parseNumber(value, options.warmupFrames);
+    else if (arg == "--frames")
+      valid = parseNumber(value, options.measuredFrames) && options.measuredFrames > 0;
+    else if (arg == "--time-step")
+      valid = parseNumber(value, options.timeStep) && options.timeStep >= 0.f;
+    else if (arg == "--msaa")
+      valid = parseNumber(value, options.msaaSamples) && std::has_single_bit(options.msaaSamples) && options.msaaSamples <= 8;
+    else if (arg == "--post-aa")
+      valid = parsePostAntiAliasing(value, options.postAntiAliasing);
+    else if (arg == "--target-frame-ms")
+      valid = parseNumber(value, options.targetFrameMs) && options.targetFrameMs >= 0.f;
+    else if (arg == "--upscaler")
+      valid = parseUpscaler(value, options.upscaler);
+    else if (arg == "--report") {
+      options.reportPath = value;
+      valid = !value.empty();
+    } else
+      valid = false;
+    if (!valid) {
+      std::println("Invalid argument: {} {}", arg, value);
+      printUsage(argv[0]);
+      return false;
+    }
+    ++argIx;
+  }
+  return true;
+}
+
+FrameTimeSummary summarizeFrameTimes(std::vector<double> samplesMs) {
+  FrameTimeSummary summary;
+  if (samplesMs.empty())
+    return summary;
+  std::ranges::sort(samplesMs);
+  const auto percentile = [&](double p) { return samplesMs[std::max<size_t>(static_cast<size_t>(std::ceil(p * static_cast<double>(samplesMs.size()))), 1) - 1]; };
+  double sum = 0.0;
+  for (const double ms : samplesMs)
+    sum += ms;
+  summary.numSamples = static_cast<uint32_t>(samplesMs.size());
+  summary.meanMs = sum / static_cast<double>(samplesMs.size());
+  summary.minMs = samplesMs.front();
+  summary.maxMs = samplesMs.back();
+  summary.p50Ms = percentile(0.5);
+  summary.p95Ms = percentile(0.95);
+  summary.p99Ms = percentile(0.99);
+  return summary;
+}
+
+bool writeBenchmarkReport(const BenchmarkReport& report) {
+  const std::filesystem::path& path = report.options.reportPath;
+  std::error_code error;
+  if (path.has_parent_path())
+    std::filesystem::create_directories(path.parent_path(), error);
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    std::println("Error creating benchmark report {}", path.string());
+    return false;
+  }
+
+  std::string json = "{\n";
+  json += std::format(R"(  "warmupFrames": {}, "measuredFrames": {}, "timeStep": {},)" "\n", report.options.warmupFrames, report.options.measuredFrames, report.options.timeStep);
+  json += std::format(R"(  "depthPrepass": {}, "msaaSamples": {}, "postAntiAliasing": "{}",)" "\n", report.options.depthPrepass, report.options.msaaSamples, getPostAntiAliasingName(report.options.postAntiAliasing));
+  json += std::format(R"(  "targetFrameMs": {}, "upscaler": "{}",)" "\n", report.options.targetFrameMs, getUpscalerName(report.options.upscaler));
+  json += std::format(R"(  "width": {}, "height": {}, "context": "{}",)" "\n", report.width, report.height, escapeJson(report.context));
+  json += std::format(R"(  "gl": {{"vendor": "{}", "renderer": "{}", "version": "{}"}},)" "\n", escapeJson(report.glVendor), escapeJson(report.glRenderer), escapeJson(report.glVersion));
+  json += std::format(R"(  "wallTimeSeconds": {:.3f},)" "\n", report.wallTimeSeconds);
+  json += std::format(R"(  "cpuFrameMs": {},)" "\n", formatSummary(report.cpuFrameTimesMs));
+  json += std::format(R"(  "gpuFrameMs": {}, "gpuDroppedFrames": {},)" "\n", formatSummary(report.gpuFrameTimesMs), report.gpuDroppedFrames);
+  json += std::format(R"(  "drawCalls": {}, "triangles": {},)" "\n", report.drawCalls, report.triangles);
+  json += std::format(R"(  "resolutionScale": {},)" "\n", formatSummary(report.resolutionScales));
+  json += R"(  "gpuPassMs": {)";
+  if (report.gpuProfiler != nullptr) {
+    bool firstZone = true;
+    for (const GpuZoneStats& zone : report.gpuProfiler->stats) {
+      const uint32_t numSamples = std::min(zone.numSamples, kGpuZoneHistorySize);
+      if (zone.depth != 1 || numSamples == 0)
+        continue;
+      double sumMs = 0.0;
+      for (uint32_t sampleIx = 0; sampleIx < numSamples; ++sampleIx)
+        sumMs += zone.historyMs[sampleIx];
+      json += std::format(R"({}"{}": {:.4f})", firstZone ? "" : ", ", escapeJson(zone.name), sumMs / numSamples);
+      firstZone = false;
+    }
+  }
+  json += "},\n";
+  json += R"(  "pipelineStatistics": {)";
+  if (report.pipelineStatistics != nullptr && report.pipelineStatistics->supported) {
+    bool firstPass = true;
+    for (const PipelineStatisticsPass& pass : report.pipelineStatistics->passes) {
+      if (pass.numSamples == 0)
+        continue;
+      json += std::format("{}\n    \"{}\": {{", firstPass ? "" : ",", escapeJson(pass.name));
+      for (size_t statisticIx = 0; statisticIx < kNumPipelineStatistics; ++statisticIx)
+        json += std::format(R"({}"{}": {:.1f})", statisticIx == 0 ? "" : ", ", getPipelineStatisticName(static_cast<PipelineStatistic>(statisticIx)), pass.sums[statisticIx] / static_cast<double>(pass.numSamples));
+      json += "}";
+      firstPass = false;
+    }
+    if (!firstPass)
+      json += "\n  ";
+  }
+  json += "},\n";
+  if (report.startupTimeline != nullptr) {
+    const StartupTimeline& timeline = *report.startupTimeline;
+    const int64_t endNs = timeline.firstSwapNs >= 0 ? timeline.firstSwapNs : timeline.mainStartNs;
+    json += std::format(R"(  "startup": {{"processToFirstFrameMs": {:.3f}, "phases": [)" "\n", getStartupMs(timeline, endNs));
+    const auto appendPhase = [&](const char* name, int64_t beginNs, int64_t phaseEndNs, bool last) {
+      json += std::format(R"(    {{"name": "{}", "startMs": {:.3f}, "durationMs": {:.3f}}}{})" "\n", escapeJson(name), getStartupMs(timeline, beginNs), static_cast<double>(phaseEndNs - beginNs) * 1e-6, last ? "" : ",");
+    };
+    appendPhase("Before main", timeline.processStartNs, timeline.mainStartNs, timeline.phases.empty());
+    for (size_t phaseIx = 0; phaseIx < timeline.phases.size(); ++phaseIx) {
+      const StartupPhase& phase = timeline.phases[phaseIx];
+      appendPhase(phase.name, phase.beginNs, phase.endNs, phaseIx + 1 == timeline.phases.size());
+    }
+    json += "  ]},\n";
+  }
+  json += std::format(R"(  "cpuFrameTimesMs": {},)" "\n", formatSamples(report.cpuFrameTimesMs));
+  json += std::format(R"(  "gpuFrameTimesMs": {})" "\n", formatSamples(report.gpuFrameTimesMs));
+  json += "}\n";
+  file << json;
+  if (!file) {
+    std::println("Error writing benchmark report {}", path.string());
+    return false;
+  }
+  std::println("Wrote benchmark report {}", path.string());
+  return true;
+}
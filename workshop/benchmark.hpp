@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct GpuProfiler;
+struct PipelineStatistics;
+struct StartupTimeline;
+enum class PostAntiAliasing : uint8_t;
+enum class Upscaler : uint8_t;
+
+struct BenchmarkOptions {
+  bool enabled{};
+  uint32_t warmupFrames{120};
+  uint32_t measuredFrames{600};
+  // Camera time advanced per frame, so every run renders the same sequence of views
+  float timeStep{1.f / 60.f};
+  // Lay down depth from the position-only stream first, then shade with GL_EQUAL
+  bool depthPrepass{};
+  // Of the scene render targets, clamped to what the driver supports
+  uint32_t msaaSamples{1};
+  PostAntiAliasing postAntiAliasing{};
+  // GPU frame time the scene resolution is scaled to hit. Zero keeps the scene at the output resolution, so runs are
+  // comparable.
+  float targetFrameMs{};
+  Upscaler upscaler{};
+  std::filesystem::path reportPath{"benchmark.json"};
+};
+
+// Recognizes --benchmark, --warmup-frames N, --frames N, --time-step SECONDS, --depth-prepass, --msaa 1|2|4|8,
+// --post-aa none|fxaa|smaa, --target-frame-ms MS, --upscaler bilinear|fsr1 and --report PATH. Prints the usage and
+// returns false on unknown or malformed arguments.
+bool parseBenchmarkOptions(int argc, char** argv, BenchmarkOptions& options);
+
+struct FrameTimeSummary {
+  uint32_t numSamples{};
+  double meanMs{};
+  double minMs{};
+  double maxMs{};
+  double p50Ms{};
+  double p95Ms{};
+  double p99Ms{};
+};
+
+// Nearest rank percentiles, same as the profiler windows
+FrameTimeSummary summarizeFrameTimes(std::vector<double> samplesMs);
+
+struct BenchmarkReport {
+  BenchmarkOptions options;
+  uint32_t width{};
+  uint32_t height{};
+  std::string glVendor;
+  std::string glRenderer;
+  std::string glVersion;
+  // Surfaceless EGL or a hidden window
+  std::string context;
+  double wallTimeSeconds{};
+  // CPU time of each measured frame, without the time spent waiting for the GPU to catch up
+  std::vector<double> cpuFrameTimesMs;
+  // Frame zone of the GPU profiler. Frames the profiler dropped are missing.
+  std::vector<double> gpuFrameTimesMs;
+  uint64_t gpuDroppedFrames{};
+  // Scene pass, per frame
+  uint64_t drawCalls{};
+  uint64_t triangles{};
+  // Scene resolution scale of each measured frame
+  std::vector<double> resolutionScales;
+  // Per pass averages over the measured frames, omitted when null or unsupported
+  const PipelineStatistics* pipelineStatistics{};
+  // Rolling average GPU time of each top level zone, omitted when null
+  const GpuProfiler* gpuProfiler{};
+  // Phases from process start to the first frame, omitted when null
+  const StartupTimeline* startupTimeline{};
+};
+
+// JSON with the summaries followed by the raw samples
+bool writeBenchmarkReport(const BenchmarkReport& report);
@@ -0,0 +1,334 @@
+#include "benchmark_compare.hpp"
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <print>
+#include <sstream>
+#include <string_view>
+#include <utility>
+
+namespace {
+// Just enough JSON for the benchmark reports
+struct JsonValue {
+  enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+  Type type{};
+  double number{};
+  std::string string;
+  std::vector<JsonValue> array;
+  std::vector<std::pair<std::string, JsonValue>> object;
+
+  const JsonValue* find(std::string_view key) const {
+    for (const auto& [name, value] : object) {
+      if (name == key)
+        return &value;
+    }
+    return nullptr;
+  }
+};
+
+struct JsonParser {
+  std::string_view text;
+  size_t pos{};
+
+  void skipWhitespace() {
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t'))
+      ++pos;
+  }
+
+  bool consume(char c) {
+    skipWhitespace();
+    if (pos >= text.size() || text[pos] != c)
+      return false;
+    ++pos;
+    return true;
+  }
+
+  bool parseString(std::string& out) {
+    if (!consume('"'))
+      return false;
+    while (pos < text.size() && text[pos] != '"') {
+      if (text[pos] != '\\' || pos + 1 >= text.size()) {
+        out += text[pos++];
+        continue;
+      }
+      // Only the escapes escapeJson produces, \u only below 0x20
+      const char escape = text[pos + 1];
+      pos += 2;
+      if (escape == 'n')
+        out += '\n';
+      else if (escape == 'r')
+        out += '\r';
+      else if (escape == 't')
+        out += '\t';
+      else if (escape == 'u') {
+        uint32_t code{};
+        const auto [end, error] = std::from_chars(text.data() + pos, text.data() + std::min(pos + 4, text.size()), code, 16);
+        if (error != std::errc{} || end != text.data() + pos + 4)
+          return false;
+        out += static_cast<char>(code);
+        pos += 4;
+      } else
+        out += escape;
+    }
+    return consume('"');
+  }
+
+  bool parseValue(JsonValue& value) { // NOLINT(*-no-recursion)
+    skipWhitespace();
+    if (pos >= text.size())
+      return false;
+    const char c = text[pos];
+    if (c == '{') {
+      value.type = JsonValue::Type::Object;
+      ++pos;
+      if (consume('}'))
+        return true;
+      do {
+        auto& [name, member] = value.object.emplace_back();
+        if (!parseString(name) || !consume(':') || !parseValue(member))
+          return false;
+      } while (consume(','));
+      return consume('}');
+    }
+    if (c == '[') {
+      value.type = JsonValue::Type::Array;
+      ++pos;
+      if (consume(']'))
+        return true;
+      do {
+        if (!parseValue(value.array.emplace_back()))
+          return false;
+      } while (consume(','));
+      return consume(']');
+    }
+    if (c == '"') {
+      value.type = JsonValue::Type::String;
+      return parseString(value.string);
+    }
+    constexpr std::array<std::pair<std::string_view, JsonValue::Type>, 3> kLiterals = {{{"null", JsonValue::Type::Null}, {"true", JsonValue::Type::Bool}, {"false", JsonValue::Type::Bool}}};
+    for (const auto& [literal, type] : kLiterals) {
+      if (text.substr(pos).starts_with(literal)) {
+        value.type = type;
+        value.number = literal[0] == 't' ? 1.0 : 0.0;
+        pos += literal.size();
+        return true;
+      }
+    }
+    value.type = JsonValue::Type::Number;
+    const auto [end, error] = std::from_chars(text.data() + pos, text.data() + text.size(), value.number);
+    if (error != std::errc{})
+      return false;
+    pos = static_cast<size_t>(end - text.data());
+    return true;
+  }
+};
+
+std::vector<double> getNumbers(const JsonValue& root, std::string_view key) {
+  std::vector<double> numbers;
+  if (const JsonValue* array = root.find(key); array != nullptr) {
+    for (const JsonValue& element : array->array)
+      numbers.push_back(element.number);
+  }
+  return numbers;
+}
+
+double getNumber(const JsonValue& root, std::string_view key) {
+  const JsonValue* value = root.find(key);
+  return value != nullptr ? value->number : 0.0;
+}
+
+// Every run split into numBatches batches, see BenchmarkComparisonOptions::numBatches
+std::vector<BenchmarkRun> getSamples(const std::vector<BenchmarkRun>& runs, uint32_t numBatches) {
+  if (numBatches < 2)
+    return runs;
+  const auto slice = [](const std::vector<double>& samples, uint32_t batchIx, uint32_t numBatches) {
+    const size_t begin = samples.size() * batchIx / numBatches;
+    const size_t end = samples.size() * (batchIx + 1) / numBatches;
+    return std::vector<double>(samples.begin() + static_cast<ptrdiff_t>(begin), samples.begin() + static_cast<ptrdiff_t>(end));
+  };
+  std::vector<BenchmarkRun> batches;
+  for (const BenchmarkRun& run : runs) {
+    for (uint32_t batchIx = 0; batchIx < numBatches; ++batchIx) {
+      BenchmarkRun& batch = batches.emplace_back(run);
+      batch.cpuFrameTimesMs = slice(run.cpuFrameTimesMs, batchIx, numBatches);
+      batch.gpuFrameTimesMs = slice(run.gpuFrameTimesMs, batchIx, numBatches);
+    }
+  }
+  return batches;
+}
+
+// Two sided 95% quantiles of Student's t distribution for 1 to 30 degrees of freedom
+constexpr std::array<double, 30> kStudentT95 = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+double getStudentT95(double degreesOfFreedom) {
+  // Rounding down is conservative, a wider interval
+  const auto dof = static_cast<size_t>(std::max(degreesOfFreedom, 1.0));
+  if (dof <= kStudentT95.size())
+    return kStudentT95[dof - 1];
+  // Cornish-Fisher expansion around the normal quantile, within 0.001 from 30 on
+  constexpr double z = 1.959964;
+  const double nu = static_cast<double>(dof);
+  return z + (z * z * z + z) / (4.0 * nu) + (5.0 * std::pow(z, 5.0) + 16.0 * z * z * z + 3.0 * z) / (96.0 * nu * nu);
+}
+
+void computeMeanAndVariance(const std::vector<double>& values, double& mean, double& variance) {
+  mean = variance = 0.0;
+  for (const double value : values)
+    mean += value;
+  mean /= static_cast<double>(values.size());
+  if (values.size() < 2)
+    return;
+  for (const double value : values)
+    variance += (value - mean) * (value - mean);
+  variance /= static_cast<double>(values.size() - 1);
+}
+
+BenchmarkMetricComparison compareMetric(std::string name, const std::vector<double>& baseline, const std::vector<double>& candidate, double threshold) {
+  BenchmarkMetricComparison comparison;
+  comparison.name = std::move(name);
+  double baselineVariance{}, candidateVariance{};
+  computeMeanAndVariance(baseline, comparison.baseline, baselineVariance);
+  computeMeanAndVariance(candidate, comparison.candidate, candidateVariance);
+  if (comparison.baseline == 0.0)
+    return comparison;
+
+  // Welch's t-test, the two sides need not have the same variance or number of runs
+  const double baselineTerm = baselineVariance / static_cast<double>(baseline.size());
+  const double candidateTerm = candidateVariance / static_cast<double>(candidate.size());
+  const double standardError = std::sqrt(baselineTerm + candidateTerm);
+  double halfWidth = 0.0;
+  if (standardError > 0.0) {
+    const double dofDenominator = (baseline.size() > 1 ? baselineTerm * baselineTerm / static_cast<double>(baseline.size() - 1) : 0.0) + (candidate.size() > 1 ? candidateTerm * candidateTerm / static_cast<double>(candidate.size() - 1) : 0.0);
+    const double dof = dofDenominator > 0.0 ? std::pow(standardError, 4.0) / dofDenominator : 1.0;
+    halfWidth = getStudentT95(dof) * standardError;
+  }
+  const double difference = comparison.candidate - comparison.baseline;
+  comparison.changeLow = (difference - halfWidth) / comparison.baseline;
+  comparison.changeHigh = (difference + halfWidth) / comparison.baseline;
+  if (comparison.changeLow > threshold)
+    comparison.verdict = BenchmarkVerdict::Regressed;
+  else if (comparison.changeHigh < -threshold)
+    comparison.verdict = BenchmarkVerdict::Improved;
+  return comparison;
+}
+}  // namespace
+
+bool readBenchmarkRun(const std::filesystem::path& path, BenchmarkRun& run) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    std::println("Error opening benchmark report {}", path.string());
+    return false;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string text = contents.str();
+  JsonParser parser{text};
+  JsonValue root;
+  if (!parser.parseValue(root) || root.type != JsonValue::Type::Object) {
+    std::println("Error parsing benchmark report {} at offset {}", path.string(), parser.pos);
+    return false;
+  }
+  run.path = path;
+  if (const JsonValue* gl = root.find("gl"); gl != nullptr) {
+    if (const JsonValue* renderer = gl->find("renderer"); renderer != nullptr)
+      run.glRenderer = renderer->string;
+  }
+  run.width = static_cast<uint32_t>(getNumber(root, "width"));
+  run.height = static_cast<uint32_t>(getNumber(root, "height"));
+  run.cpuFrameTimesMs = getNumbers(root, "cpuFrameTimesMs");
+  run.gpuFrameTimesMs = getNumbers(root, "gpuFrameTimesMs");
+  run.drawCalls = getNumber(root, "drawCalls");
+  run.triangles = getNumber(root, "triangles");
+  if (run.cpuFrameTimesMs.empty()) {
+    std::println("Benchmark report {} has no frame times", path.string());
+    return false;
+  }
+  return true;
+}
+
+bool readBenchmarkRuns(const std::filesystem::path& path, std::vector<BenchmarkRun>& runs) {
+  std::vector<std::filesystem::path> files;
+  if (std::filesystem::is_directory(path)) {
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(path)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".json")
+        files.push_back(entry.path());
+    }
+    std::ranges::sort(files);
+    if (files.empty()) {
+      std::println("No benchmark reports in {}", path.string());
+      return false;
+    }
+  } else {
+    files.push_back(path);
+  }
+  for (const std::filesystem::path& file : files) {
+    if (!readBenchmarkRun(file, runs.emplace_back()))
+      return false;
+  }
+  return true;
+}
+
+std::vector<BenchmarkMetricComparison> compareBenchmarkRuns(const std::vector<BenchmarkRun>& baseline, const std::vector<BenchmarkRun>& candidate, const BenchmarkComparisonOptions& options) {
+  std::vector<BenchmarkMetricComparison> comparisons;
+  if (baseline.empty() || candidate.empty())
+    return comparisons;
+  for (const BenchmarkRun& run : candidate) {
+    if (run.glRenderer != baseline.front().glRenderer || run.width != baseline.front().width || run.height != baseline.front().height)
+      std::println("Warning: {} ran on {} at {}x{}, the baseline on {} at {}x{}", run.path.string(), run.glRenderer, run.width, run.height, baseline.front().glRenderer, baseline.front().width, baseline.front().height);
+  }
+
+  // Both sides the same way, batch means and run means vary differently and cannot go into the same test
+  const uint32_t numBatches = baseline.size() == 1 || candidate.size() == 1 ? options.numBatches : 1;
+  const std::vector<BenchmarkRun> baselineSamples = getSamples(baseline, numBatches);
+  const std::vector<BenchmarkRun> candidateSamples = getSamples(candidate, numBatches);
+  const auto collect = [](const std::vector<BenchmarkRun>& runs, const auto& getValue) {
+    std::vector<double> values;
+    for (const BenchmarkRun& run : runs)
+      values.push_back(getValue(run));
+    return values;
+  };
+
+  constexpr std::array<std::pair<const char*, double FrameTimeSummary::*>, 4> kFrameMetrics = {{
+      {"mean", &FrameTimeSummary::meanMs},
+      {"p50", &FrameTimeSummary::p50Ms},
+      {"p95", &FrameTimeSummary::p95Ms},
+      {"p99", &FrameTimeSummary::p99Ms},
+  }};
+  const auto hasGpuTimes = [](const BenchmarkRun& run) { return !run.gpuFrameTimesMs.empty(); };
+  const bool compareGpu = std::ranges::all_of(baselineSamples, hasGpuTimes) && std::ranges::all_of(candidateSamples, hasGpuTimes);
+  constexpr std::array<std::pair<const char*, std::vector<double> BenchmarkRun::*>, 2> kSampleSets = {{
+      {"CPU", &BenchmarkRun::cpuFrameTimesMs},
+      {"GPU", &BenchmarkRun::gpuFrameTimesMs},
+  }};
+  for (const auto& [samplesName, samples] : kSampleSets) {
+    if (samples == &BenchmarkRun::gpuFrameTimesMs && !compareGpu)
+      continue;
+    for (const auto& [metricName, metric] : kFrameMetrics) {
+      const auto getValue = [&](const BenchmarkRun& run) { return summarizeFrameTimes(run.*samples).*metric; };
+      comparisons.push_back(compareMetric(std::format("{} frame {} (ms)", samplesName, metricName), collect(baselineSamples, getValue), collect(candidateSamples, getValue), options.threshold));
+    }
+  }
+  // Deterministic, any change beyond the threshold shows up
+  comparisons.push_back(compareMetric("Draw calls", collect(baseline, [](const BenchmarkRun& run) { return run.drawCalls; }), collect(candidate, [](const BenchmarkRun& run) { return run.drawCalls; }), options.threshold));
+  comparisons.push_back(compareMetric("Triangles", collect(baseline, [](const BenchmarkRun& run) { return run.triangles; }), collect(candidate, [](const BenchmarkRun& run) { return run.triangles; }), options.threshold));
+  return comparisons;
+}
+
+void printBenchmarkComparison(const std::vector<BenchmarkMetricComparison>& comparisons) {
+  std::println("{:<24} {:>12} {:>12} {:>9} {:>20}  {}", "Metric", "Baseline", "Candidate", "Change", "95% CI", "Verdict");
+  uint32_t numRegressions = 0;
+  for (const BenchmarkMetricComparison& comparison : comparisons) {
+    const double change = comparison.baseline == 0.0 ? 0.0 : (comparison.candidate - comparison.baseline) / comparison.baseline;
+    const char* verdict = comparison.verdict == BenchmarkVerdict::Regressed ? "REGRESSED" : (comparison.verdict == BenchmarkVerdict::Improved ? "improved" : "");
+    std::println("{:<24} {:>12.3f} {:>12.3f} {:>+8.1f}% {:>20}  {}", comparison.name, comparison.baseline, comparison.candidate, change * 100.0, std::format("[{:+.1f}%, {:+.1f}%]", comparison.changeLow * 100.0, comparison.changeHigh * 100.0), verdict);
+    if (comparison.verdict == BenchmarkVerdict::Regressed)
+      ++numRegressions;
+  }
+  std::println("{} of {} metrics regressed", numRegressions, comparisons.size());
+}
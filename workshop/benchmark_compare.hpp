@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Samples of one report written by Workshop --benchmark
+struct BenchmarkRun {
+  std::filesystem::path path;
+  std::string glRenderer;
+  uint32_t width{};
+  uint32_t height{};
+  std::vector<double> cpuFrameTimesMs;
+  std::vector<double> gpuFrameTimesMs;
+  double drawCalls{};
+  double triangles{};
+};
+
+bool readBenchmarkRun(const std::filesystem::path& path, BenchmarkRun& run);
+// A directory stands for all .json reports in it, sorted by name
+bool readBenchmarkRuns(const std::filesystem::path& path, std::vector<BenchmarkRun>& runs);
+
+struct BenchmarkComparisonOptions {
+  // Smallest relative increase that counts as a regression. The confidence interval has to lie entirely above it, so
+  // noise alone does not fail the comparison.
+  double threshold{0.03};
+  // When either side has a single run, every run of both sides is split into this many consecutive batches of frames,
+  // and their means stand in for runs. Neighboring frames are correlated, so single frames would understate the noise.
+  uint32_t numBatches{10};
+};
+
+enum class BenchmarkVerdict : uint8_t {
+  Unchanged,
+  Improved,
+  Regressed,
+};
+
+struct BenchmarkMetricComparison {
+  std::string name;
+  // Means over runs
+  double baseline{};
+  double candidate{};
+  // 95% confidence interval of the relative change, from Welch's t-test on the per run or per batch values
+  double changeLow{};
+  double changeHigh{};
+  BenchmarkVerdict verdict{};
+};
+
+// Metrics where lower is better: CPU and GPU frame time mean and percentiles, draw calls and triangles
+std::vector<BenchmarkMetricComparison> compareBenchmarkRuns(const std::vector<BenchmarkRun>& baseline, const std::vector<BenchmarkRun>& candidate, const BenchmarkComparisonOptions& options);
+void printBenchmarkComparison(const std::vector<BenchmarkMetricComparison>& comparisons);
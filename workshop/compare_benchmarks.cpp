@@ -0,0 +1,46 @@
+#include "benchmark_compare.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <print>
+#include <string_view>
+#include <vector>
+
+// Usage: CompareBenchmarks --baseline <report or directory>... --candidate <report or directory>... [--threshold 0.03]
+// e.g. CompareBenchmarks --baseline baselines/llvmpipe --candidate run1.json run2.json run3.json
+// Exits with 1 when a metric regressed, with 2 on invalid arguments or unreadable reports.
+int main(int argc, char* argv[]) {
+  std::vector<BenchmarkRun> baseline, candidate;
+  BenchmarkComparisonOptions options;
+  std::vector<BenchmarkRun>* runs{};
+  for (int argIx = 1; argIx < argc; ++argIx) {
+    const std::string_view arg = argv[argIx];
+    if (arg == "--baseline") {
+      runs = &baseline;
+    } else if (arg == "--candidate") {
+      runs = &candidate;
+    } else if (arg == "--threshold" && argIx + 1 < argc) {
+      const std::string_view value = argv[++argIx];
+      if (std::from_chars(value.data(), value.data() + value.size(), options.threshold).ec != std::errc{}) {
+        std::println("Invalid threshold: {}", value);
+        return 2;
+      }
+    } else if (runs != nullptr && !arg.starts_with("--")) {
+      if (!readBenchmarkRuns(arg, *runs))
+        return 2;
+    } else {
+      runs = nullptr;
+      break;
+    }
+  }
+  if (runs == nullptr || baseline.empty() || candidate.empty()) {
+    std::println("Usage: {} --baseline <report or directory>... --candidate <report or directory>... [--threshold 0.03]", argv[0]);
+    return 2;
+  }
+
+  std::println("Comparing {} baseline and {} candidate runs", baseline.size(), candidate.size());
+  const std::vector<BenchmarkMetricComparison> comparisons = compareBenchmarkRuns(baseline, candidate, options);
+  printBenchmarkComparison(comparisons);
+  const bool regressed = std::ranges::any_of(comparisons, [](const BenchmarkMetricComparison& comparison) { return comparison.verdict == BenchmarkVerdict::Regressed; });
+  return regressed ? 1 : 0;
+}
@@ -0,0 +1,46 @@
+#include "cpu_features.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace {
+CpuFeatures detectCpuFeatures() {
+  CpuFeatures features{};
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  unsigned int regs1[4]{};
+  unsigned int regs7[4]{};
+#if defined(_MSC_VER)
+  __cpuid(reinterpret_cast<int*>(regs1), 1);
+  __cpuidex(reinterpret_cast<int*>(regs7), 7, 0);
+#else
+  __cpuid(1, regs1[0], regs1[1], regs1[2], regs1[3]);
+  __cpuid_count(7, 0, regs7[0], regs7[1], regs7[2], regs7[3]);
+#endif
+  const bool osxsave = (regs1[2] & (1u << 27)) != 0;
+  unsigned int xcr0 = 0;
+  if (osxsave) {
+#if defined(_MSC_VER)
+    xcr0 = static_cast<unsigned int>(_xgetbv(0));
+#else
+    unsigned int xcr0Hi{};
+    __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0Hi) : "c"(0));
+#endif
+  }
+  const bool osSavesYmm = (xcr0 & 0x6) == 0x6;
+  // Opmask and both halves of the ZMM registers on top of YMM
+  const bool osSavesZmm = (xcr0 & 0xE6) == 0xE6;
+  features.fma = osSavesYmm && (regs1[2] & (1u << 12)) != 0;
+  features.avx2 = osSavesYmm && (regs7[1] & (1u << 5)) != 0;
+  features.avx512f = osSavesZmm && (regs7[1] & (1u << 16)) != 0;
+#endif
+  return features;
+}
+}  // namespace
+
+const CpuFeatures& getCpuFeatures() {
+  static const CpuFeatures features = detectCpuFeatures();
+  return features;
+}
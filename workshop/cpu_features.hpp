@@ -0,0 +1,10 @@
+#pragma once
+
+// Instruction set extensions detected at runtime, so that kernels compiled for them are only called on CPUs that have them
+struct CpuFeatures {
+  bool avx2{};
+  bool fma{};
+  bool avx512f{};
+};
+
+const CpuFeatures& getCpuFeatures();
@@ -0,0 +1,246 @@
+#include "cpu_memory.hpp"
+
+#include "gpu_memory.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <print>
+
+namespace {
+constinit CpuMemoryTracker gTracker;
+constinit thread_local MemoryTag tMemoryTag = MemoryTag::Untagged;
+
+// Precedes every tracked allocation. malloc returns 16 byte aligned memory on 64-bit targets, so the header keeps
+// allocations with up to that alignment right behind it.
+struct AllocationHeader {
+  uint64_t size;
+  // From the start of the malloc'ed block to the allocation
+  uint32_t offset;
+  MemoryTag tag;
+};
+constexpr size_t kHeaderSize = 16;
+static_assert(sizeof(AllocationHeader) <= kHeaderSize);
+
+void raiseTo(std::atomic<int64_t>& peak, int64_t value) {
+  int64_t current = peak.load(std::memory_order_relaxed);
+  while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+void* allocate(size_t size, size_t alignment, MemoryTag tag) {
+  alignment = std::max(alignment, kHeaderSize);
+  // Would wrap around to a tiny block, callers see the failure as std::bad_alloc
+  if (size > SIZE_MAX - alignment)
+    return nullptr;
+  std::byte* block = static_cast<std::byte*>(std::malloc(size + alignment));
+  if (block == nullptr)
+    return nullptr;
+  const auto address = reinterpret_cast<uintptr_t>(block) + kHeaderSize;
+  std::byte* ptr = block + ((address + alignment - 1) & ~(alignment - 1)) - reinterpret_cast<uintptr_t>(block);
+  *reinterpret_cast<AllocationHeader*>(ptr - kHeaderSize) = {.size = size, .offset = static_cast<uint32_t>(ptr - block), .tag = tag};
+
+  CpuMemoryTagStats& stats = gTracker.tags[static_cast<size_t>(tag)];
+  const auto bytes = static_cast<int64_t>(size);
+  raiseTo(stats.peakBytes, stats.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+  raiseTo(gTracker.peakTotalBytes, gTracker.totalBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+  stats.numAllocations.fetch_add(1, std::memory_order_relaxed);
+  stats.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+void deallocate(void* ptr) {
+  if (ptr == nullptr)
+    return;
+  const AllocationHeader& header = *reinterpret_cast<const AllocationHeader*>(static_cast<std::byte*>(ptr) - kHeaderSize);
+  CpuMemoryTagStats& stats = gTracker.tags[static_cast<size_t>(header.tag)];
+  const auto bytes = static_cast<int64_t>(header.size);
+  stats.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+  stats.numAllocations.fetch_sub(1, std::memory_order_relaxed);
+  gTracker.totalBytes.fetch_sub(bytes, std::memory_order_relaxed);
+  std::free(static_cast<std::byte*>(ptr) - header.offset);
+}
+
+void* allocateOrThrow(size_t size, size_t alignment) {
+  while (true) {
+    if (void* ptr = allocate(size, alignment, tMemoryTag))
+      return ptr;
+    const std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr)
+      throw std::bad_alloc{};
+    handler();
+  }
+}
+
+double toMiB(int64_t bytes) {
+  return static_cast<double>(bytes) / 1048576.0;
+}
+}  // namespace
+
+void* operator new(size_t size) {
+  return allocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](size_t size) {
+  return allocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, tMemoryTag);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, tMemoryTag);
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return allocate(size, static_cast<size_t>(alignment), tMemoryTag);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return allocate(size, static_cast<size_t>(alignment), tMemoryTag);
+}
+void operator delete(void* ptr) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+  deallocate(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept {
+  deallocate(ptr);
+}
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+  deallocate(ptr);
+}
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+  deallocate(ptr);
+}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+
+const char* getMemoryTagName(MemoryTag tag) {
+  switch (tag) {
+    case MemoryTag::Untagged:
+      return "Untagged";
+    case MemoryTag::ModelImport:
+      return "Model import";
+    case MemoryTag::Meshes:
+      return "Meshes";
+    case MemoryTag::Textures:
+      return "Textures";
+    case MemoryTag::VirtualTexture:
+      return "Virtual texture";
+    case MemoryTag::Shaders:
+      return "Shaders";
+    case MemoryTag::Profiling:
+      return "Profiling";
+    case MemoryTag::Ui:
+      return "UI";
+    case MemoryTag::Count:
+      break;
+  }
+  return "?";
+}
+
+CpuMemoryTracker& getCpuMemoryTracker() {
+  return gTracker;
+}
+
+MemoryTag setMemoryTag(MemoryTag tag) {
+  const MemoryTag previous = tMemoryTag;
+  tMemoryTag = tag;
+  return previous;
+}
+
+MemoryTag getMemoryTag() {
+  return tMemoryTag;
+}
+
+void* allocateTagged(size_t size, MemoryTag tag) {
+  return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, tag);
+}
+
+void freeTagged(void* ptr) {
+  deallocate(ptr);
+}
+
+void printMemoryReport() {
+  std::println("CPU memory: {:.1f} MiB in use, peak {:.1f} MiB", toMiB(gTracker.totalBytes), toMiB(gTracker.peakTotalBytes));
+  for (size_t tag = 0; tag < kNumMemoryTags; ++tag) {
+    const CpuMemoryTagStats& stats = gTracker.tags[tag];
+    std::println("  {:<16} {:>9.1f} MiB, peak {:>9.1f} MiB, {} allocations live of {}", getMemoryTagName(static_cast<MemoryTag>(tag)), toMiB(stats.bytes), toMiB(stats.peakBytes), stats.numAllocations.load(), stats.totalAllocations.load());
+  }
+  const GpuMemoryTracker& gpu = getGpuMemoryTracker();
+  std::println("GPU memory: {:.1f} MiB in use, peak {:.1f} MiB", toMiB(static_cast<int64_t>(gpu.totalBytes)), toMiB(static_cast<int64_t>(gpu.peakTotalBytes)));
+  for (size_t category = 0; category < kNumGpuMemoryCategories; ++category)
+    std::println("  {:<16} {:>9.1f} MiB, peak {:>9.1f} MiB", getGpuMemoryCategoryName(static_cast<GpuMemoryCategory>(category)), toMiB(static_cast<int64_t>(gpu.bytes[category])), toMiB(static_cast<int64_t>(gpu.peakBytes[category])));
+}
+
+void drawMemoryWindow() {
+  ImGui::Begin("Memory");
+  constexpr ImGuiTableFlags kTableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit;
+  ImGui::SeparatorText("CPU");
+  ImGui::Text("%.1f MiB in use, peak %.1f MiB", toMiB(gTracker.totalBytes), toMiB(gTracker.peakTotalBytes));
+  if (ImGui::BeginTable("CPU tags", 5, kTableFlags)) {
+    for (const char* column : {"Tag", "MiB", "Peak MiB", "Live allocations", "Total allocations"})
+      ImGui::TableSetupColumn(column);
+    ImGui::TableHeadersRow();
+    for (size_t tag = 0; tag < kNumMemoryTags; ++tag) {
+      const CpuMemoryTagStats& stats = gTracker.tags[tag];
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(getMemoryTagName(static_cast<MemoryTag>(tag)));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f", toMiB(stats.bytes));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f", toMiB(stats.peakBytes));
+      ImGui::TableNextColumn();
+      ImGui::Text("%lld", static_cast<long long>(stats.numAllocations.load()));
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", static_cast<unsigned long long>(stats.totalAllocations.load()));
+    }
+    ImGui::EndTable();
+  }
+
+  const GpuMemoryTracker& gpu = getGpuMemoryTracker();
+  ImGui::SeparatorText("GPU");
+  ImGui::Text("%.1f MiB in use, peak %.1f MiB", gpu.totalBytes / 1048576.0, gpu.peakTotalBytes / 1048576.0);
+  if (ImGui::BeginTable("GPU categories", 3, kTableFlags)) {
+    for (const char* column : {"Category", "MiB", "Peak MiB"})
+      ImGui::TableSetupColumn(column);
+    ImGui::TableHeadersRow();
+    for (size_t category = 0; category < kNumGpuMemoryCategories; ++category) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(getGpuMemoryCategoryName(static_cast<GpuMemoryCategory>(category)));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f", gpu.bytes[category] / 1048576.0);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f", gpu.peakBytes[category] / 1048576.0);
+    }
+    ImGui::EndTable();
+  }
+  ImGui::End();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Subsystem charged for heap allocations made on a thread, see MemoryTagScope
+enum class MemoryTag : uint8_t {
+  Untagged,
+  // Assimp's aiScene and importer state
+  ModelImport,
+  Meshes,
+  Textures,
+  VirtualTexture,
+  Shaders,
+  Profiling,
+  Ui,
+  Count,
+};
+constexpr size_t kNumMemoryTags = static_cast<size_t>(MemoryTag::Count);
+
+const char* getMemoryTagName(MemoryTag tag);
+
+struct CpuMemoryTagStats {
+  std::atomic<int64_t> bytes{};
+  std::atomic<int64_t> peakBytes{};
+  std::atomic<int64_t> numAllocations{};
+  // Allocations ever made, for spotting churn
+  std::atomic<uint64_t> totalAllocations{};
+};
+
+// Filled by the global operator new and delete replacements in cpu_memory.cpp, for every thread. Freed memory is
+// charged to the tag it was allocated with.
+struct CpuMemoryTracker {
+  std::array<CpuMemoryTagStats, kNumMemoryTags> tags;
+  std::atomic<int64_t> totalBytes{};
+  std::atomic<int64_t> peakTotalBytes{};
+};
+
+CpuMemoryTracker& getCpuMemoryTracker();
+
+// Tag of the calling thread, returns the previous one
+MemoryTag setMemoryTag(MemoryTag tag);
+MemoryTag getMemoryTag();
+
+struct MemoryTagScope {
+  explicit MemoryTagScope(MemoryTag tag) : previous(setMemoryTag(tag)) {}
+  ~MemoryTagScope() { setMemoryTag(previous); }
+  MemoryTagScope(const MemoryTagScope&) = delete;
+  MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+  MemoryTag previous;
+};
+
+// For libraries with their own allocator hooks, e.g. ImGui::SetAllocatorFunctions. Free with freeTagged.
+void* allocateTagged(size_t size, MemoryTag tag);
+void freeTagged(void* ptr);
+
+// Current and peak CPU memory per tag and GPU memory per category
+void printMemoryReport();
+void drawMemoryWindow();
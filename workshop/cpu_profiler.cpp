@@ -0,0 +1,313 @@
+#include "cpu_profiler.hpp"
+
+#include "cpu_memory.hpp"
+#include "json.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <map>
+#include <print>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define CPU_PROFILER_RDTSC 1
+#endif
+
+namespace {
+thread_local CpuProfilerThread* tThread{};
+
+uint64_t readTicks() {
+#ifdef CPU_PROFILER_RDTSC
+  // Invariant TSC on every x86-64 CPU this runs on, a few times cheaper than steady_clock
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+int64_t readNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CpuProfilerThread& registerThread(CpuProfiler& profiler) {
+  MemoryTagScope memoryTag(MemoryTag::Profiling);
+  auto thread = std::make_unique<CpuProfilerThread>();
+  thread->events = std::make_unique<CpuProfileEvent[]>(kCpuProfilerRingSize);
+  std::scoped_lock lock(profiler.threadsMutex);
+  thread->id = static_cast<uint32_t>(profiler.threads.size());
+  thread->name = std::format("Thread {}", thread->id);
+  tThread = profiler.threads.emplace_back(std::move(thread)).get();
+  return *tThread;
+}
+
+void recordEvent(CpuProfiler& profiler, CpuEventType type, const char* name, double value) {
+  CpuProfilerThread& thread = tThread != nullptr ? *tThread : registerThread(profiler);
+  const uint64_t head = thread.head.load(std::memory_order_relaxed);
+  thread.events[head & (kCpuProfilerRingSize - 1)] = {readTicks(), name, value, type};
+  thread.head.store(head + 1, std::memory_order_release);
+}
+
+// Converts event ticks into ns since the reference, calibrated against steady_clock over the whole run
+struct TickConverter {
+  uint64_t referenceTicks{};
+  double nsPerTick{1.0};
+
+  int64_t operator()(uint64_t ticks) const { return static_cast<int64_t>(static_cast<double>(static_cast<int64_t>(ticks - referenceTicks)) * nsPerTick); }
+};
+
+void captureThread(const CpuProfilerThread& thread, const TickConverter& toNs, int64_t captureNs, uint32_t maxEvents, std::vector<CpuProfileEvent>& events, CpuProfileSnapshot& snapshot) {
+  const uint64_t head = thread.head.load(std::memory_order_acquire);
+  const uint64_t first = head - std::min<uint64_t>(head, std::min(maxEvents, kCpuProfilerRingSize));
+  events.resize(head - first);
+  for (uint64_t ix = first; ix < head; ++ix)
+    events[ix - first] = thread.events[ix & (kCpuProfilerRingSize - 1)];
+  // Slots the writer reached again while they were copied hold newer events now, and may be torn
+  const uint64_t headAfter = thread.head.load(std::memory_order_acquire);
+  const uint64_t firstValid = headAfter - std::min<uint64_t>(headAfter, kCpuProfilerRingSize);
+  const size_t skip = firstValid > first ? static_cast<size_t>(std::min<uint64_t>(firstValid - first, events.size())) : 0;
+
+  CpuThreadProfile& profile = snapshot.threads.emplace_back();
+  profile.id = thread.id;
+  std::vector<std::pair<const char*, int64_t>> open;
+  for (size_t ix = skip; ix < events.size(); ++ix) {
+    const CpuProfileEvent& event = events[ix];
+    const int64_t timeNs = toNs(event.ticks);
+    switch (event.type) {
+      case CpuEventType::ZoneBegin:
+        open.emplace_back(event.name, timeNs);
+        break;
+      case CpuEventType::ZoneEnd:
+        // Its begin is older than the copied events
+        if (open.empty())
+          break;
+        profile.zones.push_back({open.back().first, open.back().second, timeNs, static_cast<uint32_t>(open.size() - 1)});
+        open.pop_back();
+        break;
+      case CpuEventType::Counter:
+        profile.counters.push_back({event.name, timeNs, event.value});
+        break;
+      case CpuEventType::FrameMark:
+        snapshot.frameMarksNs.push_back(timeNs);
+        break;
+    }
+  }
+  while (!open.empty()) {
+    profile.zones.push_back({open.back().first, open.back().second, captureNs, static_cast<uint32_t>(open.size() - 1)});
+    open.pop_back();
+  }
+  std::ranges::sort(profile.zones, {}, &CpuZone::beginNs);
+}
+
+// Window of the UI, kept between frames so it can be paused
+struct CpuProfilerWindowState {
+  CpuProfileSnapshot snapshot;
+  bool paused{};
+  int numTraceFrames{10};
+  std::string traceMessage;
+};
+}  // namespace
+
+CpuProfiler& getCpuProfiler() {
+  // Never destroyed, threads may still record while statics are torn down
+  static CpuProfiler& profiler = *[] {
+    auto* p = new CpuProfiler;
+    p->referenceTicks = readTicks();
+    p->referenceNs = readNs();
+    return p;
+  }();
+  return profiler;
+}
+
+bool beginCpuZone(const char* name) {
+  CpuProfiler& profiler = getCpuProfiler();
+  if (!profiler.enabled.load(std::memory_order_relaxed))
+    return false;
+  recordEvent(profiler, CpuEventType::ZoneBegin, name, 0.0);
+  return true;
+}
+
+void endCpuZone() {
+  recordEvent(getCpuProfiler(), CpuEventType::ZoneEnd, nullptr, 0.0);
+}
+
+void recordCpuCounter(const char* name, double value) {
+  CpuProfiler& profiler = getCpuProfiler();
+  if (profiler.enabled.load(std::memory_order_relaxed))
+    recordEvent(profiler, CpuEventType::Counter, name, value);
+}
+
+void markCpuFrame() {
+  CpuProfiler& profiler = getCpuProfiler();
+  if (profiler.enabled.load(std::memory_order_relaxed))
+    recordEvent(profiler, CpuEventType::FrameMark, "Frame", 0.0);
+}
+
+void setCpuProfilerThreadName(std::string name) {
+  CpuProfiler& profiler = getCpuProfiler();
+  CpuProfilerThread& thread = tThread != nullptr ? *tThread : registerThread(profiler);
+  std::scoped_lock lock(profiler.threadsMutex);
+  thread.name = std::move(name);
+}
+
+void captureCpuProfile(CpuProfileSnapshot& snapshot, uint32_t maxEventsPerThread) {
+  snapshot = {};
+  CpuProfiler& profiler = getCpuProfiler();
+  const uint64_t captureTicks = readTicks();
+  const int64_t captureNs = readNs();
+  TickConverter toNs{profiler.referenceTicks};
+#ifdef CPU_PROFILER_RDTSC
+  if (captureTicks > profiler.referenceTicks && captureNs > profiler.referenceNs)
+    toNs.nsPerTick = static_cast<double>(captureNs - profiler.referenceNs) / static_cast<double>(captureTicks - profiler.referenceTicks);
+#endif
+
+  std::vector<std::pair<const CpuProfilerThread*, std::string>> threads;
+  {
+    std::scoped_lock lock(profiler.threadsMutex);
+    for (const auto& thread : profiler.threads)
+      threads.emplace_back(thread.get(), thread->name);
+  }
+  std::vector<CpuProfileEvent> events;
+  for (const auto& [thread, name] : threads) {
+    captureThread(*thread, toNs, toNs(captureTicks), maxEventsPerThread, events, snapshot);
+    snapshot.threads.back().name = name;
+  }
+  std::ranges::sort(snapshot.frameMarksNs);
+}
+
+bool writeCpuTrace(const CpuProfileSnapshot& snapshot, uint32_t numFrames, const std::filesystem::path& path) {
+  const size_t numMarks = snapshot.frameMarksNs.size();
+  if (numMarks < 2) {
+    std::println("No complete frame to write into {}", path.string());
+    return false;
+  }
+  const size_t firstMark = numMarks - 1 - std::min<size_t>(numFrames, numMarks - 1);
+  const int64_t beginNs = snapshot.frameMarksNs[firstMark];
+  const int64_t endNs = snapshot.frameMarksNs.back();
+
+  std::error_code error;
+  std::filesystem::create_directories(path.parent_path(), error);
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    std::println("Error creating trace file {}", path.string());
+    return false;
+  }
+  // Timestamps are in microseconds
+  const auto us = [](int64_t ns) { return static_cast<double>(ns) * 1e-3; };
+  std::string json = R"({"displayTimeUnit":"ms","traceEvents":[)";
+  const auto append = [&json](const std::string& event) {
+    if (json.back() != '[')
+      json += ',';
+    json += '\n';
+    json += event;
+  };
+  for (const CpuThreadProfile& thread : snapshot.threads) {
+    append(std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})", thread.id, escapeJson(thread.name)));
+    for (const CpuZone& zone : thread.zones) {
+      if (zone.endNs < beginNs || zone.beginNs > endNs)
+        continue;
+      append(std::format(R"({{"name":"{}","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":1,"tid":{}}})", escapeJson(zone.name), us(zone.beginNs), us(zone.endNs - zone.beginNs), thread.id));
+    }
+    for (const CpuCounterSample& sample : thread.counters) {
+      if (sample.timeNs < beginNs || sample.timeNs > endNs)
+        continue;
+      append(std::format(R"({{"name":"{}","ph":"C","ts":{:.3f},"pid":1,"tid":{},"args":{{"value":{}}}}})", escapeJson(sample.name), us(sample.timeNs), thread.id, sample.value));
+    }
+  }
+  for (size_t markIx = firstMark; markIx < numMarks; ++markIx)
+    append(std::format(R"({{"name":"Frame","ph":"i","s":"g","ts":{:.3f},"pid":1,"tid":0}})", us(snapshot.frameMarksNs[markIx])));
+  json += "\n]}\n";
+  file.write(json.data(), static_cast<std::streamsize>(json.size()));
+  return file.good();
+}
+
+void drawCpuProfilerWindow(const std::filesystem::path& traceDir) {
+  static CpuProfilerWindowState state;
+  CpuProfiler& profiler = getCpuProfiler();
+  ImGui::Begin("CPU profiler");
+  bool enabled = profiler.enabled.load(std::memory_order_relaxed);
+  if (ImGui::Checkbox("Enabled", &enabled))
+    profiler.enabled.store(enabled, std::memory_order_relaxed);
+  ImGui::SameLine();
+  ImGui::Checkbox("Paused", &state.paused);
+  // The view only needs the last few frames, export reads the full rings
+  if (!state.paused)
+    captureCpuProfile(state.snapshot, 8192);
+
+  ImGui::SliderInt("Frames to export", &state.numTraceFrames, 1, 300);
+  ImGui::SameLine();
+  if (ImGui::Button("Write trace")) {
+    CpuProfileSnapshot full;
+    captureCpuProfile(full);
+    const std::filesystem::path path = traceDir / std::format("cpu_trace_{}.json", std::chrono::system_clock::now().time_since_epoch().count());
+    state.traceMessage = writeCpuTrace(full, static_cast<uint32_t>(state.numTraceFrames), path) ? std::format("Wrote {}", path.string()) : std::string{"Writing the trace failed"};
+  }
+  if (!state.traceMessage.empty())
+    ImGui::TextUnformatted(state.traceMessage.c_str());
+
+  const std::vector<int64_t>& marks = state.snapshot.frameMarksNs;
+  if (marks.size() >= 2) {
+    const int64_t frameBegin = marks[marks.size() - 2];
+    const int64_t frameEnd = marks.back();
+    ImGui::SeparatorText(std::format("Latest frame: {:.3f} ms", static_cast<double>(frameEnd - frameBegin) * 1e-6).c_str());
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 64.f);
+    const double pixelsPerNs = width / static_cast<double>(frameEnd - frameBegin);
+    ImDrawList& drawList = *ImGui::GetWindowDrawList();
+    for (const CpuThreadProfile& thread : state.snapshot.threads) {
+      uint32_t maxDepth = 0;
+      bool any = false;
+      for (const CpuZone& zone : thread.zones) {
+        if (zone.endNs >= frameBegin && zone.beginNs <= frameEnd) {
+          maxDepth = std::max(maxDepth, zone.depth);
+          any = true;
+        }
+      }
+      if (!any)
+        continue;
+      ImGui::TextUnformatted(thread.name.c_str());
+      const ImVec2 origin = ImGui::GetCursorScreenPos();
+      for (const CpuZone& zone : thread.zones) {
+        if (zone.endNs < frameBegin || zone.beginNs > frameEnd)
+          continue;
+        const auto x0 = static_cast<float>(static_cast<double>(std::max(zone.beginNs, frameBegin) - frameBegin) * pixelsPerNs);
+        const auto x1 = static_cast<float>(static_cast<double>(std::min(zone.endNs, frameEnd) - frameBegin) * pixelsPerNs);
+        const ImVec2 min{origin.x + x0, origin.y + static_cast<float>(zone.depth) * rowHeight};
+        const ImVec2 max{std::max(origin.x + x1, min.x + 1.f), min.y + rowHeight - 1.f};
+        // Color by name, so a zone keeps its color across frames and threads
+        const size_t hash = std::hash<std::string_view>{}(zone.name);
+        const ImU32 color = ImGui::GetColorU32(ImVec4{0.35f + 0.3f * static_cast<float>(hash % 7) / 6.f, 0.45f + 0.3f * static_cast<float>(hash / 7 % 5) / 4.f, 0.5f, 1.f});
+        drawList.AddRectFilled(min, max, color);
+        drawList.PushClipRect(min, max, true);
+        drawList.AddText(ImVec2{min.x + 2.f, min.y}, IM_COL32_WHITE, zone.name);
+        drawList.PopClipRect();
+        if (ImGui::IsMouseHoveringRect(min, max))
+          ImGui::SetTooltip("%s: %.3f ms", zone.name, static_cast<double>(zone.endNs - zone.beginNs) * 1e-6);
+      }
+      ImGui::Dummy(ImVec2{width, static_cast<float>(maxDepth + 1) * rowHeight});
+    }
+  }
+
+  // Latest value of every counter
+  std::map<std::string_view, const CpuCounterSample*> counters;
+  for (const CpuThreadProfile& thread : state.snapshot.threads) {
+    for (const CpuCounterSample& sample : thread.counters) {
+      const CpuCounterSample*& latest = counters[sample.name];
+      if (latest == nullptr || latest->timeNs < sample.timeNs)
+        latest = &sample;
+    }
+  }
+  if (!counters.empty()) {
+    ImGui::SeparatorText("Counters");
+    for (const auto& [name, sample] : counters)
+      ImGui::Text("%s: %g", sample->name, sample->value);
+  }
+  ImGui::End();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class CpuEventType : uint8_t {
+  ZoneBegin,
+  ZoneEnd,
+  Counter,
+  FrameMark,
+};
+
+struct CpuProfileEvent {
+  uint64_t ticks{};
+  // String literal
+  const char* name{};
+  double value{};
+  CpuEventType type{};
+};
+
+constexpr uint32_t kCpuProfilerRingSize = 1 << 16;
+
+// Single producer ring of events. Only the owning thread writes, readers copy the latest kCpuProfilerRingSize events
+// and discard the ones that may have been overwritten while copying.
+struct CpuProfilerThread {
+  std::string name;
+  uint32_t id{};
+  std::unique_ptr<CpuProfileEvent[]> events;
+  // Number of events ever written
+  std::atomic<uint64_t> head{};
+};
+
+// Process wide, see getCpuProfiler. Recording an event costs a timestamp read and a store into the calling thread's
+// ring, so zones can stay in release builds.
+struct CpuProfiler {
+  std::atomic<bool> enabled{true};
+  // Threads register on their first event and are kept after they exit, so their events can still be exported
+  std::mutex threadsMutex;
+  std::vector<std::unique_ptr<CpuProfilerThread>> threads;
+  // Relates timestamps to steady_clock
+  uint64_t referenceTicks{};
+  int64_t referenceNs{};
+};
+
+CpuProfiler& getCpuProfiler();
+
+// Return false when the profiler is disabled and nothing was recorded
+bool beginCpuZone(const char* name);
+void endCpuZone();
+void recordCpuCounter(const char* name, double value);
+// Call once per frame on the main thread, frames are the spans between marks
+void markCpuFrame();
+// Name shown for the calling thread, registers it if needed
+void setCpuProfilerThreadName(std::string name);
+
+struct CpuZoneScope {
+  explicit CpuZoneScope(const char* name) : recorded(beginCpuZone(name)) {}
+  ~CpuZoneScope() {
+    if (recorded)
+      endCpuZone();
+  }
+  CpuZoneScope(const CpuZoneScope&) = delete;
+  CpuZoneScope& operator=(const CpuZoneScope&) = delete;
+  // Ends are recorded even if the profiler was disabled meanwhile, so zones stay balanced
+  bool recorded;
+};
+
+#define CPU_PROFILE_CONCAT_INNER(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_INNER(a, b)
+#define CPU_PROFILE_ZONE(name) const CpuZoneScope CPU_PROFILE_CONCAT(cpuZone, __LINE__)(name)
+
+// Balanced zones reconstructed from a thread's events. Times are in nanoseconds since the profiler's reference.
+struct CpuZone {
+  const char* name{};
+  int64_t beginNs{};
+  int64_t endNs{};
+  uint32_t depth{};
+};
+
+struct CpuCounterSample {
+  const char* name{};
+  int64_t timeNs{};
+  double value{};
+};
+
+struct CpuThreadProfile {
+  std::string name;
+  uint32_t id{};
+  std::vector<CpuZone> zones;
+  std::vector<CpuCounterSample> counters;
+};
+
+struct CpuProfileSnapshot {
+  std::vector<CpuThreadProfile> threads;
+  std::vector<int64_t> frameMarksNs;
+};
+
+// Copy the events currently in all rings. Zones cut off by the start of a ring are dropped, zones still open are closed
+// at the time of the capture.
+void captureCpuProfile(CpuProfileSnapshot& snapshot, uint32_t maxEventsPerThread = kCpuProfilerRingSize);
+// Chrome trace event JSON of the last numFrames complete frames, loadable in chrome://tracing and ui.perfetto.dev
+bool writeCpuTrace(const CpuProfileSnapshot& snapshot, uint32_t numFrames, const std::filesystem::path& path);
+// Flame view of the latest complete frame per thread, counters, and trace export into traceDir
+void drawCpuProfilerWindow(const std::filesystem::path& traceDir);
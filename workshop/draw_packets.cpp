@@ -0,0 +1,46 @@
+#include "draw_packets.hpp"
+
+#include "cpu_profiler.hpp"
+#include "job_system.hpp"
+#include "residency.hpp"
+
+#include <algorithm>
+
+void recordDrawPackets(DrawPacketList& list, JobSystem* jobs, uint32_t count, uint32_t grainSize, const RecordDrawPacketsFn& record) {
+  CPU_PROFILE_ZONE("Record draw packets");
+  grainSize = std::max(1u, grainSize);
+  list.numChunks = (count + grainSize - 1) / grainSize;
+  if (list.chunks.size() < list.numChunks)
+    list.chunks.resize(list.numChunks);
+  for (uint32_t chunkIx = 0; chunkIx < list.numChunks; ++chunkIx)
+    list.chunks[chunkIx].clear();
+  parallelFor(jobs, count, grainSize, [&](uint32_t begin, uint32_t end) {
+    // parallelFor hands out whole chunks of grainSize, except for a serial run over everything
+    for (uint32_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize)
+      record(chunkBegin, std::min(chunkBegin + grainSize, end), list.chunks[chunkBegin / grainSize]);
+  });
+}
+
+DrawPacketStats replayDrawPackets(const DrawPacketList& list, GLuint perObjectBuffer, GLuint perObjectBinding, GLsizeiptr perObjectStride, ResidencyManager* residency, DrawPacketStream stream) {
+  CPU_PROFILE_ZONE("Replay draw packets");
+  DrawPacketStats stats;
+  GLuint boundVertexArray = 0;
+  for (uint32_t chunkIx = 0; chunkIx < list.numChunks; ++chunkIx) {
+    for (const DrawPacket& packet : list.chunks[chunkIx]) {
+      // Restoring evicted buffers is GL work, so it happens here rather than while recording
+      if (residency != nullptr)
+        useMesh(*residency, packet.meshHandle);
+      glBindBufferRange(GL_UNIFORM_BUFFER, perObjectBinding, perObjectBuffer, perObjectStride * packet.objectIx, perObjectStride);
+      const GLuint vertexArray = stream == DrawPacketStream::Positions ? packet.positionVertexArray : packet.vertexArray;
+      if (vertexArray != boundVertexArray) {
+        glBindVertexArray(vertexArray);
+        boundVertexArray = vertexArray;
+      }
+      glDrawElementsInstancedBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(packet.numIndices), GL_UNSIGNED_INT, nullptr, 1, packet.materialId);
+      ++stats.drawCalls;
+      stats.triangles += packet.numIndices / 3;
+    }
+  }
+  glBindVertexArray(0);
+  return stats;
+}
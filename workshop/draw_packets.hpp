@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class JobSystem;
+struct ResidencyManager;
+
+// One indexed draw, recorded off the GL thread and replayed on it
+struct DrawPacket {
+  GLuint vertexArray;
+  // Position-only stream of the same mesh, see MeshGpu
+  GLuint positionVertexArray;
+  uint32_t numIndices;
+  // Reaches the shaders as gl_BaseInstance
+  uint32_t materialId;
+  // Element of the per-object uniform buffer bound for the draw
+  uint32_t objectIx;
+  // Passed to useMesh on replay, unless there is no residency manager
+  uint32_t meshHandle;
+};
+
+// Packets of a frame in linear buffers, one per chunk of recorded objects. Each chunk is recorded by a single thread
+// and replayed in chunk order, so the draw order does not depend on which worker recorded what. Buffers keep their
+// capacity from frame to frame.
+struct DrawPacketList {
+  std::vector<std::vector<DrawPacket>> chunks;
+  uint32_t numChunks{};
+};
+
+using RecordDrawPacketsFn = std::function<void(uint32_t begin, uint32_t end, std::vector<DrawPacket>& out)>;
+
+// Clear list and call record for chunks of grainSize objects of [0, count), spread over the job system. record may
+// write per-object data to persistently mapped buffers but must not call GL. Serial when jobs is null.
+void recordDrawPackets(DrawPacketList& list, JobSystem* jobs, uint32_t count, uint32_t grainSize, const RecordDrawPacketsFn& record);
+
+enum class DrawPacketStream : uint8_t {
+  // Every vertex attribute, for shading
+  Full,
+  // Positions only, for depth passes
+  Positions,
+};
+
+struct DrawPacketStats {
+  uint32_t drawCalls{};
+  uint64_t triangles{};
+};
+
+// GL thread. Binds element objectIx of perObjectBuffer to uniform binding perObjectBinding and draws every packet with
+// the pipeline that is bound, reading stream. Vertex arrays are only rebound when they change.
+DrawPacketStats replayDrawPackets(const DrawPacketList& list, GLuint perObjectBuffer, GLuint perObjectBinding, GLsizeiptr perObjectStride, ResidencyManager* residency, DrawPacketStream stream = DrawPacketStream::Full);
@@ -0,0 +1,63 @@
+#include "dynamic_resolution.hpp"
+
+#include "gpu_profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr float kSmoothing = 0.2f;
+// Before a decision, so a single slow frame does not drop the resolution
+constexpr uint32_t kMinSamples = 4;
+// Middle of the hysteresis band
+constexpr float kTargetShare = 0.5f * (1.f + kDynamicResolutionRaiseBelow);
+// An optimistic estimate costs frames until the next change, so raises are small. Drops are not limited.
+constexpr float kMaxRaise = 2.f * kDynamicResolutionStep;
+}  // namespace
+
+void updateDynamicResolution(DynamicResolution& resolution, const GpuProfiler& profiler, std::initializer_list<const char*> scaledPasses) {
+  if (profiler.resolvedFrames == resolution.lastResolvedFrame)
+    return;
+  const auto newFrames = static_cast<uint32_t>(std::min<uint64_t>(profiler.resolvedFrames - resolution.lastResolvedFrame, kGpuProfilerLatency));
+  resolution.lastResolvedFrame = profiler.resolvedFrames;
+  if (resolution.settleFrames > 0) {
+    resolution.settleFrames -= std::min(resolution.settleFrames, newFrames);
+    return;
+  }
+
+  const float frameMs = getLatestGpuZoneMs(profiler, "Frame");
+  float scaledMs = 0.f;
+  for (const char* pass : scaledPasses)
+    scaledMs += getLatestGpuZoneMs(profiler, pass);
+  const float smoothing = resolution.numSamples == 0 ? 1.f : kSmoothing;
+  resolution.frameMs += (frameMs - resolution.frameMs) * smoothing;
+  resolution.scaledMs += (scaledMs - resolution.scaledMs) * smoothing;
+  ++resolution.numSamples;
+  if (!resolution.enabled || resolution.numSamples < kMinSamples)
+    return;
+
+  const float scale = resolution.scale;
+  const bool tooSlow = resolution.frameMs > resolution.targetFrameMs && scale > resolution.minScale;
+  const bool headroom = resolution.frameMs < resolution.targetFrameMs * kDynamicResolutionRaiseBelow && scale < resolution.maxScale;
+  if (!tooSlow && !headroom)
+    return;
+
+  float desired = scale + (tooSlow ? -kDynamicResolutionStep : kDynamicResolutionStep);
+  if (resolution.scaledMs > 0.f) {
+    const float fixedMs = std::max(resolution.frameMs - resolution.scaledMs, 0.f);
+    const float msPerScaleSquared = resolution.scaledMs / (scale * scale);
+    desired = std::sqrt(std::max(resolution.targetFrameMs * kTargetShare - fixedMs, 0.f) / msPerScaleSquared);
+  }
+  // Rounded down, so drops go far enough and raises do not overshoot. Every decision moves by at least one step.
+  desired = std::floor(std::min(desired, scale + kMaxRaise) / kDynamicResolutionStep + 1e-3f) * kDynamicResolutionStep;
+  desired = tooSlow ? std::min(desired, scale - kDynamicResolutionStep) : std::max(desired, scale + kDynamicResolutionStep);
+  resolution.scale = std::clamp(desired, resolution.minScale, resolution.maxScale);
+  // Frames recorded before the change are still to be resolved
+  resolution.numSamples = 0;
+  resolution.settleFrames = kGpuProfilerLatency;
+  ++resolution.numChanges;
+}
+
+uint32_t getScaledSize(const DynamicResolution& resolution, uint32_t size) {
+  return std::max(1u, static_cast<uint32_t>(std::lround(static_cast<float>(size) * resolution.scale)));
+}
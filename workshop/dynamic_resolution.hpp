@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+
+struct GpuProfiler;
+
+// Resolution drops as soon as the GPU frame time is above the target, and rises again only once it is below this
+// share of the target, so the scale does not oscillate around it
+constexpr float kDynamicResolutionRaiseBelow = 0.85f;
+// Scales are multiples of this, so render targets are not reallocated for every small change
+constexpr float kDynamicResolutionStep = 0.05f;
+
+// Scale of the scene render targets relative to the output, driven by the GPU profiler. The passes at scene resolution
+// are assumed to cost in proportion to their pixel count, the rest of the frame to stay fixed.
+struct DynamicResolution {
+  bool enabled{true};
+  float targetFrameMs{1000.f / 60.f};
+  float minScale{0.5f};
+  float maxScale{1.f};
+  // Of width and height
+  float scale{1.f};
+  // Smoothed GPU time of the frame and of the passes at scene resolution, since the last change
+  float frameMs{};
+  float scaledMs{};
+  uint32_t numSamples{};
+  // Resolved frames still to skip after a change, they were recorded at the previous scale
+  uint32_t settleFrames{};
+  uint64_t lastResolvedFrame{};
+  uint32_t numChanges{};
+};
+
+// Once per frame, before the scene render targets are sized. scaledPasses name the GPU zones rendering at scene
+// resolution.
+void updateDynamicResolution(DynamicResolution& resolution, const GpuProfiler& profiler, std::initializer_list<const char*> scaledPasses);
+// At least 1
+uint32_t getScaledSize(const DynamicResolution& resolution, uint32_t size);
@@ -0,0 +1,75 @@
+#include "frame_pipeline.hpp"
+
+#include "cpu_profiler.hpp"
+
+#include <chrono>
+#include <print>
+
+namespace {
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}  // namespace
+
+void waitForFence(GLsync fence) {
+  // Flushing once is enough for the fence to be reached, timeouts only mean a slow frame
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  for (;;) {
+    const GLenum status = glClientWaitSync(fence, flags, 1'000'000'000);
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+      return;
+    if (status == GL_WAIT_FAILED) {
+      std::println("Waiting for a fence failed, finishing the GPU queue instead");
+      glFinish();
+      return;
+    }
+    flags = 0;
+  }
+}
+
+void beginFrameSimulation(FramePipeline& pipeline, SimulateFrameFn simulate) {
+  const uint64_t frame = pipeline.nextSimulatedFrame++;
+  const uint32_t slot = getFrameSlot(frame);
+  GLsync& fence = pipeline.fences[slot];
+  const auto start = std::chrono::steady_clock::now();
+  if (fence != nullptr) {
+    CPU_PROFILE_ZONE("Wait for GPU");
+    waitForFence(fence);
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+  pipeline.fenceWaitMs = millisecondsSince(start);
+  recordCpuCounter("Frame fence wait ms", pipeline.fenceWaitMs);
+  pipeline.jobs->submit([simulate = std::move(simulate), frame, slot] {
+    CPU_PROFILE_ZONE("Simulate frame");
+    simulate(frame, slot);
+  }, &pipeline.simulations[slot]);
+}
+
+uint32_t waitForFrameSimulation(FramePipeline& pipeline, uint64_t frame) {
+  const uint32_t slot = getFrameSlot(frame);
+  const auto start = std::chrono::steady_clock::now();
+  {
+    CPU_PROFILE_ZONE("Wait for simulation");
+    pipeline.jobs->wait(pipeline.simulations[slot]);
+  }
+  pipeline.simulationWaitMs = millisecondsSince(start);
+  recordCpuCounter("Simulation wait ms", pipeline.simulationWaitMs);
+  return slot;
+}
+
+void endFrameSubmission(FramePipeline& pipeline, uint64_t frame) {
+  pipeline.fences[getFrameSlot(frame)] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void destroyFramePipeline(FramePipeline& pipeline) {
+  if (pipeline.jobs != nullptr) {
+    for (JobCounter& simulation : pipeline.simulations)
+      pipeline.jobs->wait(simulation);
+  }
+  for (GLsync& fence : pipeline.fences) {
+    if (fence != nullptr)
+      glDeleteSync(fence);
+    fence = nullptr;
+  }
+}
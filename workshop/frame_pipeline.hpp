@@ -0,0 +1,39 @@
+#pragma once
+
+#include "job_system.hpp"
+
+#include <glad/gl.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+// One frame being simulated, one being submitted by the GL thread and one executing on the GPU
+constexpr uint32_t kFramesInFlight = 3;
+
+// Two stage frame loop. A simulation job prepares frame N+1 in its own slot of per-frame data while the GL thread
+// submits frame N from another slot. A slot is handed to the simulation only once the GPU finished the frame that used
+// it last, which bounds how far the CPU runs ahead of the GPU.
+struct FramePipeline {
+  JobSystem* jobs{};
+  std::array<GLsync, kFramesInFlight> fences{};
+  std::array<JobCounter, kFramesInFlight> simulations;
+  uint64_t nextSimulatedFrame{};
+  // Time the GL thread was blocked on the GPU and on the simulation during the last frame
+  double fenceWaitMs{};
+  double simulationWaitMs{};
+};
+
+using SimulateFrameFn = std::function<void(uint64_t frame, uint32_t slot)>;
+
+// Blocks until the GPU passed fence, however long that takes. Finishes the whole queue instead when waiting fails.
+void waitForFence(GLsync fence);
+inline uint32_t getFrameSlot(uint64_t frame) { return static_cast<uint32_t>(frame % kFramesInFlight); }
+// GL thread. Waits until the GPU is done with the slot of the next frame, then runs simulate for it as a job.
+void beginFrameSimulation(FramePipeline& pipeline, SimulateFrameFn simulate);
+// GL thread. Waits for the simulation of frame, which has to be begun already, and returns its slot.
+uint32_t waitForFrameSimulation(FramePipeline& pipeline, uint64_t frame);
+// GL thread, after the last command reading the slot of frame was issued
+void endFrameSubmission(FramePipeline& pipeline, uint64_t frame);
+// Waits for the simulation in flight
+void destroyFramePipeline(FramePipeline& pipeline);
@@ -0,0 +1,163 @@
+#include "gpu_memory.hpp"
+
+#include <algorithm>
+
+namespace {
+void addAllocation(GpuMemoryTracker& tracker, std::unordered_map<GLuint, GpuAllocation>& allocations, GLuint name, GpuMemoryCategory category, size_t size) {
+  // Immutable storage cannot be respecified, but names can be reused after deletion by untracked code
+  if (const auto it = allocations.find(name); it != allocations.end()) {
+    tracker.bytes[static_cast<size_t>(it->second.category)] -= it->second.size;
+    tracker.totalBytes -= it->second.size;
+  }
+  allocations[name] = {category, size};
+  tracker.bytes[static_cast<size_t>(category)] += size;
+  tracker.peakBytes[static_cast<size_t>(category)] = std::max(tracker.peakBytes[static_cast<size_t>(category)], tracker.bytes[static_cast<size_t>(category)]);
+  tracker.totalBytes += size;
+  tracker.peakTotalBytes = std::max(tracker.peakTotalBytes, tracker.totalBytes);
+}
+
+void removeAllocation(GpuMemoryTracker& tracker, std::unordered_map<GLuint, GpuAllocation>& allocations, GLuint name) {
+  const auto it = allocations.find(name);
+  if (it == allocations.end())
+    return;
+  tracker.bytes[static_cast<size_t>(it->second.category)] -= it->second.size;
+  tracker.totalBytes -= it->second.size;
+  allocations.erase(it);
+}
+
+struct FormatSize {
+  // Bytes per texel, or per 4x4 block for compressed formats
+  uint32_t bytes;
+  bool blockCompressed;
+};
+
+FormatSize getFormatSize(GLenum internalFormat) {
+  switch (internalFormat) {
+    case GL_R8:
+      return {1, false};
+    case GL_RG8:
+    case GL_R16F:
+      return {2, false};
+    // Three component formats are usually padded to four
+    case GL_RGB8:
+    case GL_SRGB8:
+    case GL_RGBA8:
+    case GL_SRGB8_ALPHA8:
+    case GL_R32F:
+    case GL_R32UI:
+    case GL_RG16F:
+    case GL_R11F_G11F_B10F:
+    case GL_RGB10_A2:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32F:
+    case GL_DEPTH24_STENCIL8:
+      return {4, false};
+    case GL_RGBA16F:
+    case GL_RG32F:
+    case GL_DEPTH32F_STENCIL8:
+      return {8, false};
+    case GL_RGBA32F:
+      return {16, false};
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RED_RGTC1:
+      return {8, true};
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RG_RGTC2:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+      return {16, true};
+    default:
+      return {4, false};
+  }
+}
+}  // namespace
+
+const char* getGpuMemoryCategoryName(GpuMemoryCategory category) {
+  switch (category) {
+    case GpuMemoryCategory::Meshes:
+      return "Meshes";
+    case GpuMemoryCategory::UniformBuffers:
+      return "Uniform buffers";
+    case GpuMemoryCategory::StorageBuffers:
+      return "Storage buffers";
+    case GpuMemoryCategory::Textures:
+      return "Textures";
+    case GpuMemoryCategory::Staging:
+      return "Staging";
+    case GpuMemoryCategory::RenderTargets:
+      return "Render targets";
+    case GpuMemoryCategory::Count:
+      break;
+  }
+  return "?";
+}
+
+GpuMemoryTracker& getGpuMemoryTracker() {
+  static GpuMemoryTracker tracker;
+  return tracker;
+}
+
+size_t computeTextureStorageSize(GLenum internalFormat, uint32_t width, uint32_t height, uint32_t depth, uint32_t levels) {
+  const FormatSize format = getFormatSize(internalFormat);
+  size_t size = 0;
+  for (uint32_t level = 0; level < levels; ++level) {
+    const uint32_t w = std::max(1u, width >> level);
+    const uint32_t h = std::max(1u, height >> level);
+    size += format.blockCompressed ? size_t{(w + 3) / 4} * ((h + 3) / 4) * format.bytes : size_t{w} * h * format.bytes;
+  }
+  // Array layers do not shrink with the levels
+  return size * depth;
+}
+
+void trackedNamedBufferStorage(GpuMemoryCategory category, GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags) {
+  glNamedBufferStorage(buffer, size, data, flags);
+  GpuMemoryTracker& tracker = getGpuMemoryTracker();
+  addAllocation(tracker, tracker.buffers, buffer, category, static_cast<size_t>(size));
+}
+
+void trackedTextureStorage2D(GpuMemoryCategory category, GLuint texture, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height) {
+  glTextureStorage2D(texture, levels, internalFormat, width, height);
+  GpuMemoryTracker& tracker = getGpuMemoryTracker();
+  addAllocation(tracker, tracker.textures, texture, category, computeTextureStorageSize(internalFormat, static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1, static_cast<uint32_t>(levels)));
+}
+
+void trackedTextureStorage3D(GpuMemoryCategory category, GLuint texture, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei depth) {
+  glTextureStorage3D(texture, levels, internalFormat, width, height, depth);
+  GpuMemoryTracker& tracker = getGpuMemoryTracker();
+  addAllocation(tracker, tracker.textures, texture, category, computeTextureStorageSize(internalFormat, static_cast<uint32_t>(width), static_cast<uint32_t>(height), static_cast<uint32_t>(depth), static_cast<uint32_t>(levels)));
+}
+
+void trackedTextureStorage2DMultisample(GpuMemoryCategory category, GLuint texture, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height) {
+  glTextureStorage2DMultisample(texture, samples, internalFormat, width, height, GL_TRUE);
+  GpuMemoryTracker& tracker = getGpuMemoryTracker();
+  const size_t size = computeTextureStorageSize(internalFormat, static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1, 1);
+  addAllocation(tracker, tracker.textures, texture, category, size * static_cast<size_t>(std::max(samples, 1)));
+}
+
+void trackedNamedRenderbufferStorageMultisample(GpuMemoryCategory category, GLuint renderbuffer, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height) {
+  glNamedRenderbufferStorageMultisample(renderbuffer, samples, internalFormat, width, height);
+  GpuMemoryTracker& tracker = getGpuMemoryTracker();
+  const size_t size = computeTextureStorageSize(internalFormat, static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1, 1);
+  addAllocation(tracker, tracker.renderbuffers, renderbuffer, category, size * static_cast<size_t>(std::max(samples, 1)));
+}
+
+void trackedDeleteBuffers(GLsizei n, const GLuint* buffers) {
+  GpuMemoryTracker& tracker = getGpuMemoryTracker();
+  for (GLsizei i = 0; i < n; ++i)
+    removeAllocation(tracker, tracker.buffers, buffers[i]);
+  glDeleteBuffers(n, buffers);
+}
+
+void trackedDeleteTextures(GLsizei n, const GLuint* textures) {
+  GpuMemoryTracker& tracker = getGpuMemoryTracker();
+  for (GLsizei i = 0; i < n; ++i)
+    removeAllocation(tracker, tracker.textures, textures[i]);
+  glDeleteTextures(n, textures);
+}
+
+void trackedDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+  GpuMemoryTracker& tracker = getGpuMemoryTracker();
+  for (GLsizei i = 0; i < n; ++i)
+    removeAllocation(tracker, tracker.renderbuffers, renderbuffers[i]);
+  glDeleteRenderbuffers(n, renderbuffers);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+enum class GpuMemoryCategory : uint8_t {
+  Meshes,
+  UniformBuffers,
+  StorageBuffers,
+  Textures,
+  // Upload and readback buffers
+  Staging,
+  // Renderbuffers and framebuffer attachments
+  RenderTargets,
+  Count,
+};
+constexpr size_t kNumGpuMemoryCategories = static_cast<size_t>(GpuMemoryCategory::Count);
+
+const char* getGpuMemoryCategoryName(GpuMemoryCategory category);
+
+struct GpuAllocation {
+  GpuMemoryCategory category{};
+  size_t size{};
+};
+
+// Sizes of the immutable storage allocated through the wrappers below. Texture sizes are estimated from the internal
+// format, drivers may pad. GL thread only, like the calls themselves.
+struct GpuMemoryTracker {
+  std::array<size_t, kNumGpuMemoryCategories> bytes{};
+  std::array<size_t, kNumGpuMemoryCategories> peakBytes{};
+  size_t totalBytes{};
+  size_t peakTotalBytes{};
+  std::unordered_map<GLuint, GpuAllocation> buffers;
+  std::unordered_map<GLuint, GpuAllocation> textures;
+  std::unordered_map<GLuint, GpuAllocation> renderbuffers;
+};
+
+GpuMemoryTracker& getGpuMemoryTracker();
+
+size_t computeTextureStorageSize(GLenum internalFormat, uint32_t width, uint32_t height, uint32_t depth, uint32_t levels);
+
+// glNamedBufferStorage, glTextureStorage2D/3D/2DMultisample, glNamedRenderbufferStorageMultisample and glDelete* that
+// keep GpuMemoryTracker up to date
+void trackedNamedBufferStorage(GpuMemoryCategory category, GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+void trackedTextureStorage2D(GpuMemoryCategory category, GLuint texture, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height);
+void trackedTextureStorage3D(GpuMemoryCategory category, GLuint texture, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei depth);
+void trackedTextureStorage2DMultisample(GpuMemoryCategory category, GLuint texture, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height);
+void trackedNamedRenderbufferStorageMultisample(GpuMemoryCategory category, GLuint renderbuffer, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height);
+void trackedDeleteBuffers(GLsizei n, const GLuint* buffers);
+void trackedDeleteTextures(GLsizei n, const GLuint* textures);
+void trackedDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers);
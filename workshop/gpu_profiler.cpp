@@ -0,0 +1,238 @@
+#include "gpu_profiler.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+namespace {
+GLuint allocateQuery(GpuProfiler& profiler) {
+  if (profiler.freeQueries.empty()) {
+    // Grown in batches, a frame with a few dozen zones needs a few hundred queries in flight
+    std::array<GLuint, 32> queries{};
+    glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(queries.size()), queries.data());
+    profiler.freeQueries.insert(profiler.freeQueries.end(), queries.begin(), queries.end());
+  }
+  const GLuint query = profiler.freeQueries.back();
+  profiler.freeQueries.pop_back();
+  return query;
+}
+
+uint32_t getOrCreateStats(GpuProfiler& profiler, const GpuZoneRecord& zone, uint32_t parentStats) {
+  std::string path = parentStats == kNoGpuZone ? std::string{zone.name} : std::format("{}/{}", parentStats, zone.name);
+  const auto [it, inserted] = profiler.statsByPath.try_emplace(std::move(path), static_cast<uint32_t>(profiler.stats.size()));
+  if (inserted) {
+    GpuZoneStats& stats = profiler.stats.emplace_back();
+    stats.name = zone.name;
+    stats.parent = parentStats;
+    stats.depth = zone.depth;
+  }
+  return it->second;
+}
+
+void resolveFrame(GpuProfiler& profiler, GpuProfilerFrame& frame) {
+  for (GpuZoneStats& stats : profiler.stats)
+    stats.lastStartMs = stats.lastEndMs = -1.f;
+
+  // Zones with the same path that run several times in a frame are summed up
+  std::vector<float> frameMs(profiler.stats.size(), 0.f);
+  std::vector<uint32_t> statsIxs(frame.zones.size());
+  GLuint64 frameBegin{};
+  for (size_t zoneIx = 0; zoneIx < frame.zones.size(); ++zoneIx) {
+    const GpuZoneRecord& zone = frame.zones[zoneIx];
+    GLuint64 begin{}, end{};
+    glGetQueryObjectui64v(zone.beginQuery, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+    profiler.freeQueries.push_back(zone.beginQuery);
+    profiler.freeQueries.push_back(zone.endQuery);
+    if (zoneIx == 0)
+      frameBegin = begin;
+
+    const uint32_t statsIx = getOrCreateStats(profiler, zone, zoneIx == 0 ? kNoGpuZone : statsIxs[zone.parent]);
+    statsIxs[zoneIx] = statsIx;
+    frameMs.resize(profiler.stats.size(), 0.f);
+    frameMs[statsIx] += static_cast<float>(end - begin) * 1e-6f;
+    GpuZoneStats& stats = profiler.stats[statsIx];
+    const float startMs = static_cast<float>(begin - frameBegin) * 1e-6f;
+    const float endMs = static_cast<float>(end - frameBegin) * 1e-6f;
+    stats.lastStartMs = stats.lastStartMs < 0.f ? startMs : std::min(stats.lastStartMs, startMs);
+    stats.lastEndMs = std::max(stats.lastEndMs, endMs);
+  }
+  for (size_t statsIx = 0; statsIx < profiler.stats.size(); ++statsIx) {
+    GpuZoneStats& stats = profiler.stats[statsIx];
+    if (stats.lastStartMs < 0.f)
+      continue;
+    stats.historyMs[stats.nextSample] = frameMs[statsIx];
+    stats.nextSample = (stats.nextSample + 1) % kGpuZoneHistorySize;
+    stats.numSamples = std::min(stats.numSamples + 1, kGpuZoneHistorySize);
+  }
+  if (profiler.keepFrameTimes)
+    profiler.frameTimesMs.push_back(frameMs.front());
+  frame.zones.clear();
+  frame.recorded = false;
+  ++profiler.resolvedFrames;
+}
+
+// Children were created after their parent, walking the tree depth first keeps them under it
+void drawZoneRow(const GpuProfiler& profiler, uint32_t statsIx, std::vector<float>& sorted) { // NOLINT(*-no-recursion)
+  const GpuZoneStats& stats = profiler.stats[statsIx];
+  sorted.assign(stats.historyMs.begin(), stats.historyMs.begin() + stats.numSamples);
+  std::ranges::sort(sorted);
+  // Nearest rank, the smallest sample with at least p of all samples at or below it
+  const auto percentile = [&](float p) { return sorted.empty() ? 0.f : sorted[std::max<size_t>(static_cast<size_t>(std::ceil(static_cast<double>(p) * static_cast<double>(sorted.size()))), 1) - 1]; };
+  float sum = 0.f;
+  for (const float ms : sorted)
+    sum += ms;
+  ImGui::TableNextRow();
+  ImGui::TableNextColumn();
+  ImGui::Text("%*s%s", static_cast<int>(stats.depth * 2), "", stats.name.c_str());
+  ImGui::TableNextColumn();
+  ImGui::Text("%.3f", sorted.empty() ? 0.f : sum / static_cast<float>(sorted.size()));
+  for (const float p : {0.f, 1.f, 0.5f, 0.95f, 0.99f}) {
+    ImGui::TableNextColumn();
+    ImGui::Text("%.3f", percentile(p));
+  }
+  for (uint32_t childIx = statsIx + 1; childIx < profiler.stats.size(); ++childIx) {
+    if (profiler.stats[childIx].parent == statsIx)
+      drawZoneRow(profiler, childIx, sorted);
+  }
+}
+}  // namespace
+
+void beginGpuProfilerFrame(GpuProfiler& profiler) {
+  profiler.recording = false;
+  if (!profiler.enabled)
+    return;
+
+  GpuProfilerFrame& frame = profiler.frames[profiler.frame % kGpuProfilerLatency];
+  if (frame.recorded) {
+    // The frame zone ends last, once it is available all queries of the frame are
+    GLuint available{};
+    glGetQueryObjectuiv(frame.zones.front().endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == 0) {
+      ++profiler.droppedFrames;
+      return;
+    }
+    resolveFrame(profiler, frame);
+  }
+  profiler.recording = true;
+  beginGpuZone(profiler, "Frame");
+}
+
+void endGpuProfilerFrame(GpuProfiler& profiler) {
+  if (!profiler.recording)
+    return;
+  // Zones left open are closed with the frame
+  while (!profiler.openZones.empty())
+    endGpuZone(profiler);
+  profiler.frames[profiler.frame % kGpuProfilerLatency].recorded = true;
+  profiler.recording = false;
+  ++profiler.frame;
+}
+
+void beginGpuZone(GpuProfiler& profiler, const char* name) {
+  if (!profiler.recording)
+    return;
+  GpuProfilerFrame& frame = profiler.frames[profiler.frame % kGpuProfilerLatency];
+  GpuZoneRecord& zone = frame.zones.emplace_back();
+  zone.name = name;
+  zone.parent = profiler.openZones.empty() ? kNoGpuZone : profiler.openZones.back();
+  zone.depth = static_cast<uint32_t>(profiler.openZones.size());
+  zone.beginQuery = allocateQuery(profiler);
+  zone.endQuery = allocateQuery(profiler);
+  glQueryCounter(zone.beginQuery, GL_TIMESTAMP);
+  profiler.openZones.push_back(static_cast<uint32_t>(frame.zones.size() - 1));
+}
+
+void endGpuZone(GpuProfiler& profiler) {
+  if (!profiler.recording || profiler.openZones.empty())
+    return;
+  const GpuProfilerFrame& frame = profiler.frames[profiler.frame % kGpuProfilerLatency];
+  glQueryCounter(frame.zones[profiler.openZones.back()].endQuery, GL_TIMESTAMP);
+  profiler.openZones.pop_back();
+}
+
+void flushGpuProfiler(GpuProfiler& profiler) {
+  // The slot recorded into next holds the oldest frame
+  for (uint32_t frameIx = 0; frameIx < kGpuProfilerLatency; ++frameIx) {
+    GpuProfilerFrame& frame = profiler.frames[(profiler.frame + frameIx) % kGpuProfilerLatency];
+    if (frame.recorded)
+      resolveFrame(profiler, frame);
+  }
+}
+
+void destroyGpuProfiler(GpuProfiler& profiler) {
+  for (GpuProfilerFrame& frame : profiler.frames) {
+    for (const GpuZoneRecord& zone : frame.zones) {
+      profiler.freeQueries.push_back(zone.beginQuery);
+      profiler.freeQueries.push_back(zone.endQuery);
+    }
+    frame.zones.clear();
+    frame.recorded = false;
+  }
+  glDeleteQueries(static_cast<GLsizei>(profiler.freeQueries.size()), profiler.freeQueries.data());
+  profiler.freeQueries.clear();
+  profiler.openZones.clear();
+  profiler.stats.clear();
+  profiler.statsByPath.clear();
+}
+
+float getLatestGpuZoneMs(const GpuProfiler& profiler, std::string_view name) {
+  float ms = 0.f;
+  for (const GpuZoneStats& stats : profiler.stats) {
+    if (stats.lastStartMs >= 0.f && stats.name == name)
+      ms += stats.historyMs[(stats.nextSample + kGpuZoneHistorySize - 1) % kGpuZoneHistorySize];
+  }
+  return ms;
+}
+
+void drawGpuProfilerWindow(GpuProfiler& profiler) {
+  ImGui::Begin("GPU profiler");
+  ImGui::Checkbox("Enabled", &profiler.enabled);
+  ImGui::SameLine();
+  ImGui::Text("%llu frames dropped waiting for queries", static_cast<unsigned long long>(profiler.droppedFrames));
+
+  constexpr ImGuiTableFlags kTableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit;
+  if (ImGui::BeginTable("Zones", 7, kTableFlags)) {
+    for (const char* column : {"Zone", "Avg ms", "Min", "Max", "P50", "P95", "P99"})
+      ImGui::TableSetupColumn(column);
+    ImGui::TableHeadersRow();
+    std::vector<float> sorted;
+    for (uint32_t statsIx = 0; statsIx < profiler.stats.size(); ++statsIx) {
+      if (profiler.stats[statsIx].parent == kNoGpuZone)
+        drawZoneRow(profiler, statsIx, sorted);
+    }
+    ImGui::EndTable();
+  }
+
+  // Timeline of the latest resolved frame, one row per nesting depth
+  const GpuZoneStats* frameStats = profiler.stats.empty() ? nullptr : &profiler.stats.front();
+  if (frameStats != nullptr && frameStats->lastEndMs > 0.f) {
+    ImGui::SeparatorText("Latest frame");
+    uint32_t maxDepth = 0;
+    for (const GpuZoneStats& stats : profiler.stats)
+      maxDepth = std::max(maxDepth, stats.depth);
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 64.f);
+    const float msToPixels = width / frameStats->lastEndMs;
+    ImDrawList& drawList = *ImGui::GetWindowDrawList();
+    for (size_t statsIx = 0; statsIx < profiler.stats.size(); ++statsIx) {
+      const GpuZoneStats& stats = profiler.stats[statsIx];
+      if (stats.lastStartMs < 0.f)
+        continue;
+      const ImVec2 min{origin.x + stats.lastStartMs * msToPixels, origin.y + static_cast<float>(stats.depth) * rowHeight};
+      const ImVec2 max{std::max(origin.x + stats.lastEndMs * msToPixels, min.x + 1.f), min.y + rowHeight - 1.f};
+      const ImU32 color = ImGui::GetColorU32(ImVec4{0.3f + 0.15f * static_cast<float>(statsIx % 4), 0.5f, 0.8f - 0.1f * static_cast<float>(stats.depth % 4), 1.f});
+      drawList.AddRectFilled(min, max, color);
+      drawList.PushClipRect(min, max, true);
+      drawList.AddText(ImVec2{min.x + 2.f, min.y}, IM_COL32_WHITE, stats.name.c_str());
+      drawList.PopClipRect();
+      if (ImGui::IsMouseHoveringRect(min, max))
+        ImGui::SetTooltip("%s: %.3f ms, starts at %.3f ms", stats.name.c_str(), stats.lastEndMs - stats.lastStartMs, stats.lastStartMs);
+    }
+    ImGui::Dummy(ImVec2{width, static_cast<float>(maxDepth + 1) * rowHeight});
+  }
+  ImGui::End();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Frames between recording a zone and reading its queries back. Results usually are available by then, so reading them
+// does not stall the pipeline.
+constexpr uint32_t kGpuProfilerLatency = 4;
+constexpr uint32_t kGpuZoneHistorySize = 240;
+constexpr uint32_t kNoGpuZone = 0xFFFFFFFF;
+
+struct GpuZoneRecord {
+  // String literal, zones are identified by name and parent
+  const char* name{};
+  // Index into the frame's zones
+  uint32_t parent{kNoGpuZone};
+  uint32_t depth{};
+  GLuint beginQuery{};
+  GLuint endQuery{};
+};
+
+struct GpuProfilerFrame {
+  // Zone 0 is the whole frame
+  std::vector<GpuZoneRecord> zones;
+  bool recorded{};
+};
+
+// Rolling durations of one zone, keyed by its path from the frame zone
+struct GpuZoneStats {
+  std::string name;
+  // Index into GpuProfiler::stats
+  uint32_t parent{kNoGpuZone};
+  uint32_t depth{};
+  std::array<float, kGpuZoneHistorySize> historyMs{};
+  uint32_t numSamples{};
+  uint32_t nextSample{};
+  // In the latest resolved frame, relative to its start. Negative when the zone did not run in it.
+  float lastStartMs{-1.f};
+  float lastEndMs{-1.f};
+};
+
+// Scoped GPU zones measured with GL_TIMESTAMP queries. Timestamps nest, unlike GL_TIME_ELAPSED queries, so zones can be
+// hierarchical. Queries are recycled through a pool, and a frame is not recorded when the queries of the frame
+// kGpuProfilerLatency earlier are still pending.
+struct GpuProfiler {
+  bool enabled{true};
+  std::array<GpuProfilerFrame, kGpuProfilerLatency> frames;
+  uint64_t frame{};
+  std::vector<GLuint> freeQueries;
+  // Indices into the recording frame's zones
+  std::vector<uint32_t> openZones;
+  bool recording{};
+  // Index 0 is the frame zone. Sorted by first appearance, so children follow their parent.
+  std::vector<GpuZoneStats> stats;
+  std::unordered_map<std::string, uint32_t> statsByPath;
+  uint64_t droppedFrames{};
+  // Incremented for every resolved frame, to tell whether the latest durations are new
+  uint64_t resolvedFrames{};
+  // Frame zone duration of every resolved frame, in resolve order, while set
+  bool keepFrameTimes{};
+  std::vector<float> frameTimesMs;
+};
+
+// Call at the start and end of every frame, on the GL thread
+void beginGpuProfilerFrame(GpuProfiler& profiler);
+void endGpuProfilerFrame(GpuProfiler& profiler);
+void beginGpuZone(GpuProfiler& profiler, const char* name);
+void endGpuZone(GpuProfiler& profiler);
+// Wait for and resolve every recorded frame, for measurements that must not lag behind
+void flushGpuProfiler(GpuProfiler& profiler);
+void destroyGpuProfiler(GpuProfiler& profiler);
+// Duration of the zones called name in the latest resolved frame, summed up. Zero when none of them ran in it.
+float getLatestGpuZoneMs(const GpuProfiler& profiler, std::string_view name);
+
+struct GpuZoneScope {
+  GpuZoneScope(GpuProfiler& profiler, const char* name) : profiler(profiler) { beginGpuZone(profiler, name); }
+  ~GpuZoneScope() { endGpuZone(profiler); }
+  GpuZoneScope(const GpuZoneScope&) = delete;
+  GpuZoneScope& operator=(const GpuZoneScope&) = delete;
+  GpuProfiler& profiler;
+};
+
+// Hierarchical table with rolling average, min, max and percentiles, and a timeline of the latest resolved frame
+void drawGpuProfilerWindow(GpuProfiler& profiler);
@@ -0,0 +1,299 @@
+#include "job_system.hpp"
+
+#include "cpu_profiler.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+
+struct Job {
+  std::function<void()> fn;
+  JobCounter* counter{};
+};
+
+namespace {
+// Set on worker threads, so submit and wait know whether they run on one and which
+thread_local JobSystem* tJobSystem{};
+thread_local int32_t tWorkerIx{-1};
+
+int64_t readNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t nextRandom(uint64_t& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+}  // namespace
+
+bool WorkStealingDeque::push(Job* job) {
+  const int64_t b = bottom.load(std::memory_order_relaxed);
+  const int64_t t = top.load(std::memory_order_acquire);
+  if (b - t >= kCapacity)
+    return false;
+  jobs[static_cast<size_t>(b & (kCapacity - 1))].store(job, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom.store(b + 1, std::memory_order_relaxed);
+  return true;
+}
+
+Job* WorkStealingDeque::pop() {
+  const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+  bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t t = top.load(std::memory_order_relaxed);
+  if (t > b) {
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  Job* job = jobs[static_cast<size_t>(b & (kCapacity - 1))].load(std::memory_order_relaxed);
+  if (t == b) {
+    // Last job, race thieves for it
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      job = nullptr;
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+  return job;
+}
+
+Job* WorkStealingDeque::steal() {
+  int64_t t = top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t b = bottom.load(std::memory_order_acquire);
+  if (t >= b)
+    return nullptr;
+  Job* job = jobs[static_cast<size_t>(t & (kCapacity - 1))].load(std::memory_order_relaxed);
+  if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    return nullptr;
+  return job;
+}
+
+JobSystem::JobSystem(uint32_t numThreads) {
+  if (numThreads == 0)
+    numThreads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+  workers.reserve(numThreads);
+  for (uint32_t ix = 0; ix < numThreads; ++ix)
+    workers.push_back(std::make_unique<JobWorker>());
+  // Deques exist before any worker may steal from them
+  for (uint32_t ix = 0; ix < numThreads; ++ix)
+    workers[ix]->thread = std::jthread([this, ix] { workerLoop(ix); });
+}
+
+JobSystem::~JobSystem() {
+  stopping.store(true);
+  wakeEpoch.fetch_add(1);
+  wakeEpoch.notify_all();
+  for (const std::unique_ptr<JobWorker>& worker : workers)
+    worker->thread.join();
+}
+
+void JobSystem::submit(std::function<void()> job, JobCounter* counter) {
+  if (counter != nullptr)
+    counter->value.fetch_add(1);
+  push(new Job{std::move(job), counter});
+}
+
+void JobSystem::submitAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter) {
+  if (counter != nullptr)
+    counter->value.fetch_add(1);
+  auto* pending = new Job{std::move(job), counter};
+  {
+    std::scoped_lock lock(dependency.mutex);
+    // The value drops to zero under the same lock, which then flushes the continuations
+    if (dependency.value.load() != 0) {
+      dependency.continuations.push_back(pending);
+      return;
+    }
+  }
+  push(pending);
+}
+
+void JobSystem::wait(JobCounter& counter) {
+  const bool onWorker = tJobSystem == this;
+  uint64_t rng = reinterpret_cast<uintptr_t>(&counter) | 1;
+  for (uint32_t value = counter.value.load(); value != 0; value = counter.value.load()) {
+    if (!onWorker) {
+      counter.value.wait(value);
+      continue;
+    }
+    // Another worker may push the awaited job right after this finds nothing, so keep looking instead of sleeping
+    if (Job* job = findJob(tWorkerIx, rng))
+      run(job, tWorkerIx);
+    else
+      std::this_thread::yield();
+  }
+  // The job that dropped the counter to zero releases the lock last
+  std::scoped_lock lock(counter.mutex);
+}
+
+void JobSystem::push(Job* job) {
+  if (tJobSystem != this || !workers[static_cast<size_t>(tWorkerIx)]->deque.push(job)) {
+    std::scoped_lock lock(queueMutex);
+    queue.push_back(job);
+  }
+  wakeEpoch.fetch_add(1);
+  if (numSleeping.load() > 0)
+    wakeEpoch.notify_one();
+}
+
+Job* JobSystem::findJob(int32_t workerIx, uint64_t& rng) {
+  if (workerIx >= 0) {
+    if (Job* job = workers[static_cast<size_t>(workerIx)]->deque.pop())
+      return job;
+  }
+  {
+    std::scoped_lock lock(queueMutex);
+    if (!queue.empty()) {
+      Job* job = queue.front();
+      queue.pop_front();
+      return job;
+    }
+  }
+  const auto numWorkers = static_cast<uint32_t>(workers.size());
+  const auto first = static_cast<uint32_t>(nextRandom(rng) % numWorkers);
+  for (uint32_t offset = 0; offset < numWorkers; ++offset) {
+    const uint32_t victim = (first + offset) % numWorkers;
+    if (static_cast<int32_t>(victim) == workerIx)
+      continue;
+    if (Job* job = workers[victim]->deque.steal()) {
+      if (workerIx >= 0)
+        workers[static_cast<size_t>(workerIx)]->numSteals.fetch_add(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void JobSystem::run(Job* job, int32_t workerIx) {
+  const int64_t beginNs = readNs();
+  job->fn();
+  JobCounter* counter = job->counter;
+  delete job;
+  if (workerIx >= 0) {
+    JobWorker& worker = *workers[static_cast<size_t>(workerIx)];
+    // Nested jobs run inside wait are counted by the outer job as well, so utilization may exceed 1 briefly
+    worker.busyNs.fetch_add(static_cast<uint64_t>(readNs() - beginNs), std::memory_order_relaxed);
+    worker.numJobs.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (counter == nullptr)
+    return;
+  // Only the last decrement takes the lock, waiters take it too before returning, so the counter outlives this
+  uint32_t value = counter->value.load();
+  while (value > 1 && !counter->value.compare_exchange_weak(value, value - 1)) {
+  }
+  if (value > 1)
+    return;
+  std::scoped_lock lock(counter->mutex);
+  if (counter->value.fetch_sub(1) != 1)
+    return;
+  for (Job* continuation : counter->continuations)
+    push(continuation);
+  counter->continuations.clear();
+  counter->value.notify_all();
+}
+
+void JobSystem::workerLoop(uint32_t workerIx) {
+  tJobSystem = this;
+  tWorkerIx = static_cast<int32_t>(workerIx);
+  setCpuProfilerThreadName(std::format("Job worker {}", workerIx));
+  uint64_t rng = 0x9E3779B97F4A7C15ull * (workerIx + 1);
+  while (true) {
+    if (Job* job = findJob(tWorkerIx, rng)) {
+      run(job, tWorkerIx);
+      continue;
+    }
+    // Jobs pushed after reading the epoch change it, so the wait below returns right away instead of missing them
+    const uint32_t epoch = wakeEpoch.load();
+    if (Job* job = findJob(tWorkerIx, rng)) {
+      run(job, tWorkerIx);
+      continue;
+    }
+    if (stopping.load())
+      return;
+    numSleeping.fetch_add(1);
+    wakeEpoch.wait(epoch);
+    numSleeping.fetch_sub(1);
+  }
+}
+
+void parallelFor(JobSystem* jobs, uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& fn) {
+  grainSize = std::max(1u, grainSize);
+  const uint32_t numChunks = (count + grainSize - 1) / grainSize;
+  if (jobs == nullptr || numChunks <= 1) {
+    if (count > 0)
+      fn(0, count);
+    return;
+  }
+
+  // Shared with helper jobs, which may start after this call returned and then find no chunks left
+  struct State {
+    std::function<void(uint32_t, uint32_t)> fn;
+    uint32_t count;
+    uint32_t grainSize;
+    uint32_t numChunks;
+    std::atomic<uint32_t> nextChunk{0};
+    std::atomic<uint32_t> doneChunks{0};
+  };
+  auto state = std::make_shared<State>(fn, count, grainSize, numChunks);
+  const auto work = [](State& st) {
+    for (uint32_t chunk = st.nextChunk.fetch_add(1); chunk < st.numChunks; chunk = st.nextChunk.fetch_add(1)) {
+      const uint32_t begin = chunk * st.grainSize;
+      st.fn(begin, std::min(begin + st.grainSize, st.count));
+      if (st.doneChunks.fetch_add(1) + 1 == st.numChunks)
+        st.doneChunks.notify_all();
+    }
+  };
+
+  const uint32_t numHelpers = std::min(jobs->numThreads(), numChunks - 1);
+  for (uint32_t ix = 0; ix < numHelpers; ++ix)
+    jobs->submit([state, work] { work(*state); });
+  work(*state);
+
+  for (uint32_t done = state->doneChunks.load(); done != numChunks; done = state->doneChunks.load())
+    state->doneChunks.wait(done);
+}
+
+void recordJobSystemStats(const JobSystem& jobs, JobSystemStats& stats) {
+  const int64_t nowNs = readNs();
+  const uint32_t numWorkers = jobs.numThreads();
+  const bool first = stats.lastBusyNs.size() != numWorkers;
+  const auto elapsedNs = static_cast<double>(std::max<int64_t>(nowNs - stats.lastNs, 1));
+  stats.lastBusyNs.resize(numWorkers);
+  stats.utilization.resize(numWorkers);
+  uint64_t totalJobs = 0;
+  uint64_t totalSteals = 0;
+  float sum = 0.f;
+  for (uint32_t workerIx = 0; workerIx < numWorkers; ++workerIx) {
+    const JobWorker& worker = jobs.getWorker(workerIx);
+    const uint64_t busyNs = worker.busyNs.load(std::memory_order_relaxed);
+    stats.utilization[workerIx] = first ? 0.f : static_cast<float>(static_cast<double>(busyNs - stats.lastBusyNs[workerIx]) / elapsedNs);
+    stats.lastBusyNs[workerIx] = busyNs;
+    sum += stats.utilization[workerIx];
+    totalJobs += worker.numJobs.load(std::memory_order_relaxed);
+    totalSteals += worker.numSteals.load(std::memory_order_relaxed);
+  }
+  stats.averageUtilization = numWorkers > 0 ? sum / static_cast<float>(numWorkers) : 0.f;
+  stats.jobsLastInterval = first ? 0 : totalJobs - stats.lastJobs;
+  stats.stealsLastInterval = first ? 0 : totalSteals - stats.lastSteals;
+  stats.lastJobs = totalJobs;
+  stats.lastSteals = totalSteals;
+  stats.lastNs = nowNs;
+  recordCpuCounter("Job worker utilization %", 100.0 * stats.averageUtilization);
+  recordCpuCounter("Jobs", static_cast<double>(stats.jobsLastInterval));
+  recordCpuCounter("Job steals", static_cast<double>(stats.stealsLastInterval));
+}
+
+void drawJobSystemWindow(const JobSystem& jobs, const JobSystemStats& stats) {
+  ImGui::Begin("Jobs");
+  ImGui::Text("%u workers, %.0f%% busy", jobs.numThreads(), 100.f * stats.averageUtilization);
+  ImGui::Text("Last frame: %llu jobs, %llu steals", static_cast<unsigned long long>(stats.jobsLastInterval), static_cast<unsigned long long>(stats.stealsLastInterval));
+  for (size_t workerIx = 0; workerIx < stats.utilization.size(); ++workerIx) {
+    const std::string label = std::format("Worker {}", workerIx);
+    ImGui::ProgressBar(std::clamp(stats.utilization[workerIx], 0.f, 1.f), ImVec2{-1.f, 0.f}, label.c_str());
+  }
+  ImGui::End();
+}
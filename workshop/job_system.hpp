@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Job;
+
+// Number of unfinished jobs submitted with it. Jobs submitted after a counter run once it drops to zero.
+struct JobCounter {
+  std::atomic<uint32_t> value{};
+  std::mutex mutex;
+  // Guarded by mutex
+  std::vector<Job*> continuations;
+};
+
+// Chase-Lev deque of a worker. The owner pushes and pops at the bottom, other workers steal from the top.
+class WorkStealingDeque {
+ public:
+  static constexpr int64_t kCapacity = 4096;
+
+  // Owner only. False when full.
+  bool push(Job* job);
+  // Owner only, newest first
+  Job* pop();
+  // Any thread, oldest first. Null when empty or another thief won.
+  Job* steal();
+
+ private:
+  alignas(64) std::atomic<int64_t> top{};
+  alignas(64) std::atomic<int64_t> bottom{};
+  std::array<std::atomic<Job*>, kCapacity> jobs{};
+};
+
+struct JobWorker {
+  WorkStealingDeque deque;
+  std::jthread thread;
+  // Time spent running jobs and jobs run, for utilization
+  std::atomic<uint64_t> busyNs{};
+  std::atomic<uint64_t> numJobs{};
+  std::atomic<uint64_t> numSteals{};
+};
+
+// Fixed set of workers with a work stealing deque each. Jobs submitted from a worker go to its own deque, jobs from
+// other threads to a shared queue. Idle workers steal from each other. Destructor finishes queued jobs and joins the
+// workers.
+class JobSystem {
+ public:
+  // 0 means one worker per hardware thread, leaving one for the main thread
+  explicit JobSystem(uint32_t numThreads = 0);
+  ~JobSystem();
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // counter, when given, is incremented now and decremented once job finished
+  void submit(std::function<void()> job, JobCounter* counter = nullptr);
+  // Runs job once dependency dropped to zero, right away if it already has
+  void submitAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter = nullptr);
+  // Until counter drops to zero. Workers run other jobs meanwhile, other threads block, so a job that waits for the
+  // main thread cannot deadlock it.
+  void wait(JobCounter& counter);
+  uint32_t numThreads() const { return static_cast<uint32_t>(workers.size()); }
+  const JobWorker& getWorker(uint32_t workerIx) const { return *workers[workerIx]; }
+
+ private:
+  void workerLoop(uint32_t workerIx);
+  void push(Job* job);
+  Job* findJob(int32_t workerIx, uint64_t& rng);
+  void run(Job* job, int32_t workerIx);
+
+  std::vector<std::unique_ptr<JobWorker>> workers;
+  std::mutex queueMutex;
+  // Jobs submitted from outside the workers, and overflow of full deques
+  std::deque<Job*> queue;
+  // Bumped whenever jobs are pushed, idle workers wait for it to change
+  std::atomic<uint32_t> wakeEpoch{};
+  std::atomic<uint32_t> numSleeping{};
+  std::atomic<bool> stopping{};
+};
+
+// Split [0, count) into chunks of grainSize and run them on the job system. The calling thread takes chunks too and
+// only waits for chunks that already started elsewhere, so it is safe to call from a job and from threads that jobs
+// wait for. Serial when jobs is null.
+void parallelFor(JobSystem* jobs, uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& fn);
+
+struct JobSystemStats {
+  std::vector<uint64_t> lastBusyNs;
+  uint64_t lastJobs{};
+  uint64_t lastSteals{};
+  int64_t lastNs{};
+  // Busy fraction per worker over the last interval
+  std::vector<float> utilization;
+  float averageUtilization{};
+  uint64_t jobsLastInterval{};
+  uint64_t stealsLastInterval{};
+};
+// Worker utilization, jobs and steals since the previous call, also recorded as CPU profiler counters. Call once per
+// frame.
+void recordJobSystemStats(const JobSystem& jobs, JobSystemStats& stats);
+void drawJobSystemWindow(const JobSystem& jobs, const JobSystemStats& stats);
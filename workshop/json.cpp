@@ -0,0 +1,33 @@
+#include "json.hpp"
+
+#include <format>
+
+std::string escapeJson(std::string_view text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (const char c : text) {
+    switch (c) {
+      case '"':
+        escaped += R"(\")";
+        break;
+      case '\\':
+        escaped += R"(\\)";
+        break;
+      case '\n':
+        escaped += R"(\n)";
+        break;
+      case '\r':
+        escaped += R"(\r)";
+        break;
+      case '\t':
+        escaped += R"(\t)";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+          escaped += std::format(R"(\u{:04x})", static_cast<unsigned char>(c));
+        else
+          escaped += c;
+    }
+  }
+  return escaped;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Contents of a JSON string literal, without the quotes. Quotes, backslashes and control characters are escaped, other
+// bytes are copied as they are.
+std::string escapeJson(std::string_view text);
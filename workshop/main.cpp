@@ -10,80 +10,39 @@
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
-#include <OpenImageIO/imageio.h>
 
+#include "asset_pack.hpp"
+#include "benchmark.hpp"
+#include "cpu_memory.hpp"
+#include "cpu_profiler.hpp"
+#include "draw_packets.hpp"
+#include "dynamic_resolution.hpp"
+#include "frame_pipeline.hpp"
+#include "gpu_memory.hpp"
+#include "gpu_profiler.hpp"
+#include "job_system.hpp"
+#include "material.hpp"
+#include "mesh.hpp"
+#include "pipeline_statistics.hpp"
+#include "post_process.hpp"
+#include "render_graph.hpp"
+#include "residency.hpp"
+#include "scene_graph.hpp"
+#include "shader.hpp"
+#include "startup_timeline.hpp"
+#include "texture_streamer.hpp"
+#include "transforms.hpp"
+#include "virtual_texture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
 #include <filesystem>
 #include <print>
-#include <ranges>
+#include <string>
 
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mode);
-// Load shader programs compiled to SPIR-V binary format from given files into a new shader program
-// Return 0 on error
-GLuint loadShaderSpirV(const std::filesystem::path& vertPath, const std::filesystem::path& fragPath);
-
-struct Vertex {
-  glm::vec3 position;
-  glm::vec3 normal;
-  glm::vec2 texCoord1;
-};
-
-struct Mesh {
-  std::vector<Vertex> vertices;
-  std::vector<uint32_t> indices;
-};
-
-struct MeshGpu {
-  GLuint vertexArray;
-  GLuint vertexBuffer;
-  GLuint indexBuffer;
-  size_t numVertices;
-  size_t numIndices;
-};
-
-GLuint createVertexBuffer(uint32_t numVertices, GLuint vao) {
-  GLuint vbo{};
-  glCreateBuffers(1, &vbo);
-  glNamedBufferStorage(vbo, static_cast<GLsizeiptr>(sizeof(Vertex) * numVertices), nullptr, GL_DYNAMIC_STORAGE_BIT);
-  glVertexArrayVertexBuffer(vao, 0, vbo, 0, sizeof(Vertex));
-  return vbo;
-};
-
-GLuint createIndexBuffer(uint32_t numIndices, GLuint vao) {
-  GLuint ibo{};
-  glCreateBuffers(1, &ibo);
-  glNamedBufferStorage(ibo, sizeof(uint32_t) * numIndices, nullptr, GL_DYNAMIC_STORAGE_BIT);
-  glVertexArrayElementBuffer(vao, ibo);
-  return ibo;
-}
-
-MeshGpu createMeshGpu(const Mesh& mesh) {
-  MeshGpu m{};
-  glCreateVertexArrays(1, &m.vertexArray);
-  glBindVertexArray(m.vertexArray);
-
-  // See Vertex. {position, normal, texCoord1}
-  static const std::vector<int32_t> sizes = {3, 3, 2};
-  uint32_t offset = 0;
-  for (uint32_t ix = 0; ix < sizes.size(); ++ix) {
-    glEnableVertexArrayAttrib(m.vertexArray, ix);
-    glVertexArrayAttribFormat(m.vertexArray, ix, sizes[ix], GL_FLOAT, GL_FALSE, offset);
-    glVertexArrayAttribBinding(m.vertexArray, ix, 0);
-    offset += sizes[ix] * sizeof(float);
-  }
-
-  m.numVertices = mesh.vertices.size();
-  m.vertexBuffer = createVertexBuffer(static_cast<uint32_t>(m.numVertices), m.vertexArray);
-
-  m.numIndices = mesh.indices.size();
-  m.indexBuffer = createIndexBuffer(static_cast<uint32_t>(m.numIndices), m.vertexArray);
-
-  glNamedBufferSubData(m.vertexBuffer, 0, sizeof(Vertex) * m.numVertices, mesh.vertices.data());
-  glNamedBufferSubData(m.indexBuffer, 0, sizeof(uint32_t) * m.numIndices, mesh.indices.data());
-
-  return m;
-}
-
-void loadMeshesFromAiNode(const aiNode *node, const aiScene *scene, std::vector<Mesh>& outMeshes);
 
 template<typename T>
 struct UniformBuffer {
@@ -98,13 +57,13 @@ UniformBuffer<T> createPersistentUniformBuffer(uint32_t binding, uint32_t count
   GLuint ubo;
   glCreateBuffers(1, &ubo);
   constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
-  glNamedBufferStorage(ubo, sizeBytes, nullptr, flags);
+  trackedNamedBufferStorage(GpuMemoryCategory::UniformBuffers, ubo, static_cast<GLsizeiptr>(sizeBytes), nullptr, flags);
   glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo);
 
   void* mappedPtr = static_cast<T*>(glMapNamedBufferRange(ubo, 0, sizeBytes, flags));
   if (mappedPtr == nullptr) {
     std::println("Failed to map uniform buffer {} of size {} persistently!", ubo, sizeBytes);
-    glDeleteBuffers(1, &ubo);
+    trackedDeleteBuffers(1, &ubo);
     return UniformBuffer<T>{};
   }
 
@@ -113,36 +72,97 @@ UniformBuffer<T> createPersistentUniformBuffer(uint32_t binding, uint32_t count
   return ub;
 }
 
-struct PerFrameData {
+enum class Shading : int {
+  Normals,
+  Materials,
+  VirtualTexture,
+};
+
+// Aligned so that every frame slot starts at a valid uniform buffer offset
+struct alignas(256) PerFrameData {
   glm::mat4 viewFromWorld{};
   glm::mat4 projectionFromView{};
   float fishEyeStrength{0.25f};
 };
 
+// Edited by the UI on the GL thread and copied into each simulation job
+struct SimulationSettings {
+  float time{};
+  float fovDegrees{45.f};
+  float fishEyeStrength{0.25f};
+  bool spinCells{};
+};
+
 struct PerObjectData {
   glm::mat4 worldFromModel;
 };
 
-int main() {
-  std::println("Hi!");
-
-  if (!glfwInit()) {
-    std::println("Failed to initialize GLFW");
-    return -1;
+// Surfaceless EGL needs no display server, so benchmarks also run on headless machines, e.g. with Mesa's llvmpipe.
+// Falls back to a hidden window where GLFW predates the null platform or EGL is unavailable.
+GLFWwindow* createHeadlessWindow(int width, int height, std::string& contextName) {
+#ifdef GLFW_PLATFORM_NULL
+  glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+  if (glfwInit()) {
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+    if (GLFWwindow* window = glfwCreateWindow(width, height, "Workshop", nullptr, nullptr)) {
+      contextName = "surfaceless EGL";
+      return window;
+    }
+    glfwTerminate();
+  }
+  glfwInitHint(GLFW_PLATFORM, GLFW_ANY_PLATFORM);
+#endif
+  if (!glfwInit())
+    return nullptr;
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  GLFWwindow* window = glfwCreateWindow(width, height, "Workshop", nullptr, nullptr);
+  if (!window) {
+    glfwTerminate();
+    return nullptr;
   }
+  contextName = "hidden window";
+  return window;
+}
 
-  glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
-  glfwWindowHint(GLFW_SAMPLES, 8);
+int main(int argc, char** argv) {
+  StartupTimeline startupTimeline;
+  initStartupTimeline(startupTimeline);
+  std::println("Hi!");
+  setCpuProfilerThreadName("Main");
+
+  BenchmarkOptions benchmarkOptions;
+  if (!parseBenchmarkOptions(argc, argv, benchmarkOptions))
+    return 1;
 
   constexpr GLuint kWidth = 1280, kHeight = 768;
-  GLFWwindow* window =
-      glfwCreateWindow(kWidth, kHeight, "LearnOpenGL", nullptr, nullptr);
-  if (!window) {
-    std::println("Failed to create GLFW window");
-    glfwTerminate();
-    return -1;
+  std::string contextName = "window";
+  GLFWwindow* window{};
+  if (benchmarkOptions.enabled) {
+    beginStartupPhase(startupTimeline, "Headless context");
+    window = createHeadlessWindow(kWidth, kHeight, contextName);
+    if (!window) {
+      std::println("Failed to create a headless OpenGL context");
+      return -1;
+    }
+  } else {
+    beginStartupPhase(startupTimeline, "GLFW init");
+    if (!glfwInit()) {
+      std::println("Failed to initialize GLFW");
+      return -1;
+    }
+
+    glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
+
+    beginStartupPhase(startupTimeline, "Window creation");
+    window = glfwCreateWindow(kWidth, kHeight, "LearnOpenGL", nullptr, nullptr);
+    if (!window) {
+      std::println("Failed to create GLFW window");
+      glfwTerminate();
+      return -1;
+    }
   }
 
+  beginStartupPhase(startupTimeline, "OpenGL loader");
   glfwMakeContextCurrent(window);
   glfwSetKeyCallback(window, keyCallback);
 
@@ -154,12 +174,18 @@ int main() {
   std::println("Loaded OpenGL version {}.{}", GLAD_VERSION_MAJOR(version),
                GLAD_VERSION_MINOR(version));
 
+  beginStartupPhase(startupTimeline, "ImGui init");
   IMGUI_CHECKVERSION();
+  ImGui::SetAllocatorFunctions([](size_t size, void*) { return allocateTagged(size, MemoryTag::Ui); }, [](void* ptr, void*) { freeTagged(ptr); });
   ImGui::CreateContext();
   ImGuiIO& io = ImGui::GetIO();
   io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
   io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-  io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+  // Platform windows would need a display, and a saved layout would make benchmark runs differ
+  if (benchmarkOptions.enabled)
+    io.IniFilename = nullptr;
+  else
+    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
   ImGui::StyleColorsDark();
   // When viewports are enabled, we tweak WindowRounding/WindowBg so platform windows can look identical to regular ones.
   ImGuiStyle& style = ImGui::GetStyle();
@@ -174,7 +200,27 @@ int main() {
   glm::vec3 origin{};
   std::println("Origin: ({}, {}, {})", origin.x, origin.y, origin.z);
 
-  const std::filesystem::path modelFile{"C:/Users/veliu/repos/graphics-workshop/assets/models/teapot/teapot.obj"};
+  // Cooked on first run and whenever the source image changes. The cook only needs the image, so it runs as a job
+  // alongside the model import and mesh processing.
+  const std::filesystem::path texFile = std::filesystem::path{ASSETS_DIR} / "textures/openimageio-acronym-gradient.png";
+  const std::filesystem::path vtFile = std::filesystem::path{ASSETS_DIR} / "cache/virtual_textures" / texFile.filename().replace_extension(".gwvt");
+  JobCounter vtCooked;
+  // Shared by asset import, texture decoding and per-frame work. Most of what its jobs write is declared after it and
+  // goes away first, so every exit waits for the jobs in flight: the cook through vtCooked, decodes and tile loads in
+  // destroyTextureStreamer and destroyVirtualTexture, simulations in destroyFramePipeline.
+  JobSystem jobs;
+  JobSystemStats jobStats;
+  std::error_code vtError;
+  if (!std::filesystem::exists(vtFile) || std::filesystem::last_write_time(vtFile, vtError) < std::filesystem::last_write_time(texFile, vtError)) {
+    jobs.submit([&] {
+      MemoryTagScope memoryTag(MemoryTag::VirtualTexture);
+      cookVirtualTexture(texFile, vtFile, &jobs);
+    }, &vtCooked);
+  }
+
+  beginStartupPhase(startupTimeline, "Model import");
+  setMemoryTag(MemoryTag::ModelImport);
+  const std::filesystem::path modelFile = std::filesystem::path{ASSETS_DIR} / "models/teapot/teapot.obj";
   std::println("Loading model file: {}...", modelFile.string());
   Assimp::Importer importer;
   const aiScene* scene = importer.ReadFile(modelFile.string(),
@@ -185,237 +231,478 @@ int main() {
   aiProcess_SortByPType);
   if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
     std::println("Error loading model file: {}", importer.GetErrorString());
+    jobs.wait(vtCooked);
     return 1;
   }
   for (uint32_t meshIx = 0; meshIx < scene->mNumMeshes; ++meshIx) {
     const aiMesh* mesh = scene->mMeshes[meshIx];
-    std::println("Mesh {}: {} vertices, {} faces.", meshIx, mesh->mNumVertices, mesh->mNumFaces);
+    std::println("Mesh {} '{}': {} vertices, {} faces. has position? {}, has normals? {}, has TexCoord0? {}, uv channels {}. Material '{}'", meshIx, mesh->mName.C_Str(), mesh->mNumVertices, mesh->mNumFaces, mesh->HasPositions(), mesh->HasNormals(), mesh->HasTextureCoords(0), mesh->GetNumUVChannels(), scene->mMaterials[mesh->mMaterialIndex]->GetName().C_Str());
   }
+  beginStartupPhase(startupTimeline, "Mesh processing");
+  setMemoryTag(MemoryTag::Meshes);
   std::vector<Mesh> meshes;
-  loadMeshesFromAiNode(scene->mRootNode, scene, meshes);
+  loadMeshesFromAiNode(scene->mRootNode, scene, meshes, &jobs);
+  // Each grid cell holds a copy of the model's node hierarchy
+  constexpr uint32_t cellCnt = 9;
+  SceneGraph sceneGraph;
+  std::vector<SceneMeshInstance> meshInstances;
+  for (const glm::mat4& cellTransform : makeGridTransforms(cellCnt, 2.f)) {
+    const uint32_t cellNode = addSceneNode(sceneGraph, kNoParent, "Cell", glm::vec3{cellTransform[3]});
+    addSceneNodesFromAiNode(sceneGraph, static_cast<int32_t>(cellNode), scene->mRootNode, 0, meshInstances);
+  }
+  beginStartupPhase(startupTimeline, "Mesh upload");
   std::vector<MeshGpu> meshGpus;
   for (const auto& mesh : meshes)
     meshGpus.push_back(createMeshGpu(mesh));
 
-  std::println("loading a texture");
-  const std::filesystem::path texFile{"C:/Users/veliu/repos/graphics-workshop/assets/textures/openimageio-acronym-gradient.png"};
-  auto inp = OIIO::ImageInput::open(texFile.string());
-  if(!inp) {
-    std::println("Error loading texture file: {}", OIIO::geterror());
+  beginStartupPhase(startupTimeline, "Texture streamer init");
+  setMemoryTag(MemoryTag::Textures);
+  TextureStreamer textureStreamer;
+  if (!initTextureStreamer(textureStreamer, 64 * 1024 * 1024, jobs)) {
+    std::println("Error creating texture streamer.");
+    jobs.wait(vtCooked);
     return 1;
   }
-  const OIIO::ImageSpec &spec = inp->spec();
-  std::println("Image: width {}, height {}, depth {}, channels {}", spec.width, spec.height, spec.depth, spec.nchannels);
+  textureStreamer.cacheDir = std::filesystem::path{ASSETS_DIR} / "cache/textures";
+
+  ResidencyManager residency;
+  residency.streamer = &textureStreamer;
+  std::vector<uint32_t> meshHandles;
+  for (size_t meshIx = 0; meshIx < meshes.size(); ++meshIx)
+    meshHandles.push_back(registerMesh(residency, meshes[meshIx], meshGpus[meshIx]));
 
-  const std::filesystem::path vertFile{"C:/Users/veliu/repos/graphics-workshop/assets/shaders/solid_color_vert.spv"};
-  const std::filesystem::path fragFile{"C:/Users/veliu/repos/graphics-workshop/assets/shaders/solid_color_frag.spv"};
-  GLuint program = loadShaderSpirV(vertFile, fragFile);
-  if (program == 0) {
+  beginStartupPhase(startupTimeline, "Material table");
+  MaterialTable materialTable;
+  loadMaterialTable(materialTable, *scene, modelFile.parent_path(), &jobs);
+  std::println("loading a texture");
+  const StreamedTexture& gradientTexture = requestTexture(textureStreamer, texFile);
+  // Meshes and materials keep their own copies, the aiScene would otherwise stay alive until exit
+  importer.FreeScene();
+  scene = nullptr;
+
+  beginStartupPhase(startupTimeline, "Virtual texture");
+  setMemoryTag(MemoryTag::VirtualTexture);
+  jobs.wait(vtCooked);
+  VirtualTexture virtualTexture;
+  const bool hasVirtualTexture = initVirtualTexture(virtualTexture, vtFile, jobs);
+
+  // Built by the ShaderPack target after compile_shaders_to_spirv.bat
+  beginStartupPhase(startupTimeline, "Shader load");
+  setMemoryTag(MemoryTag::Shaders);
+  const std::filesystem::path shaderPackFile = std::filesystem::path{ASSETS_DIR} / "shaders/shaders.pack";
+  AssetPack shaderPack;
+  if (!openAssetPack(shaderPackFile, shaderPack)) {
+    std::println("Error loading shader pack.");
+    destroyTextureStreamer(textureStreamer);
+    return 1;
+  }
+  ProgramPipelineCache pipelineCache;
+  const GLuint vertProgram = getOrCreateStageProgram(pipelineCache, GL_VERTEX_SHADER, shaderPack, "solid_color_vert.spv");
+  const GLuint fragProgram = getOrCreateStageProgram(pipelineCache, GL_FRAGMENT_SHADER, shaderPack, "solid_color_frag.spv");
+  if (vertProgram == 0 || fragProgram == 0) {
     std::println("Error loading shaders.");
+    destroyTextureStreamer(textureStreamer);
+    return 1;
+  }
+  const GLuint pipeline = getOrCreateProgramPipeline(pipelineCache, {.vertex = vertProgram, .fragment = fragProgram});
+  // Depth only. The same vertex program as the color pass, so GL_EQUAL sees bit identical depths.
+  const GLuint depthPipeline = getOrCreateProgramPipeline(pipelineCache, {.vertex = vertProgram});
+  // Bindless variant only loads where the driver accepts GL_ARB_bindless_texture in SPIR-V
+  GLuint materialFragProgram = materialTable.bindless ? getOrCreateStageProgram(pipelineCache, GL_FRAGMENT_SHADER, shaderPack, "material_bindless_frag.spv") : 0;
+  if (materialFragProgram == 0) {
+    // material.frag only reaches the bound texture arrays
+    if (materialTable.bindless)
+      capMaterialTableToBoundArrays(materialTable);
+    materialFragProgram = getOrCreateStageProgram(pipelineCache, GL_FRAGMENT_SHADER, shaderPack, "material_frag.spv");
+  }
+  const GLuint materialPipeline = materialFragProgram != 0 ? getOrCreateProgramPipeline(pipelineCache, {.vertex = vertProgram, .fragment = materialFragProgram}) : 0;
+  const GLuint vtFragProgram = hasVirtualTexture ? getOrCreateStageProgram(pipelineCache, GL_FRAGMENT_SHADER, shaderPack, "virtual_texture_frag.spv") : 0;
+  const GLuint vtPipeline = vtFragProgram != 0 ? getOrCreateProgramPipeline(pipelineCache, {.vertex = vertProgram, .fragment = vtFragProgram}) : 0;
+  PostProcessPipelines postProcessPipelines;
+  if (!initPostProcessPipelines(postProcessPipelines, pipelineCache, shaderPack)) {
+    std::println("Error loading shaders.");
+    destroyTextureStreamer(textureStreamer);
     return 1;
   }
 
-  constexpr uint32_t cellCnt = 9;
-  constexpr uint32_t objectCnt = cellCnt * cellCnt;
-
-  PerFrameData& frameData = *createPersistentUniformBuffer<PerFrameData>(0).data;
-  UniformBuffer<PerObjectData> perObjectData = createPersistentUniformBuffer<PerObjectData>(1, objectCnt);
-
-  std::vector<glm::mat4> transforms;
-  for (uint32_t i = 0; i < cellCnt; ++i) {
-    for (uint32_t j = 0; j < cellCnt; ++j) {
-      const float x = static_cast<float>(i) - static_cast<float>(cellCnt) / 2.f;
-      const float y = static_cast<float>(j) - static_cast<float>(cellCnt) / 2.f;
-      const glm::vec3 pos = {x, 0.f, y};
-      const glm::mat4 transform = glm::translate(glm::mat4(1), 2.f * pos);
-      transforms.push_back(transform);
-      const uint32_t objectIndex = i * cellCnt + j;
-      perObjectData.data[objectIndex].worldFromModel = transform;
+  beginStartupPhase(startupTimeline, "Uniform buffers");
+  setMemoryTag(MemoryTag::Untagged);
+  // Every frame slot of the pipeline has its own copy, written by the simulation of the frame using the slot
+  UniformBuffer<PerFrameData> perFrameData = createPersistentUniformBuffer<PerFrameData>(0, kFramesInFlight);
+  // One object per mesh instance and frame slot, written whenever the world matrix of its node changes
+  const auto numInstances = static_cast<uint32_t>(meshInstances.size());
+  UniformBuffer<PerObjectData> perObjectData = createPersistentUniformBuffer<PerObjectData>(1, numInstances * kFramesInFlight);
+  // Frame slots an instance's changed matrix still has to be written to
+  std::vector<uint8_t> pendingObjectWrites(numInstances, kFramesInFlight);
+  // Read by the simulation while the GL thread may restore evicted buffers of the MeshGpus, so they are copied here
+  std::vector<DrawPacket> meshDrawPackets;
+  for (size_t meshIx = 0; meshIx < meshGpus.size(); ++meshIx)
+    meshDrawPackets.push_back({.vertexArray = meshGpus[meshIx].vertexArray, .positionVertexArray = meshGpus[meshIx].positionVertexArray, .numIndices = static_cast<uint32_t>(meshGpus[meshIx].numIndices), .materialId = meshGpus[meshIx].materialId, .objectIx = 0, .meshHandle = meshHandles[meshIx]});
+  // Large enough to amortize a job, small enough to spread a big scene over every worker
+  constexpr uint32_t kInstancesPerPacketChunk = 256;
+  std::array<DrawPacketList, kFramesInFlight> scenePackets;
+  SimulationSettings simulationSettings;
+  FramePipeline framePipeline;
+  framePipeline.jobs = &jobs;
+  // Camera, scene graph and draw recording of a frame. Runs as a job while the GL thread submits the previous frame,
+  // so it only touches the frame's own slot and what nothing else writes meanwhile.
+  const auto simulateFrame = [&](const SimulationSettings& settings, uint32_t slot) {
+    PerFrameData& frameData = perFrameData.data[slot];
+    const glm::vec3 eye = 6.f * glm::vec3{glm::cos(settings.time), 0.75f, glm::sin(settings.time)};
+    frameData.viewFromWorld = glm::lookAt(eye, glm::vec3{0, 0.5f, 0}, glm::vec3{0, 1, 0});
+    frameData.projectionFromView = glm::perspective(glm::radians(settings.fovDegrees), static_cast<float>(kWidth) / kHeight, 0.1f, 100.0f);
+    frameData.fishEyeStrength = settings.fishEyeStrength;
+    // Moves the grid cells so the scene graph has dirty nodes to propagate
+    if (settings.spinCells) {
+      for (const uint32_t cellNode : sceneGraph.roots)
+        setLocalRotation(sceneGraph, cellNode, glm::angleAxis(settings.time + 0.1f * static_cast<float>(cellNode), glm::vec3{0, 1, 0}));
+    }
+    updateWorldMatrices(sceneGraph, &jobs);
+    recordDrawPackets(scenePackets[slot], &jobs, numInstances, kInstancesPerPacketChunk, [&, slot](uint32_t begin, uint32_t end, std::vector<DrawPacket>& out) {
+      for (uint32_t ix = begin; ix < end; ++ix) {
+        const SceneMeshInstance& instance = meshInstances[ix];
+        if (sceneGraph.worldChanged[instance.node] != 0)
+          pendingObjectWrites[ix] = kFramesInFlight;
+        const uint32_t objectIx = slot * numInstances + ix;
+        if (pendingObjectWrites[ix] != 0) {
+          perObjectData.data[objectIx].worldFromModel = sceneGraph.worldMatrices[instance.node];
+          --pendingObjectWrites[ix];
+        }
+        DrawPacket& packet = out.emplace_back(meshDrawPackets[instance.mesh]);
+        packet.objectIx = objectIx;
+      }
+    });
+  };
+  uint64_t frame = 0;
+
+  beginStartupPhase(startupTimeline, "Frame setup");
+  GpuProfiler gpuProfiler;
+  PipelineStatistics pipelineStatistics;
+  initPipelineStatistics(pipelineStatistics);
+  RenderGraphPool renderGraphPool;
+
+  // A surfaceless context has no default framebuffer, benchmarks present into one like the window's. The scene has its
+  // own render targets, so it is single sampled and has no depth.
+  GLuint benchmarkFramebuffer{};
+  GLuint benchmarkRenderbuffer{};
+  if (benchmarkOptions.enabled) {
+    glCreateRenderbuffers(1, &benchmarkRenderbuffer);
+    trackedNamedRenderbufferStorageMultisample(GpuMemoryCategory::RenderTargets, benchmarkRenderbuffer, 0, GL_RGBA8, kWidth, kHeight);
+    glCreateFramebuffers(1, &benchmarkFramebuffer);
+    glNamedFramebufferRenderbuffer(benchmarkFramebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, benchmarkRenderbuffer);
+    if (glCheckNamedFramebufferStatus(benchmarkFramebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+      std::println("Error creating the benchmark framebuffer.");
+      destroyTextureStreamer(textureStreamer);
+      return 1;
     }
+    glBindFramebuffer(GL_FRAMEBUFFER, benchmarkFramebuffer);
   }
 
+  // Sample counts above what the driver supports fall back to the largest it does
+  const uint32_t maxMsaaSamples = clampMsaaSamples(8);
+  benchmarkOptions.msaaSamples = std::min(benchmarkOptions.msaaSamples, maxMsaaSamples);
+  // Benchmarks keep the output resolution unless given a target frame time
+  DynamicResolution dynamicResolution;
+  dynamicResolution.enabled = !benchmarkOptions.enabled || benchmarkOptions.targetFrameMs > 0.f;
+  if (benchmarkOptions.targetFrameMs > 0.f)
+    dynamicResolution.targetFrameMs = benchmarkOptions.targetFrameMs;
+
+  BenchmarkReport benchmarkReport;
+  benchmarkReport.options = benchmarkOptions;
+  benchmarkReport.width = kWidth;
+  benchmarkReport.height = kHeight;
+  benchmarkReport.context = contextName;
+  benchmarkReport.glVendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+  benchmarkReport.glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+  benchmarkReport.glVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+  // Nothing is presented, so fences cap the frames in flight the way a swap chain would
+  std::array<GLsync, 2> benchmarkFences{};
+  uint32_t benchmarkFrame = 0;
+  bool benchmarkMeasuring = false;
+  uint64_t droppedGpuFramesBeforeMeasuring = 0;
+  std::chrono::steady_clock::time_point benchmarkStart;
+  // Upper bound for waiting on texture streaming after the warmup
+  constexpr uint32_t kMaxBenchmarkSettleFrames = 600;
+
+  // Ends with the first swap, or with the first submitted frame when benchmarking
+  beginStartupPhase(startupTimeline, "First frame");
   glViewport(0, 0, kWidth, kHeight);
   glEnable(GL_CULL_FACE);
   glEnable(GL_DEPTH_TEST);
   while (!glfwWindowShouldClose(window)) {
-    glfwPollEvents();
+    if (benchmarkOptions.enabled) {
+      GLsync& fence = benchmarkFences[benchmarkFrame % benchmarkFences.size()];
+      if (fence != nullptr) {
+        waitForFence(fence);
+        glDeleteSync(fence);
+        fence = nullptr;
+      }
+      // Measure once the streamed textures are in, so every run draws the same thing
+      const bool streamingSettled = std::ranges::none_of(textureStreamer.textures, [](const auto& tex) { return tex->state == TextureState::Decoding || tex->state == TextureState::Uploading; });
+      if (!benchmarkMeasuring && benchmarkFrame >= benchmarkOptions.warmupFrames && (streamingSettled || benchmarkFrame >= benchmarkOptions.warmupFrames + kMaxBenchmarkSettleFrames)) {
+        flushGpuProfiler(gpuProfiler);
+        gpuProfiler.keepFrameTimes = true;
+        droppedGpuFramesBeforeMeasuring = gpuProfiler.droppedFrames;
+        flushPipelineStatistics(pipelineStatistics);
+        resetPipelineStatistics(pipelineStatistics);
+        benchmarkMeasuring = true;
+        benchmarkStart = std::chrono::steady_clock::now();
+        std::println("Measuring {} frames after {} warmup frames", benchmarkOptions.measuredFrames, benchmarkFrame);
+      }
+    }
+    const auto cpuFrameStart = std::chrono::steady_clock::now();
+    markCpuFrame();
+    recordJobSystemStats(jobs, jobStats);
+    {
+      CPU_PROFILE_ZONE("Poll events");
+      glfwPollEvents();
+    }
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
-
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    const auto t = static_cast<float>(glfwGetTime());
-    const glm::vec3 eye = 6.f * glm::vec3{glm::cos(t), 0.75f, glm::sin(t)};
-    frameData.viewFromWorld = glm::lookAt(eye, glm::vec3{0, 0.5f, 0}, glm::vec3{0, 1, 0});
-    static float fovDegrees = 45.0f;
-    frameData.projectionFromView = glm::perspective(glm::radians(fovDegrees), static_cast<float>(kWidth) / kHeight, 0.1f, 100.0f);
+    beginGpuProfilerFrame(gpuProfiler);
+    beginPipelineStatisticsFrame(pipelineStatistics);
+    // From the latest resolved GPU frame, so the scene render targets below can be sized for this one
+    updateDynamicResolution(dynamicResolution, gpuProfiler, {"Depth prepass", "Scene", "MSAA resolve", "FXAA", "SMAA edges", "SMAA weights", "SMAA blend"});
+    const uint32_t sceneWidth = getScaledSize(dynamicResolution, kWidth);
+    const uint32_t sceneHeight = getScaledSize(dynamicResolution, kHeight);
+    recordCpuCounter("Resolution scale", dynamicResolution.scale);
+
+    // Changes made here reach the screen one frame later, they go into the simulation of the next frame
     ImGui::Begin("Props");
-    ImGui::SliderFloat("Fish eye strength", &frameData.fishEyeStrength, 0.0f, 2.0f);
-    ImGui::SliderFloat("FOV", &fovDegrees, 0.0f, 180.0f);
+    ImGui::SliderFloat("Fish eye strength", &simulationSettings.fishEyeStrength, 0.0f, 2.0f);
+    ImGui::SliderFloat("FOV", &simulationSettings.fovDegrees, 0.0f, 180.0f);
+    // Modes whose shaders are missing from the pack fall back to normals
+    static int shading = static_cast<int>(Shading::Materials);
+    ImGui::Combo("Shading", &shading, "Normals\0Materials\0Virtual texture\0");
+    ImGui::Text("%zu materials, %zu texture arrays%s", materialTable.materials.size(), materialTable.textureArrays.size(), materialTable.bindless ? ", bindless" : "");
+    ImGui::Checkbox("Spin cells", &simulationSettings.spinCells);
+    // Compare the Depth prepass and Scene zones in the GPU profiler with and without it
+    static bool depthPrepass = benchmarkOptions.depthPrepass;
+    ImGui::Checkbox("Depth prepass", &depthPrepass);
+    // Fill rate against quality. Post anti-aliasing runs on the resolved image, with or without MSAA.
+    static int msaaSamplesIx = std::countr_zero(benchmarkOptions.msaaSamples);
+    ImGui::Combo("MSAA", &msaaSamplesIx, "Off\0" "2x\0" "4x\0" "8x\0");
+    const uint32_t msaaSamples = std::min(1u << msaaSamplesIx, maxMsaaSamples);
+    static int postAntiAliasing = static_cast<int>(benchmarkOptions.postAntiAliasing);
+    ImGui::Combo("Post anti-aliasing", &postAntiAliasing, "Off\0FXAA\0SMAA\0");
+    if (!isPostAntiAliasingAvailable(postProcessPipelines, static_cast<PostAntiAliasing>(postAntiAliasing)))
+      ImGui::TextUnformatted("Shaders missing from the pack");
+    // Scene render targets follow the GPU frame time, ImGui is drawn at the output resolution after the upscale
+    if (ImGui::Checkbox("Dynamic resolution", &dynamicResolution.enabled) && !dynamicResolution.enabled)
+      dynamicResolution.scale = dynamicResolution.maxScale;
+    ImGui::SliderFloat("Target GPU ms", &dynamicResolution.targetFrameMs, 4.0f, 50.0f);
+    ImGui::SliderFloat("Min scale", &dynamicResolution.minScale, 0.25f, 1.0f);
+    static int upscaler = static_cast<int>(benchmarkOptions.upscaler);
+    ImGui::Combo("Upscaler", &upscaler, "Bilinear\0FSR 1\0");
+    if (!isUpscalerAvailable(postProcessPipelines, static_cast<Upscaler>(upscaler)))
+      ImGui::TextUnformatted("Shaders missing from the pack");
+    ImGui::Text("Scene at %ux%u, GPU frame %.2f ms, %u changes", sceneWidth, sceneHeight, dynamicResolution.frameMs, dynamicResolution.numChanges);
+    ImGui::Text("%zu scene nodes, %u mesh instances", sceneGraph.parents.size(), numInstances);
+    ImGui::Text("Waited %.2f ms for the simulation, %.2f ms for the GPU", framePipeline.simulationWaitMs, framePipeline.fenceWaitMs);
     ImGui::End();
 
-    glUseProgram(program);
-    for (auto const& [ix, transform] : std::views::enumerate(transforms)) {
-      glBindBufferRange(GL_UNIFORM_BUFFER, 1, perObjectData.ubo, sizeof(PerObjectData) * ix, sizeof(PerObjectData));
-      for (const MeshGpu& mg : meshGpus) {
-        glBindVertexArray(mg.vertexArray);
-        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mg.numIndices), GL_UNSIGNED_INT, nullptr);
-        glBindVertexArray(0);
-      }
+    // Frame N was simulated while frame N-1 was submitted, frame N+1 is simulated while this submits frame N
+    const auto beginSimulation = [&] {
+      const uint64_t simulatedFrame = framePipeline.nextSimulatedFrame;
+      simulationSettings.time = benchmarkOptions.enabled ? static_cast<float>(simulatedFrame) * benchmarkOptions.timeStep : static_cast<float>(glfwGetTime());
+      beginFrameSimulation(framePipeline, [&simulateFrame, settings = simulationSettings](uint64_t, uint32_t slot) { simulateFrame(settings, slot); });
+    };
+    if (frame == 0)
+      beginSimulation();
+    const uint32_t frameSlot = waitForFrameSimulation(framePipeline, frame);
+    beginSimulation();
+
+    static int uploadBudgetKiB = 4096;
+    ImGui::Begin("Textures");
+    ImGui::SliderInt("Upload budget per frame (KiB)", &uploadBudgetKiB, 64, 65536);
+    ImGui::Text("Staging: %zu / %zu KiB in use, uploaded %zu KiB last frame", textureStreamer.stagingUsedLastFrame / 1024, textureStreamer.stagingSize / 1024, textureStreamer.uploadedBytesLastFrame / 1024);
+    if (gradientTexture.state == TextureState::Ready) {
+      useTexture(residency, gradientTexture);
+      ImGui::Text("%s: %ux%u, %u channels, %zu mip levels, %s", gradientTexture.path.filename().string().c_str(), gradientTexture.width, gradientTexture.height, gradientTexture.numChannels, gradientTexture.levels.size(), gradientTexture.blockBytes != 0 ? "block compressed" : "uncompressed");
+      // GL textures have their origin at the bottom-left
+      ImGui::Image((ImTextureID)(intptr_t)gradientTexture.texture, ImVec2{256.f * gradientTexture.width / gradientTexture.height, 256.f}, ImVec2{0, 1}, ImVec2{1, 0});
     }
-    glUseProgram(0);
+    static int maxPageUploadsPerFrame = 8;
+    if (vtPipeline != 0) {
+      ImGui::SeparatorText("Virtual texture");
+      ImGui::SliderInt("Page uploads per frame", &maxPageUploadsPerFrame, 1, 64);
+      const size_t numSlots = virtualTexture.slotPages.size();
+      ImGui::Text("%ux%u, %zu levels, %u pages", virtualTexture.width, virtualTexture.height, virtualTexture.levels.size(), virtualTexture.numPages);
+      ImGui::Text("Resident: %u / %zu slots (%zu KiB physical)", virtualTexture.residentPages, numSlots, numSlots * kVtTileBytes / 1024);
+      ImGui::Text("Requested %u pages, uploaded %u, evicted %u", virtualTexture.requestedPagesLastReadback, virtualTexture.uploadedPagesLastFrame, virtualTexture.evictedPagesLastFrame);
+      ImGui::Image((ImTextureID)(intptr_t)virtualTexture.physicalTexture, ImVec2{256.f, 256.f}, ImVec2{0, 1}, ImVec2{1, 0});
+    }
+    ImGui::End();
+
+    static int budgetMiB = static_cast<int>(residency.budgetBytes >> 20);
+    ImGui::Begin("GPU memory");
+    const GpuMemoryTracker& gpuMemory = getGpuMemoryTracker();
+    if (ImGui::SliderInt("Budget (MiB)", &budgetMiB, 16, 8192))
+      residency.budgetBytes = static_cast<size_t>(budgetMiB) << 20;
+    // Per category breakdown is in the Memory window
+    ImGui::Text("Total: %.1f MiB%s, peak %.1f MiB", gpuMemory.totalBytes / 1048576.0, residency.overBudget ? " (over budget)" : "", gpuMemory.peakTotalBytes / 1048576.0);
+    ImGui::SeparatorText("Residency");
+    ImGui::Text("Last frame: evicted %u meshes, %u texture levels (%zu KiB)", residency.evictedMeshesLastFrame, residency.evictedTextureLevelsLastFrame, residency.evictedBytesLastFrame / 1024);
+    ImGui::Text("Last frame: restored %u meshes, restreaming %u textures", residency.restoredMeshesLastFrame, residency.restreamedTexturesLastFrame);
+    ImGui::Text("%llu evictions in total", static_cast<unsigned long long>(residency.numEvictions));
+    ImGui::End();
 
     ImGui::ShowDemoWindow();
+    drawGpuProfilerWindow(gpuProfiler);
+    drawCpuProfilerWindow("traces");
+    drawPipelineStatisticsWindow(pipelineStatistics);
+    drawStartupTimelineWindow(startupTimeline);
+    drawMemoryWindow();
+    drawJobSystemWindow(jobs, jobStats);
+
+    // Passes declare what they read and write, the graph culls, allocates and places barriers from that
+    const bool renderVirtualTexture = vtPipeline != 0 && shading == static_cast<int>(Shading::VirtualTexture);
+    const bool renderMaterials = materialPipeline != 0 && shading == static_cast<int>(Shading::Materials);
+    RenderGraph renderGraph;
+    const uint32_t backbuffer = importRenderGraphFramebuffer(renderGraph, "Backbuffer", benchmarkFramebuffer, kWidth, kHeight);
+    const uint32_t perFrameResource = importRenderGraphBuffer(renderGraph, "Per frame data", perFrameData.ubo, sizeof(PerFrameData) * kFramesInFlight);
+    const uint32_t perObjectResource = importRenderGraphBuffer(renderGraph, "Per object data", perObjectData.ubo, sizeof(PerObjectData) * numInstances * kFramesInFlight);
+    // Offscreen at the dynamic resolution scale, so MSAA and resolution only cost the scene and ImGui draws on the
+    // single sampled backbuffer at the output resolution
+    const uint32_t sceneColor = createRenderGraphTexture(renderGraph, "Scene color", {.width = sceneWidth, .height = sceneHeight, .internalFormat = GL_RGBA8, .samples = msaaSamples});
+    const uint32_t sceneDepth = createRenderGraphTexture(renderGraph, "Scene depth", {.width = sceneWidth, .height = sceneHeight, .internalFormat = GL_DEPTH_COMPONENT24, .samples = msaaSamples});
+    if (depthPrepass) {
+      const uint32_t prepass = addRenderGraphPass(renderGraph, "Depth prepass", [&](const RenderGraph&) {
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glBindProgramPipeline(depthPipeline);
+        glBindBufferRange(GL_UNIFORM_BUFFER, 0, perFrameData.ubo, static_cast<GLintptr>(sizeof(PerFrameData) * frameSlot), sizeof(PerFrameData));
+        replayDrawPackets(scenePackets[frameSlot], perObjectData.ubo, 1, sizeof(PerObjectData), &residency, DrawPacketStream::Positions);
+        glBindProgramPipeline(0);
+      });
+      writeRenderGraphResource(renderGraph, prepass, sceneDepth, RenderGraphAccess::DepthAttachment);
+      readRenderGraphResource(renderGraph, prepass, perFrameResource, RenderGraphAccess::UniformBuffer);
+      readRenderGraphResource(renderGraph, prepass, perObjectResource, RenderGraphAccess::UniformBuffer);
+    }
+    DrawPacketStats sceneDraws;
+    const uint32_t scenePass = addRenderGraphPass(renderGraph, "Scene", [&](const RenderGraph&) {
+      glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+      glClear(depthPrepass ? GL_COLOR_BUFFER_BIT : GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      // Only the nearest surface passes, so every covered pixel is shaded once
+      if (depthPrepass) {
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+      }
+      if (renderVirtualTexture)
+        bindVirtualTexture(virtualTexture);
+      if (renderMaterials)
+        bindMaterialTable(materialTable);
+      glBindProgramPipeline(renderVirtualTexture ? vtPipeline : (renderMaterials ? materialPipeline : pipeline));
+      glBindBufferRange(GL_UNIFORM_BUFFER, 0, perFrameData.ubo, static_cast<GLintptr>(sizeof(PerFrameData) * frameSlot), sizeof(PerFrameData));
+      // Material ID reaches the shaders as gl_BaseInstance, the same way it would from an indirect draw command
+      sceneDraws = replayDrawPackets(scenePackets[frameSlot], perObjectData.ubo, 1, sizeof(PerObjectData), &residency);
+      glBindProgramPipeline(0);
+      glDepthFunc(GL_LESS);
+      glDepthMask(GL_TRUE);
+    });
+    writeRenderGraphResource(renderGraph, scenePass, sceneColor, RenderGraphAccess::ColorAttachment);
+    writeRenderGraphResource(renderGraph, scenePass, sceneDepth, RenderGraphAccess::DepthAttachment);
+    readRenderGraphResource(renderGraph, scenePass, perFrameResource, RenderGraphAccess::UniformBuffer);
+    readRenderGraphResource(renderGraph, scenePass, perObjectResource, RenderGraphAccess::UniformBuffer);
+    if (renderVirtualTexture) {
+      const uint32_t feedback = importRenderGraphBuffer(renderGraph, "VT feedback", virtualTexture.feedbackBuffer, sizeof(uint32_t) * virtualTexture.numPages);
+      writeRenderGraphResource(renderGraph, scenePass, feedback, RenderGraphAccess::StorageBuffer);
+    }
+    const uint32_t resolvedColor = addMsaaResolvePass(renderGraph, scenePass, sceneColor);
+    const uint32_t finalColor = addPostAntiAliasingPasses(renderGraph, postProcessPipelines, static_cast<PostAntiAliasing>(postAntiAliasing), resolvedColor);
+    const uint32_t upscaledColor = addUpscalePasses(renderGraph, postProcessPipelines, static_cast<Upscaler>(upscaler), finalColor, kWidth, kHeight);
+    addPresentPass(renderGraph, postProcessPipelines, upscaledColor, backbuffer);
+    // Composited on the resolved image, at one sample per pixel
+    const uint32_t imguiPass = addRenderGraphPass(renderGraph, "ImGui", [](const RenderGraph&) { ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData()); });
+    writeRenderGraphResource(renderGraph, imguiPass, backbuffer, RenderGraphAccess::ColorAttachment);
+    compileRenderGraph(renderGraph, renderGraphPool);
+    drawRenderGraphWindow(renderGraph);
 
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    executeRenderGraph(renderGraph, &gpuProfiler, &pipelineStatistics);
+    trimRenderGraphPool(renderGraphPool);
     if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
       GLFWwindow* backup_current_context = glfwGetCurrentContext();
       ImGui::UpdatePlatformWindows();
       ImGui::RenderPlatformWindowsDefault();
       glfwMakeContextCurrent(backup_current_context);
     }
-    glfwSwapBuffers(window);
+    if (!benchmarkOptions.enabled) {
+      CPU_PROFILE_ZONE("Swap buffers");
+      glfwSwapBuffers(window);
+    }
+    markStartupFirstSwap(startupTimeline);
+    beginGpuZone(gpuProfiler, "Streaming");
+    updateTextureStreamer(textureStreamer, static_cast<size_t>(uploadBudgetKiB) * 1024);
+    updateResidency(residency);
+    if (renderVirtualTexture)
+      updateVirtualTexture(virtualTexture, static_cast<uint32_t>(maxPageUploadsPerFrame));
+    endGpuZone(gpuProfiler);
+    endGpuProfilerFrame(gpuProfiler);
+    endPipelineStatisticsFrame(pipelineStatistics);
+    endFrameSubmission(framePipeline, frame);
+    ++frame;
+
+    if (benchmarkOptions.enabled) {
+      benchmarkFences[benchmarkFrame % benchmarkFences.size()] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      ++benchmarkFrame;
+      if (benchmarkMeasuring) {
+        benchmarkReport.cpuFrameTimesMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cpuFrameStart).count());
+        benchmarkReport.drawCalls = sceneDraws.drawCalls;
+        benchmarkReport.triangles = sceneDraws.triangles;
+        benchmarkReport.resolutionScales.push_back(dynamicResolution.scale);
+        if (benchmarkReport.cpuFrameTimesMs.size() >= benchmarkOptions.measuredFrames)
+          glfwSetWindowShouldClose(window, GLFW_TRUE);
+      }
+    }
   }
 
+  bool benchmarkSucceeded = true;
+  if (benchmarkOptions.enabled) {
+    flushGpuProfiler(gpuProfiler);
+    flushPipelineStatistics(pipelineStatistics);
+    benchmarkReport.wallTimeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - benchmarkStart).count();
+    benchmarkReport.gpuFrameTimesMs.assign(gpuProfiler.frameTimesMs.begin(), gpuProfiler.frameTimesMs.end());
+    benchmarkReport.gpuDroppedFrames = gpuProfiler.droppedFrames - droppedGpuFramesBeforeMeasuring;
+    benchmarkReport.pipelineStatistics = &pipelineStatistics;
+    benchmarkReport.gpuProfiler = &gpuProfiler;
+    benchmarkReport.startupTimeline = &startupTimeline;
+    benchmarkSucceeded = benchmarkMeasuring && writeBenchmarkReport(benchmarkReport);
+    for (const GLsync fence : benchmarkFences) {
+      if (fence != nullptr)
+        glDeleteSync(fence);
+    }
+    glDeleteFramebuffers(1, &benchmarkFramebuffer);
+    trackedDeleteRenderbuffers(1, &benchmarkRenderbuffer);
+  }
+
+  // The next frame's simulation is still running
+  destroyFramePipeline(framePipeline);
+  if (hasVirtualTexture)
+    destroyVirtualTexture(virtualTexture);
+  printStartupTimeline(startupTimeline);
+  printPipelineStatistics(pipelineStatistics);
+  printMemoryReport();
+  destroyRenderGraphPool(renderGraphPool);
+  destroyPipelineStatistics(pipelineStatistics);
+  destroyGpuProfiler(gpuProfiler);
+  destroyMaterialTable(materialTable);
+  for (MeshGpu& mg : meshGpus)
+    destroyMeshGpu(mg);
+  destroyTextureStreamer(textureStreamer);
+  destroyPostProcessPipelines(postProcessPipelines);
+  destroyProgramPipelineCache(pipelineCache);
+  closeAssetPack(shaderPack);
   ImGui_ImplOpenGL3_Shutdown();
   ImGui_ImplGlfw_Shutdown();
   ImGui::DestroyContext();
   glfwTerminate();
 
   std::println("Bye!");
-  return 0;
+  return benchmarkSucceeded ? 0 : 1;
 }
 
 void keyCallback(GLFWwindow* window, int key, [[maybe_unused]] int scancode, int action, [[maybe_unused]] int mode) {
   if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
     glfwSetWindowShouldClose(window, GL_TRUE);
 }
-
-bool readBinaryFile(const std::filesystem::path& path, std::vector<std::byte>& outBuffer) {
-  if (!std::filesystem::exists(path)) {
-    std::println("File does not exist: {}", path.string());
-    return false;
-  }
-  const auto fileSize = std::filesystem::file_size(path);
-  if (fileSize == 0) {
-    std::println("File is empty: {}", path.string());
-    return false;
-  }
-  std::ifstream file(path, std::ios::binary | std::ios::ate);
-  if (!file.is_open()) {
-    std::println("Error opening shader file: {}", path.string());
-    return false;
-  }
-
-  file.seekg(0, std::ios::beg);
-  outBuffer.resize(fileSize);
-  file.read(reinterpret_cast<char*>(outBuffer.data()), fileSize);
-  file.close();
-
-  return true;
-}
-
-GLuint loadShaderSpirV(const std::filesystem::path& vertPath, const std::filesystem::path& fragPath) {
-  int32_t success{};
-  constexpr uint32_t infoLogSize = 512;
-  char infoLog[512];
-
-  std::vector<std::byte> vertBuffer;
-  if(!readBinaryFile(vertPath, vertBuffer)) {
-    return 0;
-  }
-  GLuint vertShader = glCreateShader(GL_VERTEX_SHADER);
-  glShaderBinary(1, &vertShader, GL_SHADER_BINARY_FORMAT_SPIR_V, vertBuffer.data(), static_cast<GLsizei>(vertBuffer.size()));
-  glSpecializeShader(vertShader, "main", 0, nullptr, nullptr);
-  glGetShaderiv(vertShader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(vertShader, infoLogSize, nullptr, infoLog);
-    std::println(std::cerr, "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n{}", infoLog);
-    glDeleteShader(vertShader);
-    return 0;
-  }
-
-  std::vector<std::byte> fragBuffer;
-  if(!readBinaryFile(fragPath, fragBuffer)) {
-    glDeleteShader(vertShader);
-    return 0;
-  }
-  GLuint fragShader = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderBinary(1, &fragShader, GL_SHADER_BINARY_FORMAT_SPIR_V, fragBuffer.data(), static_cast<GLsizei>(fragBuffer.size()));
-  glSpecializeShader(fragShader, "main", 0, nullptr, nullptr);
-  glGetShaderiv(fragShader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(fragShader, infoLogSize, nullptr, infoLog);
-    std::println(std::cerr, "ERROR::SHADER::FRAG::COMPILATION_FAILED\n{}", infoLog);
-    glDeleteShader(vertShader);
-    glDeleteShader(fragShader);
-    return 0;
-  }
-
-  const GLuint program = glCreateProgram();
-  glAttachShader(program, vertShader);
-  glAttachShader(program, fragShader);
-  glLinkProgram(program);
-  glGetProgramiv(program, GL_LINK_STATUS, &success);
-  if (!success) {
-    glGetProgramInfoLog(program, infoLogSize, nullptr, infoLog);
-    std::println(std::cerr, "ERROR::SHADER::PROGRAM::LINKING_FAILED\n{}", infoLog);
-    glDeleteShader(vertShader);
-    glDeleteShader(fragShader);
-    glDeleteProgram(program);
-    return 0;
-  }
-
-  glDeleteShader(vertShader);
-  glDeleteShader(fragShader);
-  return program;
-}
-
-Mesh processMesh(const aiMesh *mesh, const aiScene *scene) {
-  Mesh outMesh;
-  outMesh.vertices.reserve(mesh->mNumVertices);
-  for (uint32_t vertIx = 0; vertIx < mesh->mNumVertices; ++vertIx) {
-    Vertex& vertex = outMesh.vertices.emplace_back();
-    if (mesh->HasPositions()) {
-      vertex.position = {mesh->mVertices[vertIx].x, mesh->mVertices[vertIx].y, mesh->mVertices[vertIx].z};
-    } else {
-      vertex.position = {};
-    }
-    if (mesh->HasNormals()) {
-      vertex.normal = {mesh->mNormals[vertIx].x, mesh->mNormals[vertIx].y, mesh->mNormals[vertIx].z};
-    }
-    else {
-      vertex.normal = {};
-    }
-    if (mesh->mTextureCoords[0]) {
-      vertex.texCoord1 = {mesh->mTextureCoords[0][vertIx].x, mesh->mTextureCoords[0][vertIx].y};
-    } else {
-      vertex.texCoord1 = {};
-    }
-  }
-  outMesh.indices.reserve(mesh->mNumFaces * 3);
-  for (uint32_t i = 0; i < mesh->mNumFaces; ++i) {
-    const aiFace& face = mesh->mFaces[i];
-    assert(face.mNumIndices == 3);
-    for (uint32_t j = 0; j < face.mNumIndices; ++j) {
-      outMesh.indices.push_back(face.mIndices[j]);
-    }
-  }
-
-  aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-  std::println("Processing mesh '{}'. has position? {}, has normals? {}, has TexCoord0? {}, uv channels {}. Material '{}'", mesh->mName.C_Str(), mesh->HasPositions(), mesh->HasNormals(), mesh->HasTextureCoords(0), mesh->GetNumUVChannels(), material->GetName().C_Str());
-  return outMesh;
-}
-
-void loadMeshesFromAiNode(const aiNode *node, const aiScene *scene, std::vector<Mesh>& outMeshes) { // NOLINT(*-no-recursion)
-  for(unsigned int i = 0; i < node->mNumMeshes; i++) {
-      aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-      outMeshes.push_back(processMesh(mesh, scene));
-  }
-  for(unsigned int i = 0; i < node->mNumChildren; i++) {
-    loadMeshesFromAiNode(node->mChildren[i], scene, outMeshes);
-  }
-}
\ No newline at end of file
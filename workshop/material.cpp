@@ -0,0 +1,220 @@
+#include "material.hpp"
+
+#include "cpu_memory.hpp"
+#include "cpu_profiler.hpp"
+#include "gpu_memory.hpp"
+#include "mip_generator.hpp"
+
+#include <assimp/material.h>
+#include <assimp/scene.h>
+#include <OpenImageIO/imageio.h>
+
+#include <algorithm>
+#include <cstring>
+#include <print>
+#include <unordered_map>
+
+namespace {
+struct DecodedTexture {
+  std::filesystem::path path;
+  uint32_t width{};
+  uint32_t height{};
+  std::vector<MipLevel> levels;
+  // RGBA8 mip chain, bottom row first. Empty when decoding failed.
+  std::vector<std::byte> chain;
+};
+
+void decodeTexture(DecodedTexture& tex, JobSystem* jobs) {
+  CPU_PROFILE_ZONE("Decode material texture");
+  MemoryTagScope memoryTag(MemoryTag::Textures);
+  auto inp = OIIO::ImageInput::open(tex.path.string());
+  if (!inp) {
+    std::println("Error loading texture file: {}", OIIO::geterror());
+    return;
+  }
+  const OIIO::ImageSpec& spec = inp->spec();
+  const auto width = static_cast<uint32_t>(spec.width);
+  const auto height = static_cast<uint32_t>(spec.height);
+  const auto numChannels = static_cast<uint32_t>(std::min(spec.nchannels, 4));
+  if (size_t{width} * height == 0) {
+    std::println("Texture {} is empty", tex.path.string());
+    return;
+  }
+  const size_t rowBytes = size_t{width} * numChannels;
+  std::vector<uint8_t> pixels(rowBytes * height);
+  if (!inp->read_image(0, 0, 0, static_cast<int>(numChannels), OIIO::TypeDesc::UINT8, pixels.data() + rowBytes * (height - 1), OIIO::AutoStride, -static_cast<OIIO::stride_t>(rowBytes))) {
+    std::println("Error decoding texture file {}: {}", tex.path.string(), inp->geterror());
+    return;
+  }
+
+  // Arrays have a single format, so everything is expanded to RGBA
+  tex.levels = computeMipChainLayout(width, height, 4);
+  tex.chain.resize(computeMipChainSize(tex.levels, 4));
+  auto* dst = reinterpret_cast<uint8_t*>(tex.chain.data());
+  for (size_t i = 0; i < size_t{width} * height; ++i, dst += 4) {
+    const uint8_t* src = pixels.data() + i * numChannels;
+    dst[0] = src[0];
+    dst[1] = numChannels >= 3 ? src[1] : src[0];
+    dst[2] = numChannels >= 3 ? src[2] : src[0];
+    dst[3] = numChannels == 4 ? src[3] : (numChannels == 2 ? src[1] : 255);
+  }
+  generateMipChain(tex.chain, tex.levels, 4, {}, jobs);
+  tex.width = width;
+  tex.height = height;
+}
+
+uint64_t makeSizeKey(uint32_t width, uint32_t height) {
+  return (uint64_t{width} << 32) | height;
+}
+}  // namespace
+
+void loadMaterialTable(MaterialTable& table, const aiScene& scene, const std::filesystem::path& modelDir, JobSystem* jobs) {
+  CPU_PROFILE_ZONE("Load materials");
+  MemoryTagScope memoryTag(MemoryTag::Textures);
+  std::vector<DecodedTexture> textures;
+  std::unordered_map<std::string, uint32_t> textureIxByPath;
+  // Per material, index into textures or kNoMaterialTexture
+  std::vector<uint32_t> materialTextures;
+  for (uint32_t materialIx = 0; materialIx < scene.mNumMaterials; ++materialIx) {
+    const aiMaterial& material = *scene.mMaterials[materialIx];
+    MaterialGpu& gpu = table.materials.emplace_back();
+    table.names.emplace_back(material.GetName().C_Str());
+    aiColor4D diffuse{1.f, 1.f, 1.f, 1.f};
+    if (material.Get(AI_MATKEY_COLOR_DIFFUSE, diffuse) == aiReturn_SUCCESS) {
+      gpu.baseColorFactor[0] = diffuse.r;
+      gpu.baseColorFactor[1] = diffuse.g;
+      gpu.baseColorFactor[2] = diffuse.b;
+    }
+    float opacity = 1.f;
+    if (material.Get(AI_MATKEY_OPACITY, opacity) == aiReturn_SUCCESS)
+      gpu.baseColorFactor[3] = opacity;
+
+    uint32_t textureIx = kNoMaterialTexture;
+    const aiTextureType type = material.GetTextureCount(aiTextureType_BASE_COLOR) > 0 ? aiTextureType_BASE_COLOR : aiTextureType_DIFFUSE;
+    aiString texPath;
+    if (material.GetTexture(type, 0, &texPath) == aiReturn_SUCCESS) {
+      if (texPath.data[0] == '*') {
+        std::println("Material '{}' uses embedded texture {}, which is not supported", table.names.back(), texPath.C_Str());
+      } else {
+        const std::filesystem::path path = modelDir / texPath.C_Str();
+        const auto [it, inserted] = textureIxByPath.try_emplace(path.string(), static_cast<uint32_t>(textures.size()));
+        if (inserted)
+          textures.emplace_back().path = path;
+        textureIx = it->second;
+      }
+    }
+    materialTextures.push_back(textureIx);
+  }
+
+  // One texture per task, mips inside each run serially to keep the tasks independent
+  parallelFor(jobs, static_cast<uint32_t>(textures.size()), 1, [&](uint32_t begin, uint32_t end) {
+    for (uint32_t ix = begin; ix < end; ++ix)
+      decodeTexture(textures[ix], nullptr);
+  });
+
+  table.bindless = GLAD_GL_ARB_bindless_texture != 0;
+  // Layer of each texture in its bucket
+  std::vector<std::pair<uint32_t, uint32_t>> placements(textures.size(), {kNoMaterialTexture, 0});
+  std::unordered_map<uint64_t, uint32_t> bucketIxBySize;
+  for (size_t textureIx = 0; textureIx < textures.size(); ++textureIx) {
+    const DecodedTexture& tex = textures[textureIx];
+    if (tex.chain.empty())
+      continue;
+    const auto [it, inserted] = bucketIxBySize.try_emplace(makeSizeKey(tex.width, tex.height), static_cast<uint32_t>(table.textureArrays.size()));
+    if (inserted) {
+      if (!table.bindless && table.textureArrays.size() == kMaxBoundTextureArrays) {
+        bucketIxBySize.erase(it);
+        std::println("Texture {} needs more than {} texture arrays without bindless textures, skipping", tex.path.string(), kMaxBoundTextureArrays);
+        continue;
+      }
+      table.textureArrays.push_back({tex.width, tex.height, static_cast<uint32_t>(tex.levels.size())});
+    }
+    placements[textureIx] = {it->second, table.textureArrays[it->second].numLayers++};
+  }
+
+  for (TextureArrayBucket& bucket : table.textureArrays) {
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &bucket.texture);
+    trackedTextureStorage3D(GpuMemoryCategory::Textures, bucket.texture, static_cast<GLsizei>(bucket.numLevels), GL_RGBA8, static_cast<GLsizei>(bucket.width), static_cast<GLsizei>(bucket.height), static_cast<GLsizei>(bucket.numLayers));
+    glTextureParameteri(bucket.texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(bucket.texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  }
+  for (size_t textureIx = 0; textureIx < textures.size(); ++textureIx) {
+    const auto [bucketIx, layer] = placements[textureIx];
+    if (bucketIx == kNoMaterialTexture)
+      continue;
+    const DecodedTexture& tex = textures[textureIx];
+    for (size_t levelIx = 0; levelIx < tex.levels.size(); ++levelIx) {
+      const MipLevel& level = tex.levels[levelIx];
+      glTextureSubImage3D(table.textureArrays[bucketIx].texture, static_cast<GLint>(levelIx), 0, 0, static_cast<GLint>(layer), static_cast<GLsizei>(level.width), static_cast<GLsizei>(level.height), 1, GL_RGBA, GL_UNSIGNED_BYTE, tex.chain.data() + level.offset);
+    }
+  }
+  // Handles are taken after the storage is complete, the texture state is frozen from then on
+  if (table.bindless) {
+    for (TextureArrayBucket& bucket : table.textureArrays) {
+      bucket.handle = glGetTextureHandleARB(bucket.texture);
+      glMakeTextureHandleResidentARB(bucket.handle);
+    }
+  }
+
+  for (size_t materialIx = 0; materialIx < table.materials.size(); ++materialIx) {
+    if (materialTextures[materialIx] == kNoMaterialTexture)
+      continue;
+    const auto [bucketIx, layer] = placements[materialTextures[materialIx]];
+    if (bucketIx == kNoMaterialTexture)
+      continue;
+    MaterialGpu& gpu = table.materials[materialIx];
+    gpu.baseColorArray = bucketIx;
+    gpu.baseColorLayer = layer;
+    const GLuint64 handle = table.textureArrays[bucketIx].handle;
+    gpu.baseColorHandle[0] = static_cast<uint32_t>(handle);
+    gpu.baseColorHandle[1] = static_cast<uint32_t>(handle >> 32);
+  }
+
+  if (table.materials.empty()) {
+    std::println("Scene has no materials, adding a default one");
+    table.materials.emplace_back();
+    table.names.emplace_back("Default");
+  }
+  glCreateBuffers(1, &table.buffer);
+  trackedNamedBufferStorage(GpuMemoryCategory::StorageBuffers, table.buffer, static_cast<GLsizeiptr>(sizeof(MaterialGpu) * table.materials.size()), table.materials.data(), 0);
+  std::println("Loaded {} materials, {} textures in {} texture arrays{}", table.materials.size(), textures.size(), table.textureArrays.size(), table.bindless ? " with bindless handles" : "");
+}
+
+void capMaterialTableToBoundArrays(MaterialTable& table) {
+  table.bindless = false;
+  if (table.textureArrays.size() <= kMaxBoundTextureArrays)
+    return;
+  uint32_t numUntextured = 0;
+  for (MaterialGpu& gpu : table.materials) {
+    if (gpu.baseColorArray == kNoMaterialTexture || gpu.baseColorArray < kMaxBoundTextureArrays)
+      continue;
+    gpu.baseColorArray = kNoMaterialTexture;
+    gpu.baseColorLayer = 0;
+    ++numUntextured;
+  }
+  std::println("{} materials need more than {} texture arrays without bindless textures, drawing them untextured", numUntextured, kMaxBoundTextureArrays);
+  // Immutable storage, so the table is uploaded again into a new buffer
+  trackedDeleteBuffers(1, &table.buffer);
+  glCreateBuffers(1, &table.buffer);
+  trackedNamedBufferStorage(GpuMemoryCategory::StorageBuffers, table.buffer, static_cast<GLsizeiptr>(sizeof(MaterialGpu) * table.materials.size()), table.materials.data(), 0);
+}
+
+void bindMaterialTable(const MaterialTable& table) {
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kMaterialTableBinding, table.buffer);
+  // Also done with bindless handles, in case the bindless shader variant is not available
+  for (size_t ix = 0; ix < std::min<size_t>(table.textureArrays.size(), kMaxBoundTextureArrays); ++ix)
+    glBindTextureUnit(kTextureArrayFirstUnit + static_cast<GLuint>(ix), table.textureArrays[ix].texture);
+}
+
+void destroyMaterialTable(MaterialTable& table) {
+  for (TextureArrayBucket& bucket : table.textureArrays) {
+    if (bucket.handle != 0)
+      glMakeTextureHandleNonResidentARB(bucket.handle);
+    trackedDeleteTextures(1, &bucket.texture);
+  }
+  table.textureArrays.clear();
+  trackedDeleteBuffers(1, &table.buffer);
+  table.buffer = 0;
+  table.materials.clear();
+  table.names.clear();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "job_system.hpp"
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct aiScene;
+
+constexpr uint32_t kNoMaterialTexture = 0xFFFFFFFF;
+// Shader side bindings, see material.frag. Units after the virtual texture's physical texture.
+constexpr GLuint kMaterialTableBinding = 2;
+constexpr GLuint kTextureArrayFirstUnit = 1;
+constexpr uint32_t kMaxBoundTextureArrays = 8;
+
+// std430 layout of Material in material.frag
+struct MaterialGpu {
+  float baseColorFactor[4]{1.f, 1.f, 1.f, 1.f};
+  // Index into MaterialTable::textureArrays and layer in it, kNoMaterialTexture when untextured
+  uint32_t baseColorArray{kNoMaterialTexture};
+  uint32_t baseColorLayer{};
+  // ARB_bindless_texture handle of the array, split into two uints. 0 without bindless.
+  uint32_t baseColorHandle[2]{};
+};
+static_assert(sizeof(MaterialGpu) == 32);
+
+// All textures of the same size and format share one GL_TEXTURE_2D_ARRAY, one layer each
+struct TextureArrayBucket {
+  uint32_t width{};
+  uint32_t height{};
+  uint32_t numLevels{};
+  uint32_t numLayers{};
+  GLuint texture{};
+  GLuint64 handle{};
+};
+
+// Every material of a scene in a single SSBO indexed by material ID, which draws pass as their base instance. Textures
+// are reached through the table instead of per-draw binds, so draws of different materials can share one
+// multi-draw-indirect batch.
+struct MaterialTable {
+  std::vector<MaterialGpu> materials;
+  std::vector<std::string> names;
+  std::vector<TextureArrayBucket> textureArrays;
+  GLuint buffer{};
+  // Handles in the table are resident and shaders may use material_bindless.frag
+  bool bindless{};
+};
+
+// Materials are indexed like aiScene::mMaterials. Base color textures are decoded in parallel and get their mip chain
+// from the CPU generator. Texture paths are relative to modelDir.
+void loadMaterialTable(MaterialTable& table, const aiScene& scene, const std::filesystem::path& modelDir, JobSystem* jobs);
+// For when the bindless shader variant is unavailable. Materials in texture arrays past kMaxBoundTextureArrays, which
+// material.frag cannot reach, become untextured.
+void capMaterialTableToBoundArrays(MaterialTable& table);
+// Binds the table, and the first kMaxBoundTextureArrays texture arrays to consecutive units
+void bindMaterialTable(const MaterialTable& table);
+void destroyMaterialTable(MaterialTable& table);
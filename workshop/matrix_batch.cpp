@@ -0,0 +1,225 @@
+#include "matrix_batch.hpp"
+
+#include "cpu_features.hpp"
+#include "matrix_batch_kernels.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATRIX_BATCH_SSE
+#include <xmmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MATRIX_BATCH_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+void composeTrsScalar(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* out, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i)
+    out[i] = composeTrs(translations[i], rotations[i], scales[i]);
+}
+
+void multiplyScalar(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i)
+    out[i] = left * right[i];
+}
+
+void multiplyByParentsScalar(const int32_t* parents, const glm::mat4* locals, glm::mat4* worlds, uint32_t begin, uint32_t end) {
+  for (uint32_t i = begin; i < end; ++i)
+    worlds[i] = parents[i] >= 0 ? worlds[parents[i]] * locals[i] : locals[i];
+}
+
+#if defined(MATRIX_BATCH_SSE) || defined(MATRIX_BATCH_NEON)
+// Thin layer over SSE and NEON so both share the kernels below
+#ifdef MATRIX_BATCH_SSE
+using Float4 = __m128;
+Float4 load4(const float* p) { return _mm_loadu_ps(p); }
+void store4(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+Float4 set4(float v) { return _mm_set1_ps(v); }
+Float4 add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+Float4 sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+Float4 mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+// a * b + c, without FMA on baseline x86
+Float4 madd4(Float4 a, Float4 b, Float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+template <int lane>
+Float4 splat4(Float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(lane, lane, lane, lane)); }
+void transpose4(Float4& a, Float4& b, Float4& c, Float4& d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+#else
+using Float4 = float32x4_t;
+Float4 load4(const float* p) { return vld1q_f32(p); }
+void store4(float* p, Float4 v) { vst1q_f32(p, v); }
+Float4 set4(float v) { return vdupq_n_f32(v); }
+Float4 add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+Float4 sub4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+Float4 mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+Float4 madd4(Float4 a, Float4 b, Float4 c) { return vfmaq_f32(c, a, b); }
+template <int lane>
+Float4 splat4(Float4 v) { return vdupq_laneq_f32(v, lane); }
+void transpose4(Float4& a, Float4& b, Float4& c, Float4& d) {
+  const float32x4x2_t ab = vtrnq_f32(a, b);
+  const float32x4x2_t cd = vtrnq_f32(c, d);
+  a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+  b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+  c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+  d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+#endif
+
+// Column j of the product is the left columns weighted by the elements of right column j
+void multiplyColumns(const Float4 (&left)[4], const float* right, float* out) {
+  for (int j = 0; j < 4; ++j) {
+    const Float4 column = load4(right + 4 * j);
+    Float4 acc = mul4(left[0], splat4<0>(column));
+    acc = madd4(left[1], splat4<1>(column), acc);
+    acc = madd4(left[2], splat4<2>(column), acc);
+    acc = madd4(left[3], splat4<3>(column), acc);
+    store4(out + 4 * j, acc);
+  }
+}
+
+// Four matrices per iteration, one per lane, transposed back into columns on the way out
+void composeTrsSimd128(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* out, uint32_t count) {
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const auto lanes = [&](auto get) {
+      alignas(16) const float values[4] = {get(i), get(i + 1), get(i + 2), get(i + 3)};
+      return load4(values);
+    };
+    const Float4 qx = lanes([&](uint32_t k) { return rotations[k].x; });
+    const Float4 qy = lanes([&](uint32_t k) { return rotations[k].y; });
+    const Float4 qz = lanes([&](uint32_t k) { return rotations[k].z; });
+    const Float4 qw = lanes([&](uint32_t k) { return rotations[k].w; });
+    const Float4 sx = lanes([&](uint32_t k) { return scales[k].x; });
+    const Float4 sy = lanes([&](uint32_t k) { return scales[k].y; });
+    const Float4 sz = lanes([&](uint32_t k) { return scales[k].z; });
+    Float4 tx = lanes([&](uint32_t k) { return translations[k].x; });
+    Float4 ty = lanes([&](uint32_t k) { return translations[k].y; });
+    Float4 tz = lanes([&](uint32_t k) { return translations[k].z; });
+
+    const Float4 two = set4(2.f), one = set4(1.f);
+    const Float4 xx = mul4(qx, qx), yy = mul4(qy, qy), zz = mul4(qz, qz);
+    const Float4 xy = mul4(qx, qy), xz = mul4(qx, qz), yz = mul4(qy, qz);
+    const Float4 wx = mul4(qw, qx), wy = mul4(qw, qy), wz = mul4(qw, qz);
+    Float4 c0x = mul4(sub4(one, mul4(two, add4(yy, zz))), sx);
+    Float4 c0y = mul4(mul4(two, add4(xy, wz)), sx);
+    Float4 c0z = mul4(mul4(two, sub4(xz, wy)), sx);
+    Float4 c1x = mul4(mul4(two, sub4(xy, wz)), sy);
+    Float4 c1y = mul4(sub4(one, mul4(two, add4(xx, zz))), sy);
+    Float4 c1z = mul4(mul4(two, add4(yz, wx)), sy);
+    Float4 c2x = mul4(mul4(two, add4(xz, wy)), sz);
+    Float4 c2y = mul4(mul4(two, sub4(yz, wx)), sz);
+    Float4 c2z = mul4(sub4(one, mul4(two, add4(xx, yy))), sz);
+    Float4 w0 = set4(0.f), w1 = set4(0.f), w2 = set4(0.f), w3 = one;
+    transpose4(c0x, c0y, c0z, w0);
+    transpose4(c1x, c1y, c1z, w1);
+    transpose4(c2x, c2y, c2z, w2);
+    transpose4(tx, ty, tz, w3);
+    const Float4 columns[4][4] = {{c0x, c0y, c0z, w0}, {c1x, c1y, c1z, w1}, {c2x, c2y, c2z, w2}, {tx, ty, tz, w3}};
+    for (uint32_t k = 0; k < 4; ++k) {
+      float* dst = &out[i + k][0][0];
+      for (uint32_t column = 0; column < 4; ++column)
+        store4(dst + 4 * column, columns[column][k]);
+    }
+  }
+  composeTrsScalar(translations + i, rotations + i, scales + i, out + i, count - i);
+}
+
+void multiplySimd128(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, uint32_t count) {
+  const Float4 leftColumns[4] = {load4(&left[0][0]), load4(&left[1][0]), load4(&left[2][0]), load4(&left[3][0])};
+  for (uint32_t i = 0; i < count; ++i)
+    multiplyColumns(leftColumns, &right[i][0][0], &out[i][0][0]);
+}
+
+void multiplyByParentsSimd128(const int32_t* parents, const glm::mat4* locals, glm::mat4* worlds, uint32_t begin, uint32_t end) {
+  for (uint32_t i = begin; i < end; ++i) {
+    if (parents[i] < 0) {
+      worlds[i] = locals[i];
+      continue;
+    }
+    const glm::mat4& parent = worlds[parents[i]];
+    const Float4 parentColumns[4] = {load4(&parent[0][0]), load4(&parent[1][0]), load4(&parent[2][0]), load4(&parent[3][0])};
+    multiplyColumns(parentColumns, &locals[i][0][0], &worlds[i][0][0]);
+  }
+}
+#endif
+
+MatrixIsa resolveIsa(MatrixIsa isa) {
+  if (isa != MatrixIsa::Best && isMatrixIsaSupported(isa))
+    return isa;
+  const CpuFeatures& features = getCpuFeatures();
+  if (features.avx512f && features.fma)
+    return MatrixIsa::Avx512;
+  if (features.avx2 && features.fma)
+    return MatrixIsa::Avx2;
+  return MatrixIsa::Simd128;
+}
+
+const MatrixKernels& getMatrixKernels(MatrixIsa isa) {
+  switch (resolveIsa(isa)) {
+    case MatrixIsa::Avx512:
+      return getMatrixKernelsAvx512();
+    case MatrixIsa::Avx2:
+      return getMatrixKernelsAvx2();
+    case MatrixIsa::Simd128:
+      return getMatrixKernelsSimd128();
+    default:
+      return getMatrixKernelsScalar();
+  }
+}
+}  // namespace
+
+const MatrixKernels& getMatrixKernelsScalar() {
+  static constexpr MatrixKernels kernels{composeTrsScalar, multiplyScalar, multiplyByParentsScalar};
+  return kernels;
+}
+
+const MatrixKernels& getMatrixKernelsSimd128() {
+#if defined(MATRIX_BATCH_SSE) || defined(MATRIX_BATCH_NEON)
+  static constexpr MatrixKernels kernels{composeTrsSimd128, multiplySimd128, multiplyByParentsSimd128};
+  return kernels;
+#else
+  return getMatrixKernelsScalar();
+#endif
+}
+
+const char* getMatrixIsaName(MatrixIsa isa) {
+  switch (isa) {
+    case MatrixIsa::Best:
+      return "Best";
+    case MatrixIsa::Scalar:
+      return "Scalar";
+    case MatrixIsa::Simd128:
+#ifdef MATRIX_BATCH_NEON
+      return "NEON";
+#else
+      return "SSE";
+#endif
+    case MatrixIsa::Avx2:
+      return "AVX2";
+    case MatrixIsa::Avx512:
+      return "AVX-512";
+  }
+  return "?";
+}
+
+bool isMatrixIsaSupported(MatrixIsa isa) {
+  const CpuFeatures& features = getCpuFeatures();
+  switch (isa) {
+    case MatrixIsa::Avx512:
+      return features.avx512f && features.fma;
+    case MatrixIsa::Avx2:
+      return features.avx2 && features.fma;
+    default:
+      return true;
+  }
+}
+
+void composeTrsMatrices(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* out, uint32_t count, MatrixIsa isa) {
+  getMatrixKernels(isa).composeTrs(translations, rotations, scales, out, count);
+}
+
+void multiplyMatrices(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, uint32_t count, MatrixIsa isa) {
+  getMatrixKernels(isa).multiply(left, right, out, count);
+}
+
+void multiplyByParents(const int32_t* parents, const glm::mat4* locals, glm::mat4* worlds, uint32_t begin, uint32_t end, MatrixIsa isa) {
+  getMatrixKernels(isa).multiplyByParents(parents, locals, worlds, begin, end);
+}
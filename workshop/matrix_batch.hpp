@@ -0,0 +1,29 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+
+// Instruction set of the batch kernels below. Best picks the widest one the CPU supports at runtime, unsupported ones
+// fall back to it.
+enum class MatrixIsa : uint8_t {
+  Best,
+  Scalar,
+  // SSE on x86, NEON on AArch64, scalar elsewhere
+  Simd128,
+  Avx2,
+  Avx512,
+};
+
+const char* getMatrixIsaName(MatrixIsa isa);
+// Whether the CPU can run kernels for isa, Best and Scalar always can
+bool isMatrixIsaSupported(MatrixIsa isa);
+
+// out[i] = translate(translations[i]) * mat4_cast(rotations[i]) * scale(scales[i])
+void composeTrsMatrices(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* out, uint32_t count, MatrixIsa isa = MatrixIsa::Best);
+// out[i] = left * right[i], e.g. view projection times world. out may alias right.
+void multiplyMatrices(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, uint32_t count, MatrixIsa isa = MatrixIsa::Best);
+// worlds[i] = worlds[parents[i]] * locals[i] for i in [begin, end), in order, so parents have to precede their
+// children. Nodes without a parent (negative index) copy their local matrix.
+void multiplyByParents(const int32_t* parents, const glm::mat4* locals, glm::mat4* worlds, uint32_t begin, uint32_t end, MatrixIsa isa = MatrixIsa::Best);
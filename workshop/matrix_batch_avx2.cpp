@@ -0,0 +1,119 @@
+// Compiled with AVX2 and FMA enabled on x64. Only called after getCpuFeatures() confirmed support.
+#include "matrix_batch_kernels.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+
+namespace {
+// Rows of eight lanes into eight rows of the lanes, i.e. SoA values of eight matrices into their first or last eight floats
+void transpose8(__m256 (&rows)[8]) {
+  const __m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]), t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+  const __m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]), t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+  const __m256 t4 = _mm256_unpacklo_ps(rows[4], rows[5]), t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+  const __m256 t6 = _mm256_unpacklo_ps(rows[6], rows[7]), t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+  const __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44), s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+  const __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44), s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+  const __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44), s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+  const __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44), s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+  rows[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+  rows[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+  rows[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+  rows[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+  rows[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+  rows[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+  rows[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+  rows[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+// Eight matrices per iteration, one per lane. Inputs are loaded lane by lane rather than gathered, gathers are
+// microcoded and slower on several CPUs.
+void composeTrsAvx2(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* out, uint32_t count) {
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const auto lanes = [&](auto get) {
+      return _mm256_setr_ps(get(i), get(i + 1), get(i + 2), get(i + 3), get(i + 4), get(i + 5), get(i + 6), get(i + 7));
+    };
+    const __m256 qx = lanes([&](uint32_t k) { return rotations[k].x; });
+    const __m256 qy = lanes([&](uint32_t k) { return rotations[k].y; });
+    const __m256 qz = lanes([&](uint32_t k) { return rotations[k].z; });
+    const __m256 qw = lanes([&](uint32_t k) { return rotations[k].w; });
+    const __m256 sx = lanes([&](uint32_t k) { return scales[k].x; });
+    const __m256 sy = lanes([&](uint32_t k) { return scales[k].y; });
+    const __m256 sz = lanes([&](uint32_t k) { return scales[k].z; });
+
+    const __m256 two = _mm256_set1_ps(2.f), one = _mm256_set1_ps(1.f), zero = _mm256_setzero_ps();
+    const __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+    const __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+    const __m256 wx = _mm256_mul_ps(qw, qx), wy = _mm256_mul_ps(qw, qy), wz = _mm256_mul_ps(qw, qz);
+    // 1 - 2 * (a + b) and 2 * (a +- b)
+    const auto diagonal = [&](__m256 a, __m256 b) { return _mm256_fnmadd_ps(two, _mm256_add_ps(a, b), one); };
+    const auto sum = [&](__m256 a, __m256 b) { return _mm256_mul_ps(two, _mm256_add_ps(a, b)); };
+    const auto difference = [&](__m256 a, __m256 b) { return _mm256_mul_ps(two, _mm256_sub_ps(a, b)); };
+
+    __m256 first[8] = {
+        _mm256_mul_ps(diagonal(yy, zz), sx), _mm256_mul_ps(sum(xy, wz), sx), _mm256_mul_ps(difference(xz, wy), sx), zero,
+        _mm256_mul_ps(difference(xy, wz), sy), _mm256_mul_ps(diagonal(xx, zz), sy), _mm256_mul_ps(sum(yz, wx), sy), zero,
+    };
+    __m256 last[8] = {
+        _mm256_mul_ps(sum(xz, wy), sz), _mm256_mul_ps(difference(yz, wx), sz), _mm256_mul_ps(diagonal(xx, yy), sz), zero,
+        lanes([&](uint32_t k) { return translations[k].x; }), lanes([&](uint32_t k) { return translations[k].y; }), lanes([&](uint32_t k) { return translations[k].z; }), one,
+    };
+    transpose8(first);
+    transpose8(last);
+    for (uint32_t k = 0; k < 8; ++k) {
+      float* dst = &out[i + k][0][0];
+      _mm256_storeu_ps(dst, first[k]);
+      _mm256_storeu_ps(dst + 8, last[k]);
+    }
+  }
+  for (; i < count; ++i)
+    out[i] = composeTrs(translations[i], rotations[i], scales[i]);
+}
+
+// Two columns of the product per register: left columns broadcast to both halves, right elements splat per half
+void multiplyColumnPairs(const __m256 (&left)[4], const float* right, float* out) {
+  for (int pair = 0; pair < 2; ++pair) {
+    const __m256 columns = _mm256_loadu_ps(right + 8 * pair);
+    __m256 acc = _mm256_mul_ps(left[0], _mm256_shuffle_ps(columns, columns, 0x00));
+    acc = _mm256_fmadd_ps(left[1], _mm256_shuffle_ps(columns, columns, 0x55), acc);
+    acc = _mm256_fmadd_ps(left[2], _mm256_shuffle_ps(columns, columns, 0xAA), acc);
+    acc = _mm256_fmadd_ps(left[3], _mm256_shuffle_ps(columns, columns, 0xFF), acc);
+    _mm256_storeu_ps(out + 8 * pair, acc);
+  }
+}
+
+void loadBroadcastColumns(const glm::mat4& m, __m256 (&columns)[4]) {
+  for (int column = 0; column < 4; ++column)
+    columns[column] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[column][0]));
+}
+
+void multiplyAvx2(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, uint32_t count) {
+  __m256 leftColumns[4];
+  loadBroadcastColumns(left, leftColumns);
+  for (uint32_t i = 0; i < count; ++i)
+    multiplyColumnPairs(leftColumns, &right[i][0][0], &out[i][0][0]);
+}
+
+void multiplyByParentsAvx2(const int32_t* parents, const glm::mat4* locals, glm::mat4* worlds, uint32_t begin, uint32_t end) {
+  for (uint32_t i = begin; i < end; ++i) {
+    if (parents[i] < 0) {
+      worlds[i] = locals[i];
+      continue;
+    }
+    __m256 parentColumns[4];
+    loadBroadcastColumns(worlds[parents[i]], parentColumns);
+    multiplyColumnPairs(parentColumns, &locals[i][0][0], &worlds[i][0][0]);
+  }
+}
+}  // namespace
+
+const MatrixKernels& getMatrixKernelsAvx2() {
+  static constexpr MatrixKernels kernels{composeTrsAvx2, multiplyAvx2, multiplyByParentsAvx2};
+  return kernels;
+}
+#else
+// Other architectures get no AVX flags, and the CPU check never selects these
+const MatrixKernels& getMatrixKernelsAvx2() {
+  return getMatrixKernelsSimd128();
+}
+#endif
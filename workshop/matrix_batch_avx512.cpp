@@ -0,0 +1,53 @@
+// Compiled with AVX-512F and FMA enabled on x64. Only called after getCpuFeatures() confirmed support.
+#include "matrix_batch_kernels.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+
+namespace {
+// A whole matrix per register: left columns broadcast to all four 128-bit lanes, right elements splat per lane
+void multiplyMatrix(const __m512 (&left)[4], const float* right, float* out) {
+  const __m512 columns = _mm512_loadu_ps(right);
+  __m512 acc = _mm512_mul_ps(left[0], _mm512_permute_ps(columns, 0x00));
+  acc = _mm512_fmadd_ps(left[1], _mm512_permute_ps(columns, 0x55), acc);
+  acc = _mm512_fmadd_ps(left[2], _mm512_permute_ps(columns, 0xAA), acc);
+  acc = _mm512_fmadd_ps(left[3], _mm512_permute_ps(columns, 0xFF), acc);
+  _mm512_storeu_ps(out, acc);
+}
+
+void loadBroadcastColumns(const glm::mat4& m, __m512 (&columns)[4]) {
+  for (int column = 0; column < 4; ++column)
+    columns[column] = _mm512_broadcast_f32x4(_mm_loadu_ps(&m[column][0]));
+}
+
+void multiplyAvx512(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, uint32_t count) {
+  __m512 leftColumns[4];
+  loadBroadcastColumns(left, leftColumns);
+  for (uint32_t i = 0; i < count; ++i)
+    multiplyMatrix(leftColumns, &right[i][0][0], &out[i][0][0]);
+}
+
+void multiplyByParentsAvx512(const int32_t* parents, const glm::mat4* locals, glm::mat4* worlds, uint32_t begin, uint32_t end) {
+  for (uint32_t i = begin; i < end; ++i) {
+    if (parents[i] < 0) {
+      worlds[i] = locals[i];
+      continue;
+    }
+    __m512 parentColumns[4];
+    loadBroadcastColumns(worlds[parents[i]], parentColumns);
+    multiplyMatrix(parentColumns, &locals[i][0][0], &worlds[i][0][0]);
+  }
+}
+}  // namespace
+
+const MatrixKernels& getMatrixKernelsAvx512() {
+  // Composition is bound by the lane loads and the transpose, wider registers do not help it
+  static const MatrixKernels kernels{getMatrixKernelsAvx2().composeTrs, multiplyAvx512, multiplyByParentsAvx512};
+  return kernels;
+}
+#else
+// Other architectures get no AVX flags, and the CPU check never selects these
+const MatrixKernels& getMatrixKernelsAvx512() {
+  return getMatrixKernelsSimd128();
+}
+#endif
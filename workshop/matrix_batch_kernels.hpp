@@ -0,0 +1,33 @@
+#pragma once
+
+// Internal to matrix_batch*.cpp. Kernels live in separate translation units per instruction set so that only the
+// dispatched one executes instructions the CPU may not have.
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+
+struct MatrixKernels {
+  void (*composeTrs)(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* out, uint32_t count);
+  void (*multiply)(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, uint32_t count);
+  void (*multiplyByParents)(const int32_t* parents, const glm::mat4* locals, glm::mat4* worlds, uint32_t begin, uint32_t end);
+};
+
+const MatrixKernels& getMatrixKernelsScalar();
+const MatrixKernels& getMatrixKernelsSimd128();
+const MatrixKernels& getMatrixKernelsAvx2();
+const MatrixKernels& getMatrixKernelsAvx512();
+
+// One TRS matrix, shared by the scalar kernel and the remainders of the wide ones
+inline glm::mat4 composeTrs(const glm::vec3& t, const glm::quat& q, const glm::vec3& s) {
+  const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+  const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+  const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+  return {
+      glm::vec4{(1.f - 2.f * (yy + zz)) * s.x, 2.f * (xy + wz) * s.x, 2.f * (xz - wy) * s.x, 0.f},
+      glm::vec4{2.f * (xy - wz) * s.y, (1.f - 2.f * (xx + zz)) * s.y, 2.f * (yz + wx) * s.y, 0.f},
+      glm::vec4{2.f * (xz + wy) * s.z, 2.f * (yz - wx) * s.z, (1.f - 2.f * (xx + yy)) * s.z, 0.f},
+      glm::vec4{t, 1.f},
+  };
+}
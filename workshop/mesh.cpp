@@ -0,0 +1,141 @@
+#include "mesh.hpp"
+
+#include "cpu_memory.hpp"
+#include "gpu_memory.hpp"
+#include "job_system.hpp"
+
+#include <assimp/scene.h>
+
+#include <cassert>
+
+namespace {
+GLuint createVertexBuffer(uint32_t numVertices, GLsizei stride, GLuint vao) {
+  GLuint vbo{};
+  glCreateBuffers(1, &vbo);
+  trackedNamedBufferStorage(GpuMemoryCategory::Meshes, vbo, static_cast<GLsizeiptr>(stride) * numVertices, nullptr, GL_DYNAMIC_STORAGE_BIT);
+  glVertexArrayVertexBuffer(vao, 0, vbo, 0, stride);
+  return vbo;
+};
+
+GLuint createIndexBuffer(uint32_t numIndices, GLuint vao, GLuint positionVao) {
+  GLuint ibo{};
+  glCreateBuffers(1, &ibo);
+  trackedNamedBufferStorage(GpuMemoryCategory::Meshes, ibo, sizeof(uint32_t) * numIndices, nullptr, GL_DYNAMIC_STORAGE_BIT);
+  glVertexArrayElementBuffer(vao, ibo);
+  glVertexArrayElementBuffer(positionVao, ibo);
+  return ibo;
+}
+
+void collectAiMeshes(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& outMeshes) { // NOLINT(*-no-recursion)
+  for (uint32_t i = 0; i < node->mNumMeshes; ++i)
+    outMeshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+  for (uint32_t i = 0; i < node->mNumChildren; ++i)
+    collectAiMeshes(node->mChildren[i], scene, outMeshes);
+}
+}  // namespace
+
+MeshGpu createMeshGpu(const Mesh& mesh) {
+  MeshGpu m{};
+  glCreateVertexArrays(1, &m.vertexArray);
+  glBindVertexArray(m.vertexArray);
+
+  // See Vertex. {position, normal, texCoord1}
+  static const std::vector<int32_t> sizes = {3, 3, 2};
+  uint32_t offset = 0;
+  for (uint32_t ix = 0; ix < sizes.size(); ++ix) {
+    glEnableVertexArrayAttrib(m.vertexArray, ix);
+    glVertexArrayAttribFormat(m.vertexArray, ix, sizes[ix], GL_FLOAT, GL_FALSE, offset);
+    glVertexArrayAttribBinding(m.vertexArray, ix, 0);
+    offset += sizes[ix] * sizeof(float);
+  }
+  // Same attribute location as the position in the full stream, so both work with the same vertex shader
+  glCreateVertexArrays(1, &m.positionVertexArray);
+  glEnableVertexArrayAttrib(m.positionVertexArray, 0);
+  glVertexArrayAttribFormat(m.positionVertexArray, 0, 3, GL_FLOAT, GL_FALSE, 0);
+  glVertexArrayAttribBinding(m.positionVertexArray, 0, 0);
+
+  createMeshBuffers(m, mesh);
+  m.materialId = mesh.materialId;
+
+  return m;
+}
+
+void createMeshBuffers(MeshGpu& meshGpu, const Mesh& mesh) {
+  meshGpu.numVertices = mesh.vertices.size();
+  meshGpu.vertexBuffer = createVertexBuffer(static_cast<uint32_t>(meshGpu.numVertices), sizeof(Vertex), meshGpu.vertexArray);
+  meshGpu.positionBuffer = createVertexBuffer(static_cast<uint32_t>(meshGpu.numVertices), sizeof(glm::vec3), meshGpu.positionVertexArray);
+
+  meshGpu.numIndices = mesh.indices.size();
+  meshGpu.indexBuffer = createIndexBuffer(static_cast<uint32_t>(meshGpu.numIndices), meshGpu.vertexArray, meshGpu.positionVertexArray);
+
+  std::vector<glm::vec3> positions(meshGpu.numVertices);
+  for (size_t vertIx = 0; vertIx < meshGpu.numVertices; ++vertIx)
+    positions[vertIx] = mesh.vertices[vertIx].position;
+  glNamedBufferSubData(meshGpu.vertexBuffer, 0, sizeof(Vertex) * meshGpu.numVertices, mesh.vertices.data());
+  glNamedBufferSubData(meshGpu.positionBuffer, 0, sizeof(glm::vec3) * meshGpu.numVertices, positions.data());
+  glNamedBufferSubData(meshGpu.indexBuffer, 0, sizeof(uint32_t) * meshGpu.numIndices, mesh.indices.data());
+}
+
+void destroyMeshBuffers(MeshGpu& meshGpu) {
+  // Deleted buffers are unbound from the vertex arrays automatically
+  trackedDeleteBuffers(1, &meshGpu.vertexBuffer);
+  trackedDeleteBuffers(1, &meshGpu.positionBuffer);
+  trackedDeleteBuffers(1, &meshGpu.indexBuffer);
+  meshGpu.vertexBuffer = meshGpu.positionBuffer = meshGpu.indexBuffer = 0;
+}
+
+void destroyMeshGpu(MeshGpu& meshGpu) {
+  destroyMeshBuffers(meshGpu);
+  glDeleteVertexArrays(1, &meshGpu.vertexArray);
+  glDeleteVertexArrays(1, &meshGpu.positionVertexArray);
+  meshGpu.vertexArray = meshGpu.positionVertexArray = 0;
+}
+
+Mesh processMesh(const aiMesh *mesh, [[maybe_unused]] const aiScene *scene) {
+  Mesh outMesh;
+  outMesh.vertices.reserve(mesh->mNumVertices);
+  for (uint32_t vertIx = 0; vertIx < mesh->mNumVertices; ++vertIx) {
+    Vertex& vertex = outMesh.vertices.emplace_back();
+    if (mesh->HasPositions()) {
+      vertex.position = {mesh->mVertices[vertIx].x, mesh->mVertices[vertIx].y, mesh->mVertices[vertIx].z};
+    } else {
+      vertex.position = {};
+    }
+    if (mesh->HasNormals()) {
+      vertex.normal = {mesh->mNormals[vertIx].x, mesh->mNormals[vertIx].y, mesh->mNormals[vertIx].z};
+    }
+    else {
+      vertex.normal = {};
+    }
+    if (mesh->mTextureCoords[0]) {
+      vertex.texCoord1 = {mesh->mTextureCoords[0][vertIx].x, mesh->mTextureCoords[0][vertIx].y};
+    } else {
+      vertex.texCoord1 = {};
+    }
+  }
+  outMesh.indices.reserve(mesh->mNumFaces * 3);
+  for (uint32_t i = 0; i < mesh->mNumFaces; ++i) {
+    const aiFace& face = mesh->mFaces[i];
+    assert(face.mNumIndices == 3);
+    for (uint32_t j = 0; j < face.mNumIndices; ++j) {
+      outMesh.indices.push_back(face.mIndices[j]);
+    }
+  }
+
+  outMesh.materialId = mesh->mMaterialIndex;
+  return outMesh;
+}
+
+void loadMeshesFromAiNode(const aiNode *node, const aiScene *scene, std::vector<Mesh>& outMeshes, JobSystem* jobs) {
+  std::vector<const aiMesh*> aiMeshes;
+  collectAiMeshes(node, scene, aiMeshes);
+  const size_t first = outMeshes.size();
+  outMeshes.resize(first + aiMeshes.size());
+  // Allocations on the workers are charged to the caller's tag
+  const MemoryTag tag = getMemoryTag();
+  parallelFor(jobs, static_cast<uint32_t>(aiMeshes.size()), 1, [&](uint32_t begin, uint32_t end) {
+    MemoryTagScope memoryTag(tag);
+    for (uint32_t ix = begin; ix < end; ++ix)
+      outMeshes[first + ix] = processMesh(aiMeshes[ix], scene);
+  });
+}
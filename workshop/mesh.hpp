@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct aiMesh;
+struct aiNode;
+struct aiScene;
+class JobSystem;
+
+struct Vertex {
+  glm::vec3 position;
+  glm::vec3 normal;
+  glm::vec2 texCoord1;
+};
+
+struct Mesh {
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  // Index into MaterialTable::materials
+  uint32_t materialId{};
+};
+
+struct MeshGpu {
+  GLuint vertexArray;
+  // Positions only, for depth passes. Fetches 12 bytes per vertex instead of sizeof(Vertex) and shares the index buffer.
+  GLuint positionVertexArray;
+  // 0 while evicted by the residency manager, the vertex arrays keep their format
+  GLuint vertexBuffer;
+  GLuint positionBuffer;
+  GLuint indexBuffer;
+  size_t numVertices;
+  size_t numIndices;
+  uint32_t materialId;
+};
+
+MeshGpu createMeshGpu(const Mesh& mesh);
+// (Re)create and fill the buffers of a MeshGpu whose vertex arrays already exist
+void createMeshBuffers(MeshGpu& meshGpu, const Mesh& mesh);
+void destroyMeshBuffers(MeshGpu& meshGpu);
+void destroyMeshGpu(MeshGpu& meshGpu);
+
+Mesh processMesh(const aiMesh* mesh, const aiScene* scene);
+// Appends the meshes of node and its descendants in depth first order. Meshes are converted in parallel when jobs is
+// not null.
+void loadMeshesFromAiNode(const aiNode* node, const aiScene* scene, std::vector<Mesh>& outMeshes, JobSystem* jobs = nullptr);
@@ -0,0 +1,245 @@
+#include "mip_generator.hpp"
+
+#include "cpu_features.hpp"
+#include "mip_generator_kernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+namespace {
+void filterRowHorizontalScalar(const float* in, float* out, const FilterTaps& taps, uint32_t outWidth) {
+  for (uint32_t x = 0; x < outWidth; ++x) {
+    const float* src = in + size_t{taps.first[x]} * 4;
+    const float* w = taps.weights.data() + size_t{x} * taps.numTaps;
+    float acc[4]{};
+    for (uint32_t k = 0; k < taps.numTaps; ++k)
+      for (uint32_t c = 0; c < 4; ++c)
+        acc[c] += w[k] * src[k * 4 + c];
+    for (uint32_t c = 0; c < 4; ++c)
+      out[size_t{x} * 4 + c] = acc[c];
+  }
+}
+
+void filterRowsVerticalScalar(const float* const* rows, const float* weights, uint32_t numTaps, float* out, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    float acc = 0.f;
+    for (uint32_t k = 0; k < numTaps; ++k)
+      acc += weights[k] * rows[k][i];
+    out[i] = acc;
+  }
+}
+
+float srgbToLinear(float v) {
+  return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float v) {
+  return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.f / 2.4f) - 0.055f;
+}
+
+struct ConversionTables {
+  std::array<float, 256> srgbToLinear;
+  std::array<float, 256> unormToFloat;
+  // Indexed by linear value quantized to 16 bits, fine enough to round-trip every 8-bit sRGB value
+  std::array<uint8_t, 65536> linearToSrgb;
+};
+
+const ConversionTables& getConversionTables() {
+  static const ConversionTables tables = [] {
+    ConversionTables t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      t.srgbToLinear[i] = srgbToLinear(static_cast<float>(i) / 255.f);
+      t.unormToFloat[i] = static_cast<float>(i) / 255.f;
+    }
+    for (uint32_t i = 0; i < 65536; ++i)
+      t.linearToSrgb[i] = static_cast<uint8_t>(std::lround(linearToSrgb(static_cast<float>(i) / 65535.f) * 255.f));
+    return t;
+  }();
+  return tables;
+}
+
+// Zeroth order modified Bessel function of the first kind
+double besselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (uint32_t k = 1; k < 32; ++k) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+  return sum;
+}
+
+// Filter evaluated in destination pixel units
+constexpr double kKaiserRadius = 3.0;
+constexpr double kKaiserAlpha = 4.0;
+
+double kaiser(double x) {
+  if (std::abs(x) >= kKaiserRadius)
+    return 0.0;
+  const double t = x / kKaiserRadius;
+  const double window = besselI0(kKaiserAlpha * std::sqrt(1.0 - t * t)) / besselI0(kKaiserAlpha);
+  const double sinc = x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+  return sinc * window;
+}
+
+FilterTaps computeFilterTaps(uint32_t srcSize, uint32_t dstSize, MipFilter filter) {
+  const double scale = static_cast<double>(srcSize) / dstSize;
+  const double support = (filter == MipFilter::Box ? 0.5 : kKaiserRadius) * scale;
+
+  FilterTaps taps;
+  taps.numTaps = std::min(srcSize, static_cast<uint32_t>(std::ceil(2.0 * support)) + 1);
+  taps.first.resize(dstSize);
+  taps.weights.assign(size_t{dstSize} * taps.numTaps, 0.f);
+  std::vector<double> weights(taps.numTaps);
+  for (uint32_t i = 0; i < dstSize; ++i) {
+    const double center = (i + 0.5) * scale;
+    const auto lo = static_cast<int64_t>(std::floor(center - support));
+    const auto hi = static_cast<int64_t>(std::ceil(center + support));
+    // Clamp-to-edge: samples outside the image fold onto the border pixels, which all land inside the window
+    const auto first = static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(lo, 0), srcSize - taps.numTaps));
+    std::ranges::fill(weights, 0.0);
+    double total = 0.0;
+    for (int64_t j = lo; j <= hi; ++j) {
+      double w{};
+      if (filter == MipFilter::Box) {
+        // Coverage of source pixel [j, j+1) by the destination pixel footprint
+        w = std::max(0.0, std::min<double>(j + 1, center + support) - std::max<double>(j, center - support));
+      } else {
+        w = kaiser((j + 0.5 - center) / scale);
+      }
+      if (w == 0.0)
+        continue;
+      const int64_t clamped = std::clamp<int64_t>(j, 0, srcSize - 1);
+      weights[static_cast<size_t>(clamped - first)] += w;
+      total += w;
+    }
+    taps.first[i] = first;
+    for (uint32_t k = 0; k < taps.numTaps; ++k)
+      taps.weights[size_t{i} * taps.numTaps + k] = static_cast<float>(weights[k] / total);
+  }
+  return taps;
+}
+
+bool isAlphaChannel(uint32_t channel, uint32_t numChannels) {
+  return (numChannels == 4 && channel == 3) || (numChannels == 2 && channel == 1);
+}
+
+bool isSrgbChannel(uint32_t channel, uint32_t numChannels, bool srgb) {
+  return srgb && !isAlphaChannel(channel, numChannels);
+}
+
+// 8-bit pixels with numChannels to RGBA float, missing channels are 0
+void decodeRow(const uint8_t* src, float* dst, uint32_t width, uint32_t numChannels, bool srgb) {
+  const ConversionTables& tables = getConversionTables();
+  const float* luts[4]{};
+  for (uint32_t c = 0; c < numChannels; ++c)
+    luts[c] = isSrgbChannel(c, numChannels, srgb) ? tables.srgbToLinear.data() : tables.unormToFloat.data();
+  if (numChannels == 4) {
+    for (uint32_t x = 0; x < width; ++x, src += 4, dst += 4) {
+      dst[0] = luts[0][src[0]];
+      dst[1] = luts[1][src[1]];
+      dst[2] = luts[2][src[2]];
+      dst[3] = luts[3][src[3]];
+    }
+    return;
+  }
+  for (uint32_t x = 0; x < width; ++x, src += numChannels, dst += 4) {
+    for (uint32_t c = 0; c < 4; ++c)
+      dst[c] = c < numChannels ? luts[c][src[c]] : 0.f;
+  }
+}
+
+void encodeRow(const float* src, uint8_t* dst, uint32_t width, uint32_t numChannels, bool srgb) {
+  const uint8_t* linearToSrgb = getConversionTables().linearToSrgb.data();
+  bool srgbChannels[4]{};
+  for (uint32_t c = 0; c < numChannels; ++c)
+    srgbChannels[c] = isSrgbChannel(c, numChannels, srgb);
+  for (uint32_t x = 0; x < width; ++x, src += 4, dst += numChannels) {
+    for (uint32_t c = 0; c < numChannels; ++c) {
+      // Kaiser has negative lobes, results can slightly overshoot
+      const float v = std::clamp(src[c], 0.f, 1.f);
+      dst[c] = srgbChannels[c] ? linearToSrgb[static_cast<uint32_t>(v * 65535.f + 0.5f)] : static_cast<uint8_t>(v * 255.f + 0.5f);
+    }
+  }
+}
+
+// Destination rows processed together by one task. Source rows under the vertical filter window are filtered
+// horizontally once per band.
+constexpr uint32_t kRowsPerBand = 32;
+
+void generateMipLevel(const uint8_t* src, const MipLevel& srcLevel, uint8_t* dst, const MipLevel& dstLevel, uint32_t numChannels, const MipGeneratorOptions& options, const MipKernels& kernels, JobSystem* jobs) {
+  const FilterTaps horizontal = computeFilterTaps(srcLevel.width, dstLevel.width, options.filter);
+  const FilterTaps vertical = computeFilterTaps(srcLevel.height, dstLevel.height, options.filter);
+  const size_t srcRowBytes = size_t{srcLevel.width} * numChannels;
+  const size_t dstRowBytes = size_t{dstLevel.width} * numChannels;
+  const uint32_t floatsPerDstRow = dstLevel.width * 4;
+
+  // Tiny levels are not worth waking up other threads
+  JobSystem* levelJobs = size_t{srcLevel.width} * srcLevel.height >= 256 * 256 ? jobs : nullptr;
+  parallelFor(levelJobs, dstLevel.height, kRowsPerBand, [&](uint32_t yBegin, uint32_t yEnd) {
+    const uint32_t srcRowBegin = vertical.first[yBegin];
+    const uint32_t srcRowEnd = vertical.first[yEnd - 1] + vertical.numTaps;
+    std::vector<float> decoded(size_t{srcLevel.width} * 4);
+    std::vector<float> filtered(size_t{srcRowEnd - srcRowBegin} * floatsPerDstRow);
+    for (uint32_t row = srcRowBegin; row < srcRowEnd; ++row) {
+      decodeRow(src + srcRowBytes * row, decoded.data(), srcLevel.width, numChannels, options.srgb);
+      kernels.filterRowHorizontal(decoded.data(), filtered.data() + size_t{row - srcRowBegin} * floatsPerDstRow, horizontal, dstLevel.width);
+    }
+
+    std::vector<const float*> rows(vertical.numTaps);
+    std::vector<float> out(floatsPerDstRow);
+    for (uint32_t y = yBegin; y < yEnd; ++y) {
+      for (uint32_t k = 0; k < vertical.numTaps; ++k)
+        rows[k] = filtered.data() + size_t{vertical.first[y] + k - srcRowBegin} * floatsPerDstRow;
+      kernels.filterRowsVertical(rows.data(), vertical.weights.data() + size_t{y} * vertical.numTaps, vertical.numTaps, out.data(), floatsPerDstRow);
+      encodeRow(out.data(), dst + dstRowBytes * y, dstLevel.width, numChannels, options.srgb);
+    }
+  });
+}
+}  // namespace
+
+const MipKernels& getMipKernelsScalar() {
+  static constexpr MipKernels kernels{filterRowHorizontalScalar, filterRowsVerticalScalar};
+  return kernels;
+}
+
+std::vector<MipLevel> computeMipChainLayout(uint32_t width, uint32_t height, uint32_t numChannels) {
+  std::vector<MipLevel> levels;
+  size_t offset = 0;
+  while (true) {
+    levels.push_back({width, height, offset});
+    offset += size_t{width} * height * numChannels;
+    if (width == 1 && height == 1)
+      break;
+    width = std::max(1u, width / 2);
+    height = std::max(1u, height / 2);
+  }
+  return levels;
+}
+
+size_t computeMipChainSize(std::span<const MipLevel> levels, uint32_t numChannels) {
+  if (levels.empty())
+    return 0;
+  const MipLevel& last = levels.back();
+  return last.offset + size_t{last.width} * last.height * numChannels;
+}
+
+bool usesSimdMipKernels(const MipGeneratorOptions& options) {
+  return options.allowSimd && getCpuFeatures().avx2 && getCpuFeatures().fma;
+}
+
+void generateMipChain(std::span<std::byte> data, std::span<const MipLevel> levels, uint32_t numChannels, const MipGeneratorOptions& options, JobSystem* jobs) {
+  assert(data.size() >= computeMipChainSize(levels, numChannels));
+  const MipKernels& kernels = usesSimdMipKernels(options) ? getMipKernelsAvx2() : getMipKernelsScalar();
+  auto* bytes = reinterpret_cast<uint8_t*>(data.data());
+  for (size_t levelIx = 1; levelIx < levels.size(); ++levelIx) {
+    const MipLevel& srcLevel = levels[levelIx - 1];
+    const MipLevel& dstLevel = levels[levelIx];
+    generateMipLevel(bytes + srcLevel.offset, srcLevel, bytes + dstLevel.offset, dstLevel, numChannels, options, kernels, jobs);
+  }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "job_system.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct MipLevel {
+  uint32_t width{};
+  uint32_t height{};
+  // in bytes, from the beginning of the mip chain
+  size_t offset{};
+};
+
+enum class MipFilter : uint8_t {
+  // Area-weighted average of the covered source pixels
+  Box,
+  // Kaiser-windowed sinc, sharper than box without visible ringing
+  Kaiser,
+};
+
+struct MipGeneratorOptions {
+  MipFilter filter{MipFilter::Kaiser};
+  // Color channels are sRGB encoded and filtered in linear space. Alpha (4th of RGBA, 2nd of gray-alpha) is always linear.
+  bool srgb{true};
+  // Use AVX2 kernels when the CPU supports them
+  bool allowSimd{true};
+};
+
+// Levels of 8-bit per channel images tightly packed one after another, down to 1x1. Works for non-power-of-two sizes,
+// each level is half of the previous one rounded down.
+std::vector<MipLevel> computeMipChainLayout(uint32_t width, uint32_t height, uint32_t numChannels);
+size_t computeMipChainSize(std::span<const MipLevel> levels, uint32_t numChannels);
+
+// Whether generateMipChain runs the AVX2 kernels. They round differently from the scalar ones, so levels can differ.
+bool usesSimdMipKernels(const MipGeneratorOptions& options);
+// Fill levels [1, N) of data, level 0 has to be there already. Each level is computed from the previous one.
+// Rows of a level are split across the job system, which can be null.
+void generateMipChain(std::span<std::byte> data, std::span<const MipLevel> levels, uint32_t numChannels, const MipGeneratorOptions& options, JobSystem* jobs);
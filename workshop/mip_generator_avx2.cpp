@@ -0,0 +1,69 @@
+// Compiled with AVX2 and FMA enabled on x64. Only called after getCpuFeatures() confirmed support.
+#include "mip_generator_kernels.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+
+namespace {
+void filterRowHorizontalAvx2(const float* in, float* out, const FilterTaps& taps, uint32_t outWidth) {
+  const uint32_t numTaps = taps.numTaps;
+  const uint32_t numPairs = numTaps / 2;
+  for (uint32_t x = 0; x < outWidth; ++x) {
+    const float* src = in + size_t{taps.first[x]} * 4;
+    const float* w = taps.weights.data() + size_t{x} * numTaps;
+    // Two neighboring RGBA pixels per 256-bit register
+    __m256 acc = _mm256_setzero_ps();
+    for (uint32_t pair = 0; pair < numPairs; ++pair) {
+      const __m256 weights = _mm256_set_m128(_mm_set1_ps(w[2 * pair + 1]), _mm_set1_ps(w[2 * pair]));
+      acc = _mm256_fmadd_ps(weights, _mm256_loadu_ps(src + 8 * pair), acc);
+    }
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    if (numTaps % 2 != 0)
+      sum = _mm_fmadd_ps(_mm_set1_ps(w[numTaps - 1]), _mm_loadu_ps(src + size_t{numTaps - 1} * 4), sum);
+    _mm_storeu_ps(out + size_t{x} * 4, sum);
+  }
+}
+
+void filterRowsVerticalAvx2(const float* const* rows, const float* weights, uint32_t numTaps, float* out, uint32_t count) {
+  uint32_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    // 4 independent accumulators to hide FMA latency
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps(), acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+    for (uint32_t k = 0; k < numTaps; ++k) {
+      const __m256 w = _mm256_set1_ps(weights[k]);
+      const float* row = rows[k] + i;
+      acc0 = _mm256_fmadd_ps(w, _mm256_loadu_ps(row), acc0);
+      acc1 = _mm256_fmadd_ps(w, _mm256_loadu_ps(row + 8), acc1);
+      acc2 = _mm256_fmadd_ps(w, _mm256_loadu_ps(row + 16), acc2);
+      acc3 = _mm256_fmadd_ps(w, _mm256_loadu_ps(row + 24), acc3);
+    }
+    _mm256_storeu_ps(out + i, acc0);
+    _mm256_storeu_ps(out + i + 8, acc1);
+    _mm256_storeu_ps(out + i + 16, acc2);
+    _mm256_storeu_ps(out + i + 24, acc3);
+  }
+  for (; i + 8 <= count; i += 8) {
+    __m256 acc = _mm256_setzero_ps();
+    for (uint32_t k = 0; k < numTaps; ++k)
+      acc = _mm256_fmadd_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(rows[k] + i), acc);
+    _mm256_storeu_ps(out + i, acc);
+  }
+  for (; i < count; ++i) {
+    float acc = 0.f;
+    for (uint32_t k = 0; k < numTaps; ++k)
+      acc += weights[k] * rows[k][i];
+    out[i] = acc;
+  }
+}
+}  // namespace
+
+const MipKernels& getMipKernelsAvx2() {
+  static constexpr MipKernels kernels{filterRowHorizontalAvx2, filterRowsVerticalAvx2};
+  return kernels;
+}
+#else
+// Other architectures get no AVX flags, and the CPU check never selects these
+const MipKernels& getMipKernelsAvx2() {
+  return getMipKernelsScalar();
+}
+#endif
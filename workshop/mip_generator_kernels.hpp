@@ -0,0 +1,24 @@
+#pragma once
+
+// Internal to mip_generator*.cpp. Kernels live in separate translation units per instruction set so that only the
+// dispatched one executes instructions the CPU may not have.
+
+#include <cstdint>
+#include <vector>
+
+// 1D resampling weights. Output i reads input samples [first[i], first[i] + numTaps), same numTaps for all outputs.
+struct FilterTaps {
+  uint32_t numTaps{};
+  std::vector<uint32_t> first;
+  std::vector<float> weights;
+};
+
+struct MipKernels {
+  // Resample a row of RGBA float pixels: out[x] = sum_k weights[x][k] * in[first[x] + k]
+  void (*filterRowHorizontal)(const float* in, float* out, const FilterTaps& taps, uint32_t outWidth);
+  // Weighted sum of rows: out[i] = sum_k weights[k] * rows[k][i] for i in [0, count)
+  void (*filterRowsVertical)(const float* const* rows, const float* weights, uint32_t numTaps, float* out, uint32_t count);
+};
+
+const MipKernels& getMipKernelsScalar();
+const MipKernels& getMipKernelsAvx2();
@@ -0,0 +1,13 @@
+#include "asset_pack.hpp"
+
+#include <print>
+
+// Usage: PackAssets <output pack file> <input directory> <extension>
+// e.g. PackAssets assets/shaders/shaders.pack assets/shaders .spv
+int main(int argc, char* argv[]) {
+  if (argc != 4) {
+    std::println("Usage: {} <output pack file> <input directory> <extension>", argv[0]);
+    return 1;
+  }
+  return writeAssetPack(argv[1], argv[2], argv[3]) ? 0 : 1;
+}
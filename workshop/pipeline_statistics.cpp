@@ -0,0 +1,237 @@
+#include "pipeline_statistics.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <format>
+#include <print>
+
+namespace {
+constexpr std::array<GLenum, kNumPipelineStatistics> kQueryTargets = {
+    GL_VERTICES_SUBMITTED,
+    GL_PRIMITIVES_SUBMITTED,
+    GL_VERTEX_SHADER_INVOCATIONS,
+    GL_CLIPPING_INPUT_PRIMITIVES,
+    GL_CLIPPING_OUTPUT_PRIMITIVES,
+    GL_FRAGMENT_SHADER_INVOCATIONS,
+    GL_COMPUTE_SHADER_INVOCATIONS,
+};
+
+GLuint allocateQuery(PipelineStatistics& stats, size_t statisticIx) {
+  std::vector<GLuint>& pool = stats.freeQueries[statisticIx];
+  if (pool.empty()) {
+    std::array<GLuint, 8> queries{};
+    glCreateQueries(kQueryTargets[statisticIx], static_cast<GLsizei>(queries.size()), queries.data());
+    pool.insert(pool.end(), queries.begin(), queries.end());
+  }
+  const GLuint query = pool.back();
+  pool.pop_back();
+  return query;
+}
+
+void resolveFrame(PipelineStatistics& stats, PipelineStatisticsFrame& frame) {
+  // Passes that run several times in a frame are summed up
+  std::vector<PipelineStatisticValues> frameValues(stats.passes.size(), PipelineStatisticValues{});
+  std::vector<bool> ran(stats.passes.size());
+  for (const PendingPipelineStatistics& pending : frame.passes) {
+    for (size_t statisticIx = 0; statisticIx < kNumPipelineStatistics; ++statisticIx) {
+      GLuint64 value{};
+      glGetQueryObjectui64v(pending.queries[statisticIx], GL_QUERY_RESULT, &value);
+      frameValues[pending.passIx][statisticIx] += value;
+      stats.freeQueries[statisticIx].push_back(pending.queries[statisticIx]);
+    }
+    ran[pending.passIx] = true;
+  }
+  for (size_t passIx = 0; passIx < stats.passes.size(); ++passIx) {
+    if (!ran[passIx])
+      continue;
+    PipelineStatisticsPass& pass = stats.passes[passIx];
+    pass.values = frameValues[passIx];
+    for (size_t statisticIx = 0; statisticIx < kNumPipelineStatistics; ++statisticIx)
+      pass.sums[statisticIx] += static_cast<double>(pass.values[statisticIx]);
+    ++pass.numSamples;
+  }
+  frame.passes.clear();
+  frame.recorded = false;
+}
+
+double getRatio(uint64_t numerator, uint64_t denominator) {
+  return denominator == 0 ? 0.0 : static_cast<double>(numerator) / static_cast<double>(denominator);
+}
+}  // namespace
+
+const char* getPipelineStatisticName(PipelineStatistic statistic) {
+  switch (statistic) {
+    case PipelineStatistic::VerticesSubmitted:
+      return "Vertices submitted";
+    case PipelineStatistic::PrimitivesSubmitted:
+      return "Primitives submitted";
+    case PipelineStatistic::VertexShaderInvocations:
+      return "VS invocations";
+    case PipelineStatistic::ClippingInputPrimitives:
+      return "Clipping input primitives";
+    case PipelineStatistic::ClippingOutputPrimitives:
+      return "Clipping output primitives";
+    case PipelineStatistic::FragmentShaderInvocations:
+      return "FS invocations";
+    case PipelineStatistic::ComputeShaderInvocations:
+      return "CS invocations";
+    case PipelineStatistic::Count:
+      break;
+  }
+  return "?";
+}
+
+void initPipelineStatistics(PipelineStatistics& stats) {
+  stats.supported = GLAD_GL_ARB_pipeline_statistics_query != 0 || GLAD_GL_VERSION_4_6 != 0;
+  if (!stats.supported)
+    std::println("Pipeline statistics queries are not supported");
+}
+
+void beginPipelineStatisticsFrame(PipelineStatistics& stats) {
+  stats.recording = false;
+  if (!stats.supported || !stats.enabled)
+    return;
+  PipelineStatisticsFrame& frame = stats.frames[stats.frame % kPipelineStatisticsLatency];
+  if (frame.recorded) {
+    // Results become available in submission order
+    if (!frame.passes.empty()) {
+      GLuint available{};
+      glGetQueryObjectuiv(frame.passes.back().queries.back(), GL_QUERY_RESULT_AVAILABLE, &available);
+      if (available == 0)
+        return;
+    }
+    resolveFrame(stats, frame);
+  }
+  stats.recording = true;
+}
+
+void endPipelineStatisticsFrame(PipelineStatistics& stats) {
+  if (!stats.recording)
+    return;
+  endPipelineStatisticsPass(stats);
+  stats.frames[stats.frame % kPipelineStatisticsLatency].recorded = true;
+  stats.recording = false;
+  ++stats.frame;
+}
+
+void beginPipelineStatisticsPass(PipelineStatistics& stats, const char* name) {
+  if (!stats.recording)
+    return;
+  if (stats.passOpen) {
+    std::println("Pipeline statistics pass '{}' started inside another pass, passes cannot nest", name);
+    return;
+  }
+  const auto [it, inserted] = stats.passIxByName.try_emplace(name, static_cast<uint32_t>(stats.passes.size()));
+  if (inserted)
+    stats.passes.emplace_back().name = name;
+  PendingPipelineStatistics& pending = stats.frames[stats.frame % kPipelineStatisticsLatency].passes.emplace_back();
+  pending.passIx = it->second;
+  for (size_t statisticIx = 0; statisticIx < kNumPipelineStatistics; ++statisticIx) {
+    pending.queries[statisticIx] = allocateQuery(stats, statisticIx);
+    glBeginQuery(kQueryTargets[statisticIx], pending.queries[statisticIx]);
+  }
+  stats.passOpen = true;
+}
+
+void endPipelineStatisticsPass(PipelineStatistics& stats) {
+  if (!stats.recording || !stats.passOpen)
+    return;
+  for (const GLenum target : kQueryTargets)
+    glEndQuery(target);
+  stats.passOpen = false;
+}
+
+void flushPipelineStatistics(PipelineStatistics& stats) {
+  // The slot recorded into next holds the oldest frame
+  for (uint32_t frameIx = 0; frameIx < kPipelineStatisticsLatency; ++frameIx) {
+    PipelineStatisticsFrame& frame = stats.frames[(stats.frame + frameIx) % kPipelineStatisticsLatency];
+    if (frame.recorded)
+      resolveFrame(stats, frame);
+  }
+}
+
+void resetPipelineStatistics(PipelineStatistics& stats) {
+  for (PipelineStatisticsPass& pass : stats.passes) {
+    pass.sums = {};
+    pass.numSamples = 0;
+  }
+}
+
+void destroyPipelineStatistics(PipelineStatistics& stats) {
+  for (PipelineStatisticsFrame& frame : stats.frames) {
+    for (const PendingPipelineStatistics& pending : frame.passes)
+      glDeleteQueries(static_cast<GLsizei>(pending.queries.size()), pending.queries.data());
+    frame.passes.clear();
+    frame.recorded = false;
+  }
+  for (std::vector<GLuint>& pool : stats.freeQueries) {
+    glDeleteQueries(static_cast<GLsizei>(pool.size()), pool.data());
+    pool.clear();
+  }
+  stats.passes.clear();
+  stats.passIxByName.clear();
+}
+
+void printPipelineStatistics(const PipelineStatistics& stats) {
+  for (const PipelineStatisticsPass& pass : stats.passes) {
+    if (pass.numSamples == 0)
+      continue;
+    std::string line;
+    for (size_t statisticIx = 0; statisticIx < kNumPipelineStatistics; ++statisticIx)
+      line += std::format("{}{}: {:.0f}", statisticIx == 0 ? "" : ", ", getPipelineStatisticName(static_cast<PipelineStatistic>(statisticIx)), pass.sums[statisticIx] / static_cast<double>(pass.numSamples));
+    std::println("Pipeline statistics of '{}', average of {} frames: {}", pass.name, pass.numSamples, line);
+  }
+}
+
+void drawPipelineStatisticsWindow(PipelineStatistics& stats) {
+  ImGui::Begin("Pipeline statistics");
+  if (!stats.supported) {
+    ImGui::TextUnformatted("Not supported by this driver");
+    ImGui::End();
+    return;
+  }
+  ImGui::Checkbox("Enabled", &stats.enabled);
+
+  constexpr ImGuiTableFlags kTableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit;
+  if (ImGui::BeginTable("Passes", static_cast<int>(stats.passes.size()) + 1, kTableFlags)) {
+    ImGui::TableSetupColumn("Latest frame");
+    for (const PipelineStatisticsPass& pass : stats.passes)
+      ImGui::TableSetupColumn(pass.name.c_str());
+    ImGui::TableHeadersRow();
+    for (size_t statisticIx = 0; statisticIx < kNumPipelineStatistics; ++statisticIx) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(getPipelineStatisticName(static_cast<PipelineStatistic>(statisticIx)));
+      for (const PipelineStatisticsPass& pass : stats.passes) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(pass.values[statisticIx]));
+      }
+    }
+    // Below 1 when the post-transform cache reuses vertices, 1 without any reuse
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted("VS invocations per vertex");
+    for (const PipelineStatisticsPass& pass : stats.passes) {
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", getRatio(pass.values[static_cast<size_t>(PipelineStatistic::VertexShaderInvocations)], pass.values[static_cast<size_t>(PipelineStatistic::VerticesSubmitted)]));
+    }
+    // Primitives surviving clipping and view frustum culling, can exceed 1 when clipping splits them
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted("Clipping output / input");
+    for (const PipelineStatisticsPass& pass : stats.passes) {
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", getRatio(pass.values[static_cast<size_t>(PipelineStatistic::ClippingOutputPrimitives)], pass.values[static_cast<size_t>(PipelineStatistic::ClippingInputPrimitives)]));
+    }
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted("FS invocations per primitive");
+    for (const PipelineStatisticsPass& pass : stats.passes) {
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", getRatio(pass.values[static_cast<size_t>(PipelineStatistic::FragmentShaderInvocations)], pass.values[static_cast<size_t>(PipelineStatistic::ClippingOutputPrimitives)]));
+    }
+    ImGui::EndTable();
+  }
+  ImGui::End();
+}
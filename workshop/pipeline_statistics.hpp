@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class PipelineStatistic : uint8_t {
+  VerticesSubmitted,
+  PrimitivesSubmitted,
+  VertexShaderInvocations,
+  ClippingInputPrimitives,
+  ClippingOutputPrimitives,
+  FragmentShaderInvocations,
+  ComputeShaderInvocations,
+  Count,
+};
+constexpr size_t kNumPipelineStatistics = static_cast<size_t>(PipelineStatistic::Count);
+// Same reasoning as kGpuProfilerLatency
+constexpr uint32_t kPipelineStatisticsLatency = 4;
+
+const char* getPipelineStatisticName(PipelineStatistic statistic);
+
+using PipelineStatisticValues = std::array<uint64_t, kNumPipelineStatistics>;
+
+struct PipelineStatisticsPass {
+  std::string name;
+  // Of the latest resolved frame the pass ran in
+  PipelineStatisticValues values{};
+  // Sums over all resolved frames, for averages
+  std::array<double, kNumPipelineStatistics> sums{};
+  uint64_t numSamples{};
+};
+
+struct PendingPipelineStatistics {
+  uint32_t passIx{};
+  std::array<GLuint, kNumPipelineStatistics> queries{};
+};
+
+struct PipelineStatisticsFrame {
+  std::vector<PendingPipelineStatistics> passes;
+  bool recorded{};
+};
+
+// ARB_pipeline_statistics_query counters per named pass. Passes cannot nest, each counter has a single active query.
+// Results are read back kPipelineStatisticsLatency frames later, frames whose results are still pending are skipped.
+struct PipelineStatistics {
+  bool supported{};
+  bool enabled{true};
+  std::array<PipelineStatisticsFrame, kPipelineStatisticsLatency> frames;
+  uint64_t frame{};
+  bool recording{};
+  bool passOpen{};
+  // Queries are created for a target, so there is a pool per counter
+  std::array<std::vector<GLuint>, kNumPipelineStatistics> freeQueries;
+  std::vector<PipelineStatisticsPass> passes;
+  std::unordered_map<std::string, uint32_t> passIxByName;
+};
+
+void initPipelineStatistics(PipelineStatistics& stats);
+void beginPipelineStatisticsFrame(PipelineStatistics& stats);
+void endPipelineStatisticsFrame(PipelineStatistics& stats);
+void beginPipelineStatisticsPass(PipelineStatistics& stats, const char* name);
+void endPipelineStatisticsPass(PipelineStatistics& stats);
+// Wait for and resolve every recorded frame
+void flushPipelineStatistics(PipelineStatistics& stats);
+// Restart the per pass averages, e.g. after a warmup
+void resetPipelineStatistics(PipelineStatistics& stats);
+void destroyPipelineStatistics(PipelineStatistics& stats);
+
+// Per pass averages over all resolved frames, one line per pass
+void printPipelineStatistics(const PipelineStatistics& stats);
+// Table of the latest values per pass, with vertex reuse and clipping ratios
+void drawPipelineStatisticsWindow(PipelineStatistics& stats);
@@ -0,0 +1,236 @@
+#include "post_process.hpp"
+
+#include "shader.hpp"
+
+#include <algorithm>
+
+namespace {
+constexpr uint32_t kComputeGroupSize = 8;
+
+RenderGraphTextureDesc getSingleSampledDesc(const RenderGraph& graph, uint32_t resource, GLenum internalFormat) {
+  RenderGraphTextureDesc desc = graph.resources[resource].textureDesc;
+  desc.internalFormat = internalFormat;
+  desc.samples = 1;
+  desc.levels = 1;
+  return desc;
+}
+
+// One thread per pixel of output
+void dispatchPerPixel(const RenderGraph& graph, GLuint pipeline, uint32_t output, GLenum outputFormat) {
+  const RenderGraphTextureDesc& desc = graph.resources[output].textureDesc;
+  glBindImageTexture(0, getRenderGraphTexture(graph, output), 0, GL_FALSE, 0, GL_WRITE_ONLY, outputFormat);
+  glBindProgramPipeline(pipeline);
+  glDispatchCompute((desc.width + kComputeGroupSize - 1) / kComputeGroupSize, (desc.height + kComputeGroupSize - 1) / kComputeGroupSize, 1);
+  glBindProgramPipeline(0);
+}
+
+uint32_t addFxaaPass(RenderGraph& graph, const PostProcessPipelines& pipelines, uint32_t color) {
+  const uint32_t output = createRenderGraphTexture(graph, "FXAA color", getSingleSampledDesc(graph, color, GL_RGBA8));
+  const uint32_t pass = addRenderGraphPass(graph, "FXAA", [pipeline = pipelines.fxaa, color, output](const RenderGraph& graph) {
+    glBindTextureUnit(0, getRenderGraphTexture(graph, color));
+    dispatchPerPixel(graph, pipeline, output, GL_RGBA8);
+  });
+  readRenderGraphResource(graph, pass, color, RenderGraphAccess::Sampled);
+  writeRenderGraphResource(graph, pass, output, RenderGraphAccess::StorageImage);
+  return output;
+}
+
+uint32_t addSmaaPasses(RenderGraph& graph, const PostProcessPipelines& pipelines, uint32_t color) {
+  const uint32_t edges = createRenderGraphTexture(graph, "SMAA edges", getSingleSampledDesc(graph, color, GL_RG8));
+  const uint32_t edgesPass = addRenderGraphPass(graph, "SMAA edges", [pipeline = pipelines.smaaEdges, color, edges](const RenderGraph& graph) {
+    glBindTextureUnit(0, getRenderGraphTexture(graph, color));
+    dispatchPerPixel(graph, pipeline, edges, GL_RG8);
+  });
+  readRenderGraphResource(graph, edgesPass, color, RenderGraphAccess::Sampled);
+  writeRenderGraphResource(graph, edgesPass, edges, RenderGraphAccess::StorageImage);
+
+  const uint32_t weights = createRenderGraphTexture(graph, "SMAA weights", getSingleSampledDesc(graph, color, GL_RGBA8));
+  const uint32_t weightsPass = addRenderGraphPass(graph, "SMAA weights", [pipeline = pipelines.smaaWeights, edges, weights](const RenderGraph& graph) {
+    glBindTextureUnit(0, getRenderGraphTexture(graph, edges));
+    dispatchPerPixel(graph, pipeline, weights, GL_RGBA8);
+  });
+  readRenderGraphResource(graph, weightsPass, edges, RenderGraphAccess::Sampled);
+  writeRenderGraphResource(graph, weightsPass, weights, RenderGraphAccess::StorageImage);
+
+  const uint32_t output = createRenderGraphTexture(graph, "SMAA color", getSingleSampledDesc(graph, color, GL_RGBA8));
+  const uint32_t blendPass = addRenderGraphPass(graph, "SMAA blend", [pipeline = pipelines.smaaBlend, color, weights, output](const RenderGraph& graph) {
+    glBindTextureUnit(0, getRenderGraphTexture(graph, color));
+    glBindTextureUnit(1, getRenderGraphTexture(graph, weights));
+    dispatchPerPixel(graph, pipeline, output, GL_RGBA8);
+  });
+  readRenderGraphResource(graph, blendPass, color, RenderGraphAccess::Sampled);
+  readRenderGraphResource(graph, blendPass, weights, RenderGraphAccess::Sampled);
+  writeRenderGraphResource(graph, blendPass, output, RenderGraphAccess::StorageImage);
+  return output;
+}
+}  // namespace
+
+const char* getPostAntiAliasingName(PostAntiAliasing mode) {
+  switch (mode) {
+    case PostAntiAliasing::None:
+      return "none";
+    case PostAntiAliasing::Fxaa:
+      return "fxaa";
+    case PostAntiAliasing::Smaa:
+      return "smaa";
+    case PostAntiAliasing::Count:
+      break;
+  }
+  return "unknown";
+}
+
+bool parsePostAntiAliasing(std::string_view name, PostAntiAliasing& mode) {
+  for (size_t modeIx = 0; modeIx < kNumPostAntiAliasingModes; ++modeIx) {
+    if (name == getPostAntiAliasingName(static_cast<PostAntiAliasing>(modeIx))) {
+      mode = static_cast<PostAntiAliasing>(modeIx);
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* getUpscalerName(Upscaler upscaler) {
+  switch (upscaler) {
+    case Upscaler::Bilinear:
+      return "bilinear";
+    case Upscaler::Fsr1:
+      return "fsr1";
+    case Upscaler::Count:
+      break;
+  }
+  return "unknown";
+}
+
+bool parseUpscaler(std::string_view name, Upscaler& upscaler) {
+  for (size_t upscalerIx = 0; upscalerIx < kNumUpscalers; ++upscalerIx) {
+    if (name == getUpscalerName(static_cast<Upscaler>(upscalerIx))) {
+      upscaler = static_cast<Upscaler>(upscalerIx);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool initPostProcessPipelines(PostProcessPipelines& pipelines, ProgramPipelineCache& cache, const AssetPack& shaderPack) {
+  const auto getComputePipeline = [&](std::string_view name) {
+    const GLuint program = getOrCreateStageProgram(cache, GL_COMPUTE_SHADER, shaderPack, name);
+    return program != 0 ? getOrCreateProgramPipeline(cache, {.compute = program}) : 0;
+  };
+  pipelines.fxaa = getComputePipeline("fxaa_comp.spv");
+  pipelines.smaaEdges = getComputePipeline("smaa_edges_comp.spv");
+  pipelines.smaaWeights = getComputePipeline("smaa_weights_comp.spv");
+  pipelines.smaaBlend = getComputePipeline("smaa_blend_comp.spv");
+  pipelines.easu = getComputePipeline("easu_comp.spv");
+  pipelines.rcas = getComputePipeline("rcas_comp.spv");
+  glCreateVertexArrays(1, &pipelines.emptyVertexArray);
+
+  const GLuint vertProgram = getOrCreateStageProgram(cache, GL_VERTEX_SHADER, shaderPack, "fullscreen_vert.spv");
+  const GLuint fragProgram = getOrCreateStageProgram(cache, GL_FRAGMENT_SHADER, shaderPack, "present_frag.spv");
+  if (vertProgram == 0 || fragProgram == 0)
+    return false;
+  pipelines.present = getOrCreateProgramPipeline(cache, {.vertex = vertProgram, .fragment = fragProgram});
+  return true;
+}
+
+void destroyPostProcessPipelines(PostProcessPipelines& pipelines) {
+  glDeleteVertexArrays(1, &pipelines.emptyVertexArray);
+  pipelines = {};
+}
+
+bool isPostAntiAliasingAvailable(const PostProcessPipelines& pipelines, PostAntiAliasing mode) {
+  switch (mode) {
+    case PostAntiAliasing::Fxaa:
+      return pipelines.fxaa != 0;
+    case PostAntiAliasing::Smaa:
+      return pipelines.smaaEdges != 0 && pipelines.smaaWeights != 0 && pipelines.smaaBlend != 0;
+    default:
+      return true;
+  }
+}
+
+bool isUpscalerAvailable(const PostProcessPipelines& pipelines, Upscaler upscaler) {
+  return upscaler != Upscaler::Fsr1 || (pipelines.easu != 0 && pipelines.rcas != 0);
+}
+
+uint32_t clampMsaaSamples(uint32_t requested) {
+  GLint maxColorSamples{};
+  GLint maxDepthSamples{};
+  glGetIntegerv(GL_MAX_COLOR_TEXTURE_SAMPLES, &maxColorSamples);
+  glGetIntegerv(GL_MAX_DEPTH_TEXTURE_SAMPLES, &maxDepthSamples);
+  const auto maxSamples = static_cast<uint32_t>(std::max(1, std::min(maxColorSamples, maxDepthSamples)));
+  uint32_t samples = 1;
+  while (samples * 2 <= std::min({requested, maxSamples, 8u}))
+    samples *= 2;
+  return samples;
+}
+
+uint32_t addMsaaResolvePass(RenderGraph& graph, uint32_t scenePass, uint32_t color) {
+  if (graph.resources[color].textureDesc.samples <= 1)
+    return color;
+  const RenderGraphTextureDesc desc = getSingleSampledDesc(graph, color, graph.resources[color].textureDesc.internalFormat);
+  const uint32_t resolved = createRenderGraphTexture(graph, "Resolved color", desc);
+  const uint32_t pass = addRenderGraphPass(graph, "MSAA resolve", [scenePass, desc](const RenderGraph& graph) {
+    // The pass's own framebuffer with the resolved color is bound for drawing
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, graph.passes[scenePass].framebuffer);
+    const auto width = static_cast<GLint>(desc.width);
+    const auto height = static_cast<GLint>(desc.height);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  });
+  readRenderGraphResource(graph, pass, color, RenderGraphAccess::BlitSource);
+  writeRenderGraphResource(graph, pass, resolved, RenderGraphAccess::ColorAttachment);
+  return resolved;
+}
+
+uint32_t addPostAntiAliasingPasses(RenderGraph& graph, const PostProcessPipelines& pipelines, PostAntiAliasing mode, uint32_t color) {
+  if (!isPostAntiAliasingAvailable(pipelines, mode))
+    return color;
+  switch (mode) {
+    case PostAntiAliasing::Fxaa:
+      return addFxaaPass(graph, pipelines, color);
+    case PostAntiAliasing::Smaa:
+      return addSmaaPasses(graph, pipelines, color);
+    default:
+      return color;
+  }
+}
+
+uint32_t addUpscalePasses(RenderGraph& graph, const PostProcessPipelines& pipelines, Upscaler upscaler, uint32_t color, uint32_t width, uint32_t height) {
+  const RenderGraphTextureDesc& colorDesc = graph.resources[color].textureDesc;
+  if (upscaler != Upscaler::Fsr1 || !isUpscalerAvailable(pipelines, upscaler) || (colorDesc.width == width && colorDesc.height == height))
+    return color;
+  RenderGraphTextureDesc desc = getSingleSampledDesc(graph, color, GL_RGBA8);
+  desc.width = width;
+  desc.height = height;
+
+  const uint32_t upscaled = createRenderGraphTexture(graph, "EASU color", desc);
+  const uint32_t easuPass = addRenderGraphPass(graph, "EASU", [pipeline = pipelines.easu, color, upscaled](const RenderGraph& graph) {
+    glBindTextureUnit(0, getRenderGraphTexture(graph, color));
+    dispatchPerPixel(graph, pipeline, upscaled, GL_RGBA8);
+  });
+  readRenderGraphResource(graph, easuPass, color, RenderGraphAccess::Sampled);
+  writeRenderGraphResource(graph, easuPass, upscaled, RenderGraphAccess::StorageImage);
+
+  const uint32_t output = createRenderGraphTexture(graph, "RCAS color", desc);
+  const uint32_t rcasPass = addRenderGraphPass(graph, "RCAS", [pipeline = pipelines.rcas, upscaled, output](const RenderGraph& graph) {
+    glBindTextureUnit(0, getRenderGraphTexture(graph, upscaled));
+    dispatchPerPixel(graph, pipeline, output, GL_RGBA8);
+  });
+  readRenderGraphResource(graph, rcasPass, upscaled, RenderGraphAccess::Sampled);
+  writeRenderGraphResource(graph, rcasPass, output, RenderGraphAccess::StorageImage);
+  return output;
+}
+
+void addPresentPass(RenderGraph& graph, const PostProcessPipelines& pipelines, uint32_t color, uint32_t target) {
+  const uint32_t pass = addRenderGraphPass(graph, "Present", [pipeline = pipelines.present, vertexArray = pipelines.emptyVertexArray, color](const RenderGraph& graph) {
+    glDisable(GL_DEPTH_TEST);
+    glBindTextureUnit(0, getRenderGraphTexture(graph, color));
+    glBindProgramPipeline(pipeline);
+    glBindVertexArray(vertexArray);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindProgramPipeline(0);
+    glEnable(GL_DEPTH_TEST);
+  });
+  readRenderGraphResource(graph, pass, color, RenderGraphAccess::Sampled);
+  writeRenderGraphResource(graph, pass, target, RenderGraphAccess::ColorAttachment);
+}
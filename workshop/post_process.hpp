@@ -0,0 +1,72 @@
+#pragma once
+
+#include "render_graph.hpp"
+
+#include <glad/gl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+struct AssetPack;
+struct ProgramPipelineCache;
+
+// Anti-aliasing on the resolved scene color, in compute passes. Cheaper than MSAA on fill rate, and combinable with it.
+enum class PostAntiAliasing : uint8_t {
+  None,
+  Fxaa,
+  // Edge detection, blending weights and neighborhood blending, without SMAA's precomputed area and search textures
+  Smaa,
+  Count,
+};
+constexpr size_t kNumPostAntiAliasingModes = static_cast<size_t>(PostAntiAliasing::Count);
+
+// "none", "fxaa" or "smaa"
+const char* getPostAntiAliasingName(PostAntiAliasing mode);
+bool parsePostAntiAliasing(std::string_view name, PostAntiAliasing& mode);
+
+// Filter from the scene resolution up to the output on the way to the backbuffer
+enum class Upscaler : uint8_t {
+  // By the present pass's sampler
+  Bilinear,
+  // Edge adaptive upsampling and contrast adaptive sharpening after FSR 1, in two compute passes
+  Fsr1,
+  Count,
+};
+constexpr size_t kNumUpscalers = static_cast<size_t>(Upscaler::Count);
+
+// "bilinear" or "fsr1"
+const char* getUpscalerName(Upscaler upscaler);
+bool parseUpscaler(std::string_view name, Upscaler& upscaler);
+
+// Program pipelines are owned by the cache. Zero for passes whose shaders are missing from the pack.
+struct PostProcessPipelines {
+  GLuint present{};
+  GLuint fxaa{};
+  GLuint smaaEdges{};
+  GLuint smaaWeights{};
+  GLuint smaaBlend{};
+  GLuint easu{};
+  GLuint rcas{};
+  // Bound for fullscreen triangles, which need no vertex buffers
+  GLuint emptyVertexArray{};
+};
+
+// False when the present pipeline could not be created, the other passes are optional
+bool initPostProcessPipelines(PostProcessPipelines& pipelines, ProgramPipelineCache& cache, const AssetPack& shaderPack);
+void destroyPostProcessPipelines(PostProcessPipelines& pipelines);
+bool isPostAntiAliasingAvailable(const PostProcessPipelines& pipelines, PostAntiAliasing mode);
+bool isUpscalerAvailable(const PostProcessPipelines& pipelines, Upscaler upscaler);
+// Largest of 1, 2, 4 and 8 samples that both color and depth textures support, at most requested
+uint32_t clampMsaaSamples(uint32_t requested);
+
+// Explicit resolve of a multisampled color, written as the first attachment of scenePass, into a single sampled
+// texture. Returns color itself when it has a single sample.
+uint32_t addMsaaResolvePass(RenderGraph& graph, uint32_t scenePass, uint32_t color);
+// Returns the anti-aliased copy of a single sampled color, or color itself for None and unavailable modes
+uint32_t addPostAntiAliasingPasses(RenderGraph& graph, const PostProcessPipelines& pipelines, PostAntiAliasing mode, uint32_t color);
+// Returns color scaled to width x height. Bilinear, unavailable upscalers and colors already at that size are left to
+// the present pass and return color itself.
+uint32_t addUpscalePasses(RenderGraph& graph, const PostProcessPipelines& pipelines, Upscaler upscaler, uint32_t color, uint32_t width, uint32_t height);
+// Draws color over all of target, which is written as a color attachment
+void addPresentPass(RenderGraph& graph, const PostProcessPipelines& pipelines, uint32_t color, uint32_t target);
@@ -0,0 +1,418 @@
+#include "render_graph.hpp"
+
+#include "cpu_profiler.hpp"
+#include "gpu_memory.hpp"
+#include "gpu_profiler.hpp"
+#include "pipeline_statistics.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <numeric>
+#include <print>
+
+namespace {
+bool isAttachment(RenderGraphAccess access) {
+  return access == RenderGraphAccess::ColorAttachment || access == RenderGraphAccess::DepthAttachment;
+}
+
+// Writes that other accesses only see after a glMemoryBarrier
+bool isIncoherentWrite(const RenderGraphUse& use) {
+  return use.write && (use.access == RenderGraphAccess::StorageImage || use.access == RenderGraphAccess::StorageBuffer);
+}
+
+GLbitfield getBarrierBit(RenderGraphAccess access, RenderGraphResourceKind kind) {
+  switch (access) {
+    case RenderGraphAccess::ColorAttachment:
+    case RenderGraphAccess::DepthAttachment:
+    case RenderGraphAccess::BlitSource:
+      return GL_FRAMEBUFFER_BARRIER_BIT;
+    case RenderGraphAccess::Sampled:
+      return GL_TEXTURE_FETCH_BARRIER_BIT;
+    case RenderGraphAccess::StorageImage:
+      return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+    case RenderGraphAccess::StorageBuffer:
+      return GL_SHADER_STORAGE_BARRIER_BIT;
+    case RenderGraphAccess::UniformBuffer:
+      return GL_UNIFORM_BARRIER_BIT;
+    case RenderGraphAccess::VertexBuffer:
+      return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+    case RenderGraphAccess::IndexBuffer:
+      return GL_ELEMENT_ARRAY_BARRIER_BIT;
+    case RenderGraphAccess::IndirectBuffer:
+      return GL_COMMAND_BARRIER_BIT;
+    case RenderGraphAccess::Copy:
+      return kind == RenderGraphResourceKind::Buffer ? GL_BUFFER_UPDATE_BARRIER_BIT : GL_TEXTURE_UPDATE_BARRIER_BIT;
+  }
+  return GL_ALL_BARRIER_BITS;
+}
+
+bool isDepthStencilFormat(GLenum internalFormat) {
+  return internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH32F_STENCIL8;
+}
+
+size_t computeTextureBytes(const RenderGraphTextureDesc& desc) {
+  return computeTextureStorageSize(desc.internalFormat, desc.width, desc.height, 1, desc.levels) * std::max(desc.samples, 1u);
+}
+
+GLuint createPooledTexture(const RenderGraphTextureDesc& desc) {
+  GLuint texture{};
+  const auto width = static_cast<GLsizei>(desc.width);
+  const auto height = static_cast<GLsizei>(desc.height);
+  if (desc.samples > 1) {
+    glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &texture);
+    trackedTextureStorage2DMultisample(GpuMemoryCategory::RenderTargets, texture, static_cast<GLsizei>(desc.samples), desc.internalFormat, width, height);
+    return texture;
+  }
+  glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+  trackedTextureStorage2D(GpuMemoryCategory::RenderTargets, texture, static_cast<GLsizei>(desc.levels), desc.internalFormat, width, height);
+  // Render targets are sampled at their own resolution or upscaled, never minified through missing levels
+  glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, desc.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  return texture;
+}
+
+// Pool object free before firstPass with a matching description, or a new one
+GLuint acquirePooledTexture(RenderGraphPool& pool, const RenderGraphResource& resource) {
+  for (RenderGraphPooledTexture& pooled : pool.textures) {
+    if (pooled.desc == resource.textureDesc && pooled.busyUntilPass < resource.firstPass) {
+      pooled.busyUntilPass = resource.lastPass;
+      pooled.lastUsedFrame = pool.frame;
+      return pooled.texture;
+    }
+  }
+  const RenderGraphPooledTexture& pooled = pool.textures.emplace_back(resource.textureDesc, createPooledTexture(resource.textureDesc), pool.frame, resource.lastPass);
+  return pooled.texture;
+}
+
+GLuint acquirePooledBuffer(RenderGraphPool& pool, const RenderGraphResource& resource) {
+  // Smallest free buffer that is large enough
+  RenderGraphPooledBuffer* best{};
+  for (RenderGraphPooledBuffer& pooled : pool.buffers) {
+    if (pooled.size >= resource.bufferSize && pooled.busyUntilPass < resource.firstPass && (best == nullptr || pooled.size < best->size))
+      best = &pooled;
+  }
+  if (best == nullptr) {
+    best = &pool.buffers.emplace_back(resource.bufferSize, 0, pool.frame, -1);
+    glCreateBuffers(1, &best->buffer);
+    trackedNamedBufferStorage(GpuMemoryCategory::StorageBuffers, best->buffer, static_cast<GLsizeiptr>(resource.bufferSize), nullptr, 0);
+  }
+  best->busyUntilPass = resource.lastPass;
+  best->lastUsedFrame = pool.frame;
+  return best->buffer;
+}
+
+GLuint acquireFramebuffer(RenderGraphPool& pool, const std::array<GLuint, kRenderGraphMaxColorAttachments>& colors, GLuint depth, GLenum depthFormat) {
+  for (RenderGraphFramebuffer& cached : pool.framebuffers) {
+    if (cached.colors == colors && cached.depth == depth) {
+      cached.lastUsedFrame = pool.frame;
+      return cached.framebuffer;
+    }
+  }
+  RenderGraphFramebuffer& cached = pool.framebuffers.emplace_back(colors, depth, 0, pool.frame);
+  glCreateFramebuffers(1, &cached.framebuffer);
+  std::array<GLenum, kRenderGraphMaxColorAttachments> drawBuffers{};
+  GLsizei numDrawBuffers = 0;
+  for (uint32_t ix = 0; ix < kRenderGraphMaxColorAttachments && colors[ix] != 0; ++ix) {
+    glNamedFramebufferTexture(cached.framebuffer, GL_COLOR_ATTACHMENT0 + ix, colors[ix], 0);
+    drawBuffers[ix] = GL_COLOR_ATTACHMENT0 + ix;
+    ++numDrawBuffers;
+  }
+  if (numDrawBuffers > 0)
+    glNamedFramebufferDrawBuffers(cached.framebuffer, numDrawBuffers, drawBuffers.data());
+  else
+    glNamedFramebufferDrawBuffer(cached.framebuffer, GL_NONE);
+  if (depth != 0)
+    glNamedFramebufferTexture(cached.framebuffer, isDepthStencilFormat(depthFormat) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, depth, 0);
+  if (glCheckNamedFramebufferStatus(cached.framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    std::println("Render graph framebuffer {} is incomplete", cached.framebuffer);
+  return cached.framebuffer;
+}
+
+uint32_t addResource(RenderGraph& graph, RenderGraphResource resource) {
+  graph.resources.push_back(resource);
+  return static_cast<uint32_t>(graph.resources.size() - 1);
+}
+
+void cullPasses(RenderGraph& graph) {
+  // Backwards, so a pass is live when a later live pass needs something it writes
+  std::vector<uint8_t> needed(graph.resources.size(), 0);
+  for (size_t passIx = graph.passes.size(); passIx-- > 0;) {
+    RenderGraphPass& pass = graph.passes[passIx];
+    bool live = pass.sideEffects;
+    for (const RenderGraphUse& use : pass.uses)
+      live |= use.write && (graph.resources[use.resource].imported || needed[use.resource] != 0);
+    pass.culled = !live;
+    if (!live) {
+      ++graph.numCulledPasses;
+      continue;
+    }
+    for (const RenderGraphUse& use : pass.uses) {
+      if (!use.write || isAttachment(use.access))
+        needed[use.resource] = 1;
+    }
+  }
+}
+
+void computeBarriers(RenderGraph& graph) {
+  // Bits issued since the last incoherent write of each resource, glMemoryBarrier covers every earlier write at once
+  std::vector<uint8_t> written(graph.resources.size(), 0);
+  std::vector<GLbitfield> issued(graph.resources.size(), 0);
+  for (RenderGraphPass& pass : graph.passes) {
+    if (pass.culled)
+      continue;
+    for (const RenderGraphUse& use : pass.uses) {
+      if (written[use.resource] != 0)
+        pass.barriers |= getBarrierBit(use.access, graph.resources[use.resource].kind) & ~issued[use.resource];
+    }
+    if (pass.barriers != 0) {
+      ++graph.numBarriers;
+      for (size_t resourceIx = 0; resourceIx < graph.resources.size(); ++resourceIx)
+        issued[resourceIx] |= pass.barriers;
+    }
+    for (const RenderGraphUse& use : pass.uses) {
+      if (isIncoherentWrite(use)) {
+        written[use.resource] = 1;
+        issued[use.resource] = 0;
+      }
+    }
+  }
+}
+
+void assignFramebuffers(RenderGraph& graph, RenderGraphPool& pool) {
+  for (RenderGraphPass& pass : graph.passes) {
+    if (pass.culled)
+      continue;
+    std::array<GLuint, kRenderGraphMaxColorAttachments> colors{};
+    uint32_t numColors = 0;
+    GLuint depth{};
+    GLenum depthFormat{};
+    for (const RenderGraphUse& use : pass.uses) {
+      if (!isAttachment(use.access))
+        continue;
+      const RenderGraphResource& resource = graph.resources[use.resource];
+      pass.hasAttachments = true;
+      if (resource.kind == RenderGraphResourceKind::Framebuffer) {
+        pass.framebuffer = resource.object;
+        pass.width = resource.textureDesc.width;
+        pass.height = resource.textureDesc.height;
+        break;
+      }
+      pass.width = resource.textureDesc.width;
+      pass.height = resource.textureDesc.height;
+      if (use.access == RenderGraphAccess::DepthAttachment) {
+        depth = resource.object;
+        depthFormat = resource.textureDesc.internalFormat;
+      } else if (numColors < kRenderGraphMaxColorAttachments) {
+        colors[numColors++] = resource.object;
+      }
+    }
+    if (pass.hasAttachments && (numColors > 0 || depth != 0))
+      pass.framebuffer = acquireFramebuffer(pool, colors, depth, depthFormat);
+  }
+}
+}  // namespace
+
+uint32_t createRenderGraphTexture(RenderGraph& graph, const char* name, const RenderGraphTextureDesc& desc) {
+  return addResource(graph, {.name = name, .kind = RenderGraphResourceKind::Texture, .textureDesc = desc});
+}
+
+uint32_t createRenderGraphBuffer(RenderGraph& graph, const char* name, size_t size) {
+  return addResource(graph, {.name = name, .kind = RenderGraphResourceKind::Buffer, .bufferSize = size});
+}
+
+uint32_t importRenderGraphTexture(RenderGraph& graph, const char* name, GLuint texture, const RenderGraphTextureDesc& desc) {
+  return addResource(graph, {.name = name, .kind = RenderGraphResourceKind::Texture, .imported = true, .textureDesc = desc, .object = texture});
+}
+
+uint32_t importRenderGraphBuffer(RenderGraph& graph, const char* name, GLuint buffer, size_t size) {
+  return addResource(graph, {.name = name, .kind = RenderGraphResourceKind::Buffer, .imported = true, .bufferSize = size, .object = buffer});
+}
+
+uint32_t importRenderGraphFramebuffer(RenderGraph& graph, const char* name, GLuint framebuffer, uint32_t width, uint32_t height) {
+  return addResource(graph, {.name = name, .kind = RenderGraphResourceKind::Framebuffer, .imported = true, .textureDesc = {.width = width, .height = height}, .object = framebuffer});
+}
+
+uint32_t addRenderGraphPass(RenderGraph& graph, const char* name, RenderGraphExecuteFn execute) {
+  graph.passes.push_back({.name = name, .execute = std::move(execute)});
+  return static_cast<uint32_t>(graph.passes.size() - 1);
+}
+
+void readRenderGraphResource(RenderGraph& graph, uint32_t pass, uint32_t resource, RenderGraphAccess access) {
+  graph.passes[pass].uses.push_back({resource, access, false});
+}
+
+void writeRenderGraphResource(RenderGraph& graph, uint32_t pass, uint32_t resource, RenderGraphAccess access) {
+  graph.passes[pass].uses.push_back({resource, access, true});
+}
+
+void compileRenderGraph(RenderGraph& graph, RenderGraphPool& pool) {
+  CPU_PROFILE_ZONE("Compile render graph");
+  ++pool.frame;
+  for (RenderGraphPooledTexture& pooled : pool.textures)
+    pooled.busyUntilPass = -1;
+  for (RenderGraphPooledBuffer& pooled : pool.buffers)
+    pooled.busyUntilPass = -1;
+
+  cullPasses(graph);
+  for (size_t passIx = 0; passIx < graph.passes.size(); ++passIx) {
+    if (graph.passes[passIx].culled)
+      continue;
+    for (const RenderGraphUse& use : graph.passes[passIx].uses) {
+      RenderGraphResource& resource = graph.resources[use.resource];
+      if (resource.firstPass < 0)
+        resource.firstPass = static_cast<int32_t>(passIx);
+      resource.lastPass = static_cast<int32_t>(passIx);
+    }
+  }
+
+  // In order of first use, so a resource takes over the object of one that ended before it
+  std::vector<uint32_t> transients;
+  for (uint32_t resourceIx = 0; resourceIx < graph.resources.size(); ++resourceIx) {
+    const RenderGraphResource& resource = graph.resources[resourceIx];
+    if (!resource.imported && resource.firstPass >= 0)
+      transients.push_back(resourceIx);
+  }
+  std::ranges::stable_sort(transients, {}, [&graph](uint32_t resourceIx) { return graph.resources[resourceIx].firstPass; });
+  for (const uint32_t resourceIx : transients) {
+    RenderGraphResource& resource = graph.resources[resourceIx];
+    const bool texture = resource.kind == RenderGraphResourceKind::Texture;
+    resource.object = texture ? acquirePooledTexture(pool, resource) : acquirePooledBuffer(pool, resource);
+    graph.transientBytes += texture ? computeTextureBytes(resource.textureDesc) : resource.bufferSize;
+  }
+  graph.numTransientResources = static_cast<uint32_t>(transients.size());
+  for (const RenderGraphPooledTexture& pooled : pool.textures) {
+    if (pooled.busyUntilPass >= 0) {
+      ++graph.numPooledObjects;
+      graph.pooledBytes += computeTextureBytes(pooled.desc);
+    }
+  }
+  for (const RenderGraphPooledBuffer& pooled : pool.buffers) {
+    if (pooled.busyUntilPass >= 0) {
+      ++graph.numPooledObjects;
+      graph.pooledBytes += pooled.size;
+    }
+  }
+
+  computeBarriers(graph);
+  assignFramebuffers(graph, pool);
+}
+
+void executeRenderGraph(const RenderGraph& graph, GpuProfiler* gpuProfiler, PipelineStatistics* pipelineStatistics) {
+  for (const RenderGraphPass& pass : graph.passes) {
+    if (pass.culled)
+      continue;
+    beginCpuZone(pass.name);
+    if (gpuProfiler != nullptr)
+      beginGpuZone(*gpuProfiler, pass.name);
+    if (pipelineStatistics != nullptr)
+      beginPipelineStatisticsPass(*pipelineStatistics, pass.name);
+    if (pass.barriers != 0)
+      glMemoryBarrier(pass.barriers);
+    if (pass.hasAttachments) {
+      glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+      glViewport(0, 0, static_cast<GLsizei>(pass.width), static_cast<GLsizei>(pass.height));
+    }
+    pass.execute(graph);
+    if (pipelineStatistics != nullptr)
+      endPipelineStatisticsPass(*pipelineStatistics);
+    if (gpuProfiler != nullptr)
+      endGpuZone(*gpuProfiler);
+    endCpuZone();
+  }
+}
+
+GLuint getRenderGraphTexture(const RenderGraph& graph, uint32_t resource) {
+  return graph.resources[resource].object;
+}
+
+GLuint getRenderGraphBuffer(const RenderGraph& graph, uint32_t resource) {
+  return graph.resources[resource].object;
+}
+
+void trimRenderGraphPool(RenderGraphPool& pool) {
+  const auto isStale = [&pool](uint64_t lastUsedFrame) { return lastUsedFrame + kRenderGraphPoolFrames < pool.frame; };
+  // Framebuffers go with their attachments, which are only deleted once stale themselves
+  std::erase_if(pool.framebuffers, [&](RenderGraphFramebuffer& cached) {
+    const bool staleAttachment = std::ranges::any_of(pool.textures, [&](const RenderGraphPooledTexture& pooled) {
+      return isStale(pooled.lastUsedFrame) && (pooled.texture == cached.depth || std::ranges::find(cached.colors, pooled.texture) != cached.colors.end());
+    });
+    if (!staleAttachment && !isStale(cached.lastUsedFrame))
+      return false;
+    glDeleteFramebuffers(1, &cached.framebuffer);
+    return true;
+  });
+  std::erase_if(pool.textures, [&](RenderGraphPooledTexture& pooled) {
+    if (!isStale(pooled.lastUsedFrame))
+      return false;
+    trackedDeleteTextures(1, &pooled.texture);
+    return true;
+  });
+  std::erase_if(pool.buffers, [&](RenderGraphPooledBuffer& pooled) {
+    if (!isStale(pooled.lastUsedFrame))
+      return false;
+    trackedDeleteBuffers(1, &pooled.buffer);
+    return true;
+  });
+}
+
+void destroyRenderGraphPool(RenderGraphPool& pool) {
+  for (RenderGraphFramebuffer& cached : pool.framebuffers)
+    glDeleteFramebuffers(1, &cached.framebuffer);
+  for (RenderGraphPooledTexture& pooled : pool.textures)
+    trackedDeleteTextures(1, &pooled.texture);
+  for (RenderGraphPooledBuffer& pooled : pool.buffers)
+    trackedDeleteBuffers(1, &pooled.buffer);
+  pool = {};
+}
+
+void drawRenderGraphWindow(const RenderGraph& graph) {
+  ImGui::Begin("Render graph");
+  ImGui::Text("%zu passes, %u culled, %u barriers", graph.passes.size(), graph.numCulledPasses, graph.numBarriers);
+  ImGui::Text("%u transient resources: %.2f MiB, %.2f MiB in %u pool objects", graph.numTransientResources, graph.transientBytes / 1048576.0, graph.pooledBytes / 1048576.0, graph.numPooledObjects);
+  constexpr ImGuiTableFlags kTableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit;
+  ImGui::SeparatorText("Passes");
+  if (ImGui::BeginTable("Passes", 4, kTableFlags)) {
+    for (const char* column : {"Pass", "State", "Barrier bits", "Framebuffer"})
+      ImGui::TableSetupColumn(column);
+    ImGui::TableHeadersRow();
+    for (const RenderGraphPass& pass : graph.passes) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(pass.name);
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(pass.culled ? "culled" : "live");
+      ImGui::TableNextColumn();
+      ImGui::Text("0x%x", pass.barriers);
+      ImGui::TableNextColumn();
+      if (pass.hasAttachments)
+        ImGui::Text("%u (%ux%u)", pass.framebuffer, pass.width, pass.height);
+    }
+    ImGui::EndTable();
+  }
+  ImGui::SeparatorText("Resources");
+  if (ImGui::BeginTable("Resources", 4, kTableFlags)) {
+    for (const char* column : {"Resource", "Kind", "Passes", "Object"})
+      ImGui::TableSetupColumn(column);
+    ImGui::TableHeadersRow();
+    for (const RenderGraphResource& resource : graph.resources) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(resource.name);
+      ImGui::TableNextColumn();
+      static constexpr const char* kKindNames[] = {"texture", "buffer", "framebuffer"};
+      ImGui::Text("%s%s", resource.imported ? "imported " : "", kKindNames[static_cast<size_t>(resource.kind)]);
+      ImGui::TableNextColumn();
+      if (resource.firstPass >= 0)
+        ImGui::Text("%d-%d", resource.firstPass, resource.lastPass);
+      else
+        ImGui::TextUnformatted("unused");
+      ImGui::TableNextColumn();
+      ImGui::Text("%u", resource.object);
+    }
+    ImGui::EndTable();
+  }
+  ImGui::End();
+}
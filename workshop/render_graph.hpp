@@ -0,0 +1,161 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct GpuProfiler;
+struct PipelineStatistics;
+
+// How a pass uses a resource. Attachments make up the framebuffer of the pass, the rest decides the memory barriers
+// in front of it.
+enum class RenderGraphAccess : uint8_t {
+  ColorAttachment,
+  DepthAttachment,
+  Sampled,
+  StorageImage,
+  StorageBuffer,
+  UniformBuffer,
+  VertexBuffer,
+  IndexBuffer,
+  IndirectBuffer,
+  // glCopy*, glGet*, glClear*Data and friends
+  Copy,
+  // Read side of a glBlit*Framebuffer, through the framebuffer of the pass that wrote the texture
+  BlitSource,
+};
+
+enum class RenderGraphResourceKind : uint8_t {
+  Texture,
+  Buffer,
+  // Only as the single attachment of a pass, e.g. the default framebuffer
+  Framebuffer,
+};
+
+struct RenderGraphTextureDesc {
+  uint32_t width{};
+  uint32_t height{};
+  GLenum internalFormat{GL_RGBA8};
+  uint32_t levels{1};
+  // More than one makes a GL_TEXTURE_2D_MULTISAMPLE
+  uint32_t samples{1};
+  bool operator==(const RenderGraphTextureDesc&) const = default;
+};
+
+struct RenderGraphResource {
+  // String literal
+  const char* name{};
+  RenderGraphResourceKind kind{};
+  // Owned by the caller and kept after the frame, so passes writing them are never culled
+  bool imported{};
+  RenderGraphTextureDesc textureDesc;
+  size_t bufferSize{};
+  // Texture, buffer or framebuffer. Assigned by compileRenderGraph for transient resources.
+  GLuint object{};
+  // Live passes using the resource, set by compileRenderGraph
+  int32_t firstPass{-1};
+  int32_t lastPass{-1};
+};
+
+struct RenderGraphUse {
+  uint32_t resource;
+  RenderGraphAccess access;
+  bool write;
+};
+
+struct RenderGraph;
+using RenderGraphExecuteFn = std::function<void(const RenderGraph& graph)>;
+
+struct RenderGraphPass {
+  // String literal, also names the profiler zones of the pass
+  const char* name{};
+  std::vector<RenderGraphUse> uses;
+  RenderGraphExecuteFn execute;
+  // Kept even when nothing reads what it writes
+  bool sideEffects{};
+  // Set by compileRenderGraph
+  bool culled{};
+  GLbitfield barriers{};
+  // Bound before execute when the pass has attachments
+  bool hasAttachments{};
+  GLuint framebuffer{};
+  uint32_t width{};
+  uint32_t height{};
+};
+
+constexpr uint32_t kRenderGraphMaxColorAttachments = 4;
+
+struct RenderGraphPooledTexture {
+  RenderGraphTextureDesc desc;
+  GLuint texture{};
+  uint64_t lastUsedFrame{};
+  // Last pass of the current frame using it, for aliasing
+  int32_t busyUntilPass{-1};
+};
+
+struct RenderGraphPooledBuffer {
+  size_t size{};
+  GLuint buffer{};
+  uint64_t lastUsedFrame{};
+  int32_t busyUntilPass{-1};
+};
+
+struct RenderGraphFramebuffer {
+  std::array<GLuint, kRenderGraphMaxColorAttachments> colors{};
+  GLuint depth{};
+  GLuint framebuffer{};
+  uint64_t lastUsedFrame{};
+};
+
+// GL objects behind the transient resources, kept from frame to frame. Resources whose lifetimes do not overlap share
+// an object when their descriptions match, and objects not used for kRenderGraphPoolFrames frames are deleted.
+constexpr uint64_t kRenderGraphPoolFrames = 8;
+struct RenderGraphPool {
+  std::vector<RenderGraphPooledTexture> textures;
+  std::vector<RenderGraphPooledBuffer> buffers;
+  std::vector<RenderGraphFramebuffer> framebuffers;
+  uint64_t frame{};
+};
+
+// Passes in submission order with the resources they read and write. Built every frame, then compiled and executed.
+struct RenderGraph {
+  std::vector<RenderGraphResource> resources;
+  std::vector<RenderGraphPass> passes;
+
+  // Set by compileRenderGraph
+  uint32_t numCulledPasses{};
+  uint32_t numBarriers{};
+  uint32_t numTransientResources{};
+  uint32_t numPooledObjects{};
+  // Size of all transient resources, and of the pool objects backing them after aliasing
+  size_t transientBytes{};
+  size_t pooledBytes{};
+};
+
+uint32_t createRenderGraphTexture(RenderGraph& graph, const char* name, const RenderGraphTextureDesc& desc);
+uint32_t createRenderGraphBuffer(RenderGraph& graph, const char* name, size_t size);
+uint32_t importRenderGraphTexture(RenderGraph& graph, const char* name, GLuint texture, const RenderGraphTextureDesc& desc);
+uint32_t importRenderGraphBuffer(RenderGraph& graph, const char* name, GLuint buffer, size_t size);
+uint32_t importRenderGraphFramebuffer(RenderGraph& graph, const char* name, GLuint framebuffer, uint32_t width, uint32_t height);
+
+uint32_t addRenderGraphPass(RenderGraph& graph, const char* name, RenderGraphExecuteFn execute);
+void readRenderGraphResource(RenderGraph& graph, uint32_t pass, uint32_t resource, RenderGraphAccess access);
+// Attachments keep the previous contents unless the pass clears them, so they count as read as well
+void writeRenderGraphResource(RenderGraph& graph, uint32_t pass, uint32_t resource, RenderGraphAccess access);
+
+// Culls passes that contribute nothing to imported resources, assigns pool objects to the transient resources that
+// are left and works out the glMemoryBarrier bits each pass needs after incoherent shader writes before it
+void compileRenderGraph(RenderGraph& graph, RenderGraphPool& pool);
+// Runs the live passes in order, each in a CPU and GPU profiler zone and a pipeline statistics pass when given
+void executeRenderGraph(const RenderGraph& graph, GpuProfiler* gpuProfiler, PipelineStatistics* pipelineStatistics);
+GLuint getRenderGraphTexture(const RenderGraph& graph, uint32_t resource);
+GLuint getRenderGraphBuffer(const RenderGraph& graph, uint32_t resource);
+// Call after the frame's graph was executed
+void trimRenderGraphPool(RenderGraphPool& pool);
+void destroyRenderGraphPool(RenderGraphPool& pool);
+
+void drawRenderGraphWindow(const RenderGraph& graph);
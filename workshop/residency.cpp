@@ -0,0 +1,98 @@
+#include "residency.hpp"
+
+#include "cpu_profiler.hpp"
+#include "gpu_memory.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+struct EvictionCandidate {
+  uint64_t lastUsedFrame{};
+  // One of the two is set
+  MeshResidency* mesh{};
+  StreamedTexture* texture{};
+};
+
+bool isIdle(const ResidencyManager& manager, uint64_t lastUsedFrame) {
+  return manager.frame - lastUsedFrame >= manager.minIdleFrames;
+}
+
+size_t getMeshBufferBytes(const MeshGpu& meshGpu) {
+  return (sizeof(Vertex) + sizeof(glm::vec3)) * meshGpu.numVertices + sizeof(uint32_t) * meshGpu.numIndices;
+}
+}  // namespace
+
+uint32_t registerMesh(ResidencyManager& manager, const Mesh& mesh, MeshGpu& meshGpu) {
+  manager.meshes.push_back({&mesh, &meshGpu, manager.frame});
+  return static_cast<uint32_t>(manager.meshes.size() - 1);
+}
+
+void useMesh(ResidencyManager& manager, uint32_t meshHandle) {
+  MeshResidency& entry = manager.meshes[meshHandle];
+  entry.lastUsedFrame = manager.frame;
+  if (entry.gpu->vertexBuffer != 0)
+    return;
+  // Needed for this draw, so restored even when over budget. Something idle gets evicted instead.
+  createMeshBuffers(*entry.gpu, *entry.mesh);
+  ++manager.restoredMeshesThisFrame;
+}
+
+void useTexture(ResidencyManager& manager, const StreamedTexture& tex) {
+  // Textures are owned by the streamer, callers only get const references to keep them from modifying them
+  auto& mutableTex = const_cast<StreamedTexture&>(tex);
+  mutableTex.lastUsedFrame = manager.frame;
+  if (tex.state != TextureState::Ready || tex.restreaming || tex.firstResidentLevel == 0)
+    return;
+
+  // The resident levels are good enough to sample from until there is room for the full chain, which exists next to
+  // them until the upload completes
+  const size_t fullBytes = computeTextureStorageSize(tex.internalFormat, tex.width, tex.height, 1, static_cast<uint32_t>(tex.levels.size()));
+  if (getGpuMemoryTracker().totalBytes + fullBytes > manager.budgetBytes)
+    return;
+  restreamTexture(*manager.streamer, mutableTex);
+  ++manager.restreamedTexturesThisFrame;
+}
+
+void updateResidency(ResidencyManager& manager) {
+  CPU_PROFILE_ZONE("Update residency");
+  const GpuMemoryTracker& tracker = getGpuMemoryTracker();
+  manager.restoredMeshesLastFrame = std::exchange(manager.restoredMeshesThisFrame, 0);
+  manager.restreamedTexturesLastFrame = std::exchange(manager.restreamedTexturesThisFrame, 0);
+  manager.evictedMeshesLastFrame = 0;
+  manager.evictedTextureLevelsLastFrame = 0;
+  manager.evictedBytesLastFrame = 0;
+
+  if (tracker.totalBytes > manager.budgetBytes) {
+    std::vector<EvictionCandidate> candidates;
+    for (MeshResidency& entry : manager.meshes) {
+      if (entry.gpu->vertexBuffer != 0 && isIdle(manager, entry.lastUsedFrame))
+        candidates.push_back({entry.lastUsedFrame, &entry, nullptr});
+    }
+    if (manager.streamer != nullptr) {
+      for (const auto& tex : manager.streamer->textures) {
+        if (tex->state == TextureState::Ready && !tex->restreaming && tex->levels.size() - tex->firstResidentLevel > 1 && isIdle(manager, tex->lastUsedFrame))
+          candidates.push_back({tex->lastUsedFrame, nullptr, tex.get()});
+      }
+    }
+    std::ranges::stable_sort(candidates, {}, &EvictionCandidate::lastUsedFrame);
+
+    // At most one level per texture and frame, the largest level alone is about three quarters of a chain
+    for (const EvictionCandidate& candidate : candidates) {
+      if (tracker.totalBytes <= manager.budgetBytes)
+        break;
+      if (candidate.mesh != nullptr) {
+        manager.evictedBytesLastFrame += getMeshBufferBytes(*candidate.mesh->gpu);
+        destroyMeshBuffers(*candidate.mesh->gpu);
+        ++manager.evictedMeshesLastFrame;
+      } else if (const size_t freed = evictTextureLevels(*manager.streamer, *candidate.texture, 1); freed != 0) {
+        manager.evictedBytesLastFrame += freed;
+        ++manager.evictedTextureLevelsLastFrame;
+      }
+    }
+    manager.numEvictions += manager.evictedMeshesLastFrame + manager.evictedTextureLevelsLastFrame;
+  }
+  manager.overBudget = tracker.totalBytes > manager.budgetBytes;
+  recordCpuCounter("GPU memory bytes", static_cast<double>(tracker.totalBytes));
+  ++manager.frame;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "mesh.hpp"
+#include "texture_streamer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct MeshResidency {
+  const Mesh* mesh{};
+  MeshGpu* gpu{};
+  uint64_t lastUsedFrame{};
+};
+
+// Keeps the memory in GpuMemoryTracker under budgetBytes by evicting what was used least recently: buffers of meshes,
+// which are restored from their CPU copy right before their next draw, and the largest mip levels of streamed
+// textures, which are streamed back in when a texture is used again and there is room for it.
+struct ResidencyManager {
+  size_t budgetBytes{size_t{1} << 30};
+  // Anything used within this many frames is never evicted. A working set larger than the budget then stays over
+  // budget, instead of being evicted and restored every frame.
+  uint64_t minIdleFrames{8};
+  uint64_t frame{};
+  std::vector<MeshResidency> meshes;
+  TextureStreamer* streamer{};
+
+  uint32_t evictedMeshesLastFrame{};
+  uint32_t restoredMeshesLastFrame{};
+  uint32_t evictedTextureLevelsLastFrame{};
+  uint32_t restreamedTexturesLastFrame{};
+  size_t evictedBytesLastFrame{};
+  uint64_t numEvictions{};
+  bool overBudget{};
+  // Published as the *LastFrame stats by updateResidency
+  uint32_t restoredMeshesThisFrame{};
+  uint32_t restreamedTexturesThisFrame{};
+};
+
+// Mesh and its MeshGpu have to outlive the manager. Return the handle passed to useMesh.
+uint32_t registerMesh(ResidencyManager& manager, const Mesh& mesh, MeshGpu& meshGpu);
+// Call before drawing a mesh. Restores its buffers if they were evicted.
+void useMesh(ResidencyManager& manager, uint32_t meshHandle);
+// Call when a texture of manager.streamer is sampled. Streams evicted levels back in if the budget allows.
+void useTexture(ResidencyManager& manager, const StreamedTexture& tex);
+// Call once per frame on the GL thread, after the frame's draws were submitted
+void updateResidency(ResidencyManager& manager);
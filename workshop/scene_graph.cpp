@@ -0,0 +1,110 @@
+#include "scene_graph.hpp"
+
+#include "cpu_profiler.hpp"
+#include "matrix_batch.hpp"
+#include "job_system.hpp"
+
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+// Below this many nodes a task costs more than it saves
+constexpr size_t kMinNodesForParallelUpdate = 4096;
+
+uint32_t addAiNodeRecursive(SceneGraph& graph, int32_t parent, const aiNode* node, uint32_t& nextMesh, std::vector<SceneMeshInstance>& outInstances) { // NOLINT(*-no-recursion)
+  // Shear in the node transform is dropped
+  aiVector3D scale, translation;
+  aiQuaternion rotation;
+  node->mTransformation.Decompose(scale, rotation, translation);
+  const uint32_t nodeIx = addSceneNode(graph, parent, node->mName.C_Str(), {translation.x, translation.y, translation.z}, glm::quat{rotation.w, rotation.x, rotation.y, rotation.z}, {scale.x, scale.y, scale.z});
+  for (uint32_t meshIx = 0; meshIx < node->mNumMeshes; ++meshIx)
+    outInstances.push_back({.node = nodeIx, .mesh = nextMesh++});
+  for (uint32_t childIx = 0; childIx < node->mNumChildren; ++childIx)
+    addAiNodeRecursive(graph, static_cast<int32_t>(nodeIx), node->mChildren[childIx], nextMesh, outInstances);
+  return nodeIx;
+}
+}  // namespace
+
+uint32_t addSceneNode(SceneGraph& graph, int32_t parent, std::string name, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale) {
+  const auto nodeIx = static_cast<uint32_t>(graph.parents.size());
+  assert(parent == kNoParent || graph.subtreeEnds[static_cast<size_t>(parent)] == nodeIx);
+  // Ancestors' subtrees all end at the new node
+  for (int32_t ancestor = parent; ancestor != kNoParent; ancestor = graph.parents[static_cast<size_t>(ancestor)])
+    graph.subtreeEnds[static_cast<size_t>(ancestor)] = nodeIx + 1;
+  if (parent == kNoParent)
+    graph.roots.push_back(nodeIx);
+  graph.parents.push_back(parent);
+  graph.subtreeEnds.push_back(nodeIx + 1);
+  graph.names.push_back(std::move(name));
+  graph.translations.push_back(translation);
+  graph.rotations.push_back(rotation);
+  graph.scales.push_back(scale);
+  graph.localMatrices.emplace_back(1.f);
+  graph.worldMatrices.emplace_back(1.f);
+  graph.localDirty.push_back(1);
+  graph.worldChanged.push_back(0);
+  return nodeIx;
+}
+
+uint32_t addSceneNodesFromAiNode(SceneGraph& graph, int32_t parent, const aiNode* node, uint32_t firstMesh, std::vector<SceneMeshInstance>& outInstances) {
+  return addAiNodeRecursive(graph, parent, node, firstMesh, outInstances);
+}
+
+void setLocalTranslation(SceneGraph& graph, uint32_t node, const glm::vec3& translation) {
+  graph.translations[node] = translation;
+  graph.localDirty[node] = 1;
+}
+
+void setLocalRotation(SceneGraph& graph, uint32_t node, const glm::quat& rotation) {
+  graph.rotations[node] = rotation;
+  graph.localDirty[node] = 1;
+}
+
+void setLocalScale(SceneGraph& graph, uint32_t node, const glm::vec3& scale) {
+  graph.scales[node] = scale;
+  graph.localDirty[node] = 1;
+}
+
+void updateWorldMatrices(SceneGraph& graph, JobSystem* jobs) {
+  CPU_PROFILE_ZONE("Update world matrices");
+  const auto numRoots = static_cast<uint32_t>(graph.roots.size());
+  if (jobs == nullptr || graph.parents.size() < kMinNodesForParallelUpdate || numRoots < 2) {
+    updateWorldMatrices(graph, 0, static_cast<uint32_t>(graph.parents.size()));
+    return;
+  }
+  // Root subtrees are consecutive, so a range of roots is a range of nodes
+  const uint32_t grainSize = std::max(1u, numRoots / (4 * (jobs->numThreads() + 1)));
+  parallelFor(jobs, numRoots, grainSize, [&graph](uint32_t begin, uint32_t end) {
+    updateWorldMatrices(graph, graph.roots[begin], graph.subtreeEnds[graph.roots[end - 1]]);
+  });
+}
+
+void updateWorldMatrices(SceneGraph& graph, uint32_t begin, uint32_t end) {
+  uint32_t nodeIx = begin;
+  while (nodeIx < end) {
+    // Consecutive changed nodes go through the kernels as one batch, parents of a run precede it or are part of it
+    const uint32_t runBegin = nodeIx;
+    bool anyLocalDirty = false;
+    for (; nodeIx < end; ++nodeIx) {
+      const int32_t parent = graph.parents[nodeIx];
+      const bool parentChanged = parent != kNoParent && graph.worldChanged[static_cast<size_t>(parent)] != 0;
+      const bool changed = graph.localDirty[nodeIx] != 0 || parentChanged;
+      graph.worldChanged[nodeIx] = changed ? 1 : 0;
+      if (!changed)
+        break;
+      anyLocalDirty |= graph.localDirty[nodeIx] != 0;
+      graph.localDirty[nodeIx] = 0;
+    }
+    if (nodeIx > runBegin) {
+      // Runs that only moved with their parents keep their local matrices
+      if (anyLocalDirty)
+        composeTrsMatrices(&graph.translations[runBegin], &graph.rotations[runBegin], &graph.scales[runBegin], &graph.localMatrices[runBegin], nodeIx - runBegin);
+      multiplyByParents(graph.parents.data(), graph.localMatrices.data(), graph.worldMatrices.data(), runBegin, nodeIx);
+    }
+    // Skip the unchanged node that ended the run
+    if (nodeIx < end)
+      ++nodeIx;
+  }
+}
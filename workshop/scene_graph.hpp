@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct aiNode;
+class JobSystem;
+
+constexpr int32_t kNoParent = -1;
+
+// Node hierarchy flattened in depth first order, so parents precede their children and every subtree is a contiguous
+// range of nodes. Transforms are stored per component to keep the world matrix pass linear.
+struct SceneGraph {
+  std::vector<int32_t> parents;
+  // One past the last node of each node's subtree
+  std::vector<uint32_t> subtreeEnds;
+  std::vector<std::string> names;
+  std::vector<glm::vec3> translations;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> scales;
+  // Composed from the TRS arrays by updateWorldMatrices
+  std::vector<glm::mat4> localMatrices;
+  std::vector<glm::mat4> worldMatrices;
+  // Set by the setters below, cleared by updateWorldMatrices
+  std::vector<uint8_t> localDirty;
+  // World matrices recomputed by the last updateWorldMatrices, for uploading only what changed
+  std::vector<uint8_t> worldChanged;
+  // Nodes without a parent, their subtrees are consecutive and can be updated independently
+  std::vector<uint32_t> roots;
+};
+
+// A mesh drawn with the world matrix of a node
+struct SceneMeshInstance {
+  uint32_t node;
+  uint32_t mesh;
+};
+
+// Appends a node to the subtree of parent, which must be the subtree appended last to keep the depth first order
+uint32_t addSceneNode(SceneGraph& graph, int32_t parent, std::string name, const glm::vec3& translation, const glm::quat& rotation = glm::quat{1.f, 0.f, 0.f, 0.f}, const glm::vec3& scale = glm::vec3{1.f});
+// Appends node and its descendants below parent, with their aiNode transforms. Instances refer to meshes in the order
+// loadMeshesFromAiNode produces them, starting at firstMesh.
+uint32_t addSceneNodesFromAiNode(SceneGraph& graph, int32_t parent, const aiNode* node, uint32_t firstMesh, std::vector<SceneMeshInstance>& outInstances);
+
+void setLocalTranslation(SceneGraph& graph, uint32_t node, const glm::vec3& translation);
+void setLocalRotation(SceneGraph& graph, uint32_t node, const glm::quat& rotation);
+void setLocalScale(SceneGraph& graph, uint32_t node, const glm::vec3& scale);
+
+// Single pass over the nodes in order, recomputing world matrices of dirty nodes and their descendants with the batch
+// kernels of matrix_batch.hpp. Root subtrees are spread over the job system when there are enough nodes, serial when jobs is
+// null.
+void updateWorldMatrices(SceneGraph& graph, JobSystem* jobs = nullptr);
+// Same for nodes [begin, end), which have to be whole subtrees whose ancestors are up to date
+void updateWorldMatrices(SceneGraph& graph, uint32_t begin, uint32_t end);
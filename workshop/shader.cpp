@@ -0,0 +1,98 @@
+#include "shader.hpp"
+
+#include <array>
+#include <format>
+#include <iostream>
+#include <print>
+
+GLuint loadShaderStageSpirV(GLenum stage, std::span<const std::byte> binary, std::string_view name) {
+  int32_t success{};
+  constexpr uint32_t infoLogSize = 512;
+  char infoLog[512];
+
+  const GLuint shader = glCreateShader(stage);
+  glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V, binary.data(), static_cast<GLsizei>(binary.size()));
+  glSpecializeShader(shader, "main", 0, nullptr, nullptr);
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    glGetShaderInfoLog(shader, infoLogSize, nullptr, infoLog);
+    std::println(std::cerr, "ERROR::SHADER::STAGE_{:#x}::COMPILATION_FAILED {}\n{}", stage, name, infoLog);
+    glDeleteShader(shader);
+    return 0;
+  }
+
+  const GLuint program = glCreateProgram();
+  glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+  glAttachShader(program, shader);
+  glLinkProgram(program);
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  // Program keeps the linked executable, shader object is not needed anymore
+  glDetachShader(program, shader);
+  glDeleteShader(shader);
+  if (!success) {
+    glGetProgramInfoLog(program, infoLogSize, nullptr, infoLog);
+    std::println(std::cerr, "ERROR::SHADER::PROGRAM::LINKING_FAILED {}\n{}", name, infoLog);
+    glDeleteProgram(program);
+    return 0;
+  }
+
+  return program;
+}
+
+size_t PipelineStagesHash::operator()(const PipelineStages& stages) const {
+  // FNV-1a over stage program names
+  size_t hash = 14695981039346656037ull;
+  for (const GLuint name : {stages.vertex, stages.tessControl, stages.tessEvaluation, stages.geometry, stages.fragment, stages.compute}) {
+    hash ^= name;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+GLuint getOrCreateStageProgram(ProgramPipelineCache& cache, GLenum stage, const AssetPack& pack, std::string_view name) {
+  const std::string key = std::format("{}:{}", stage, name);
+  if (const auto it = cache.stagePrograms.find(key); it != cache.stagePrograms.end())
+    return it->second;
+
+  const std::span<const std::byte> binary = findAsset(pack, name);
+  if (binary.empty()) {
+    std::println("Shader {} is not in the asset pack.", name);
+    return 0;
+  }
+  const GLuint program = loadShaderStageSpirV(stage, binary, name);
+  if (program != 0)
+    cache.stagePrograms.emplace(key, program);
+  return program;
+}
+
+GLuint getOrCreateProgramPipeline(ProgramPipelineCache& cache, const PipelineStages& stages) {
+  if (const auto it = cache.pipelines.find(stages); it != cache.pipelines.end())
+    return it->second;
+
+  GLuint pipeline{};
+  glCreateProgramPipelines(1, &pipeline);
+  const std::array<std::pair<GLbitfield, GLuint>, 6> stageBits = {{
+      {GL_VERTEX_SHADER_BIT, stages.vertex},
+      {GL_TESS_CONTROL_SHADER_BIT, stages.tessControl},
+      {GL_TESS_EVALUATION_SHADER_BIT, stages.tessEvaluation},
+      {GL_GEOMETRY_SHADER_BIT, stages.geometry},
+      {GL_FRAGMENT_SHADER_BIT, stages.fragment},
+      {GL_COMPUTE_SHADER_BIT, stages.compute},
+  }};
+  for (const auto& [bit, program] : stageBits) {
+    if (program != 0)
+      glUseProgramStages(pipeline, bit, program);
+  }
+
+  cache.pipelines.emplace(stages, pipeline);
+  return pipeline;
+}
+
+void destroyProgramPipelineCache(ProgramPipelineCache& cache) {
+  for (const auto& [stages, pipeline] : cache.pipelines)
+    glDeleteProgramPipelines(1, &pipeline);
+  for (const auto& [key, program] : cache.stagePrograms)
+    glDeleteProgram(program);
+  cache.pipelines.clear();
+  cache.stagePrograms.clear();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "asset_pack.hpp"
+
+#include <glad/gl.h>
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Compile a single shader stage from SPIR-V binary into a GL_PROGRAM_SEPARABLE program. name is only used for logging
+// Return 0 on error
+GLuint loadShaderStageSpirV(GLenum stage, std::span<const std::byte> binary, std::string_view name);
+
+// Separable stage programs that are combined in a program pipeline object. 0 means stage is not used.
+struct PipelineStages {
+  GLuint vertex{};
+  GLuint tessControl{};
+  GLuint tessEvaluation{};
+  GLuint geometry{};
+  GLuint fragment{};
+  // Alone, for dispatches
+  GLuint compute{};
+
+  bool operator==(const PipelineStages&) const = default;
+};
+
+struct PipelineStagesHash {
+  size_t operator()(const PipelineStages& stages) const;
+};
+
+// Each stage is compiled and linked once, and stage combinations are only bound together at draw time via program pipelines.
+// Cheaper than linking a monolithic program per vertex/fragment pair.
+struct ProgramPipelineCache {
+  // keyed by "<stage>:<asset name>"
+  std::unordered_map<std::string, GLuint> stagePrograms;
+  std::unordered_map<PipelineStages, GLuint, PipelineStagesHash> pipelines;
+};
+
+// Return the separable program for given SPIR-V asset in the pack, compile it on first request
+// Return 0 on error
+GLuint getOrCreateStageProgram(ProgramPipelineCache& cache, GLenum stage, const AssetPack& pack, std::string_view name);
+// Return the program pipeline object for given stage combination, create it on first request
+GLuint getOrCreateProgramPipeline(ProgramPipelineCache& cache, const PipelineStages& stages);
+void destroyProgramPipelineCache(ProgramPipelineCache& cache);
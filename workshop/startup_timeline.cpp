@@ -0,0 +1,162 @@
+#include "startup_timeline.hpp"
+
+#include "cpu_profiler.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <print>
+#include <sstream>
+#include <string>
+
+namespace {
+int64_t readNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Time the process existed before this call, covering loading and static initialization. Negative when unknown.
+int64_t getNsSinceProcessStart() {
+#ifdef _WIN32
+  FILETIME creation{}, exit{}, kernel{}, user{}, now{};
+  if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+    return -1;
+  GetSystemTimePreciseAsFileTime(&now);
+  const auto toTicks = [](const FILETIME& time) { return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+  // FILETIME counts 100 ns ticks
+  return (toTicks(now) - toTicks(creation)) * 100;
+#else
+  // Field 22 is the start time in clock ticks since boot, fields after the parenthesized command name are split by spaces
+  std::ifstream stat("/proc/self/stat");
+  std::string line;
+  if (!std::getline(stat, line))
+    return -1;
+  const size_t commandEnd = line.rfind(')');
+  if (commandEnd == std::string::npos)
+    return -1;
+  std::istringstream fields(line.substr(commandEnd + 2));
+  std::string field;
+  for (int fieldIx = 3; fieldIx <= 22 && fields >> field; ++fieldIx) {}
+  timespec now{};
+  const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+  if (field.empty() || ticksPerSecond <= 0 || clock_gettime(CLOCK_BOOTTIME, &now) != 0)
+    return -1;
+  const int64_t startNs = std::stoll(field) * 1'000'000'000 / ticksPerSecond;
+  return std::max<int64_t>(now.tv_sec * 1'000'000'000 + now.tv_nsec - startNs, 0);
+#endif
+}
+}  // namespace
+
+void initStartupTimeline(StartupTimeline& timeline) {
+  timeline.mainStartNs = readNs();
+  const int64_t sinceProcessStart = getNsSinceProcessStart();
+  timeline.processStartNs = sinceProcessStart >= 0 ? timeline.mainStartNs - sinceProcessStart : timeline.mainStartNs;
+}
+
+void beginStartupPhase(StartupTimeline& timeline, const char* name) {
+  endStartupPhase(timeline);
+  timeline.cpuZoneRecorded = beginCpuZone(name);
+  timeline.phases.push_back({.name = name, .beginNs = readNs()});
+  timeline.phaseOpen = true;
+}
+
+void endStartupPhase(StartupTimeline& timeline) {
+  if (!timeline.phaseOpen)
+    return;
+  timeline.phases.back().endNs = readNs();
+  if (timeline.cpuZoneRecorded)
+    endCpuZone();
+  timeline.phaseOpen = timeline.cpuZoneRecorded = false;
+}
+
+void markStartupFirstSwap(StartupTimeline& timeline) {
+  if (timeline.firstSwapNs >= 0)
+    return;
+  endStartupPhase(timeline);
+  timeline.firstSwapNs = readNs();
+}
+
+double getStartupMs(const StartupTimeline& timeline, int64_t ns) {
+  return static_cast<double>(ns - timeline.processStartNs) * 1e-6;
+}
+
+void printStartupTimeline(const StartupTimeline& timeline) {
+  const int64_t endNs = timeline.firstSwapNs >= 0 ? timeline.firstSwapNs : (timeline.phases.empty() ? timeline.mainStartNs : timeline.phases.back().endNs);
+  const double totalMs = std::max(getStartupMs(timeline, endNs), 1e-6);
+  std::println("Startup: {:.1f} ms from process start to {}", totalMs, timeline.firstSwapNs >= 0 ? "the first swap" : "the last phase");
+  const auto printPhase = [&](const char* name, int64_t beginNs, int64_t phaseEndNs) {
+    const double durationMs = static_cast<double>(phaseEndNs - beginNs) * 1e-6;
+    std::println("  {:<24} at {:>9.1f} ms {:>9.1f} ms {:>5.1f}%", name, getStartupMs(timeline, beginNs), durationMs, 100.0 * durationMs / totalMs);
+  };
+  printPhase("Before main", timeline.processStartNs, timeline.mainStartNs);
+  for (const StartupPhase& phase : timeline.phases)
+    printPhase(phase.name, phase.beginNs, phase.endNs);
+}
+
+void drawStartupTimelineWindow(const StartupTimeline& timeline) {
+  ImGui::Begin("Startup");
+  if (timeline.firstSwapNs < 0) {
+    ImGui::TextUnformatted("Still starting up");
+    ImGui::End();
+    return;
+  }
+  const double totalMs = std::max(getStartupMs(timeline, timeline.firstSwapNs), 1e-6);
+  ImGui::Text("%.1f ms from process start to the first swap", totalMs);
+
+  constexpr ImGuiTableFlags kTableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit;
+  if (ImGui::BeginTable("Phases", 4, kTableFlags)) {
+    for (const char* column : {"Phase", "Start ms", "Duration ms", "Share"})
+      ImGui::TableSetupColumn(column);
+    ImGui::TableHeadersRow();
+    const auto drawRow = [&](const char* name, int64_t beginNs, int64_t endNs) {
+      const double durationMs = static_cast<double>(endNs - beginNs) * 1e-6;
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(name);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", getStartupMs(timeline, beginNs));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", durationMs);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f%%", 100.0 * durationMs / totalMs);
+    };
+    drawRow("Before main", timeline.processStartNs, timeline.mainStartNs);
+    for (const StartupPhase& phase : timeline.phases)
+      drawRow(phase.name, phase.beginNs, phase.endNs);
+    ImGui::EndTable();
+  }
+
+  // Phases are consecutive, so a single row shows where the time went
+  ImGui::SeparatorText("Timeline");
+  const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+  const ImVec2 origin = ImGui::GetCursorScreenPos();
+  const float width = std::max(ImGui::GetContentRegionAvail().x, 64.f);
+  const auto msToPixels = static_cast<float>(width / totalMs);
+  ImDrawList& drawList = *ImGui::GetWindowDrawList();
+  for (size_t phaseIx = 0; phaseIx < timeline.phases.size(); ++phaseIx) {
+    const StartupPhase& phase = timeline.phases[phaseIx];
+    const auto beginMs = static_cast<float>(getStartupMs(timeline, phase.beginNs));
+    const auto endMs = static_cast<float>(getStartupMs(timeline, phase.endNs));
+    const ImVec2 min{origin.x + beginMs * msToPixels, origin.y};
+    const ImVec2 max{std::max(origin.x + endMs * msToPixels, min.x + 1.f), min.y + rowHeight - 1.f};
+    const ImU32 color = ImGui::GetColorU32(ImVec4{0.3f + 0.15f * static_cast<float>(phaseIx % 4), 0.5f, 0.8f - 0.1f * static_cast<float>(phaseIx % 3), 1.f});
+    drawList.AddRectFilled(min, max, color);
+    drawList.PushClipRect(min, max, true);
+    drawList.AddText(ImVec2{min.x + 2.f, min.y}, IM_COL32_WHITE, phase.name);
+    drawList.PopClipRect();
+    if (ImGui::IsMouseHoveringRect(min, max))
+      ImGui::SetTooltip("%s: %.1f ms, starts at %.1f ms", phase.name, endMs - beginMs, beginMs);
+  }
+  ImGui::Dummy(ImVec2{width, rowHeight});
+  ImGui::End();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct StartupPhase {
+  // String literal
+  const char* name{};
+  int64_t beginNs{};
+  int64_t endNs{};
+};
+
+// Consecutive startup phases up to the first presented frame. Times are steady_clock nanoseconds.
+struct StartupTimeline {
+  // From the OS process creation time where available, otherwise the same as mainStartNs
+  int64_t processStartNs{};
+  int64_t mainStartNs{};
+  std::vector<StartupPhase> phases;
+  bool phaseOpen{};
+  // Whether the open phase also is a CPU profiler zone
+  bool cpuZoneRecorded{};
+  // Negative until the first frame was presented
+  int64_t firstSwapNs{-1};
+};
+
+// Call first thing in main
+void initStartupTimeline(StartupTimeline& timeline);
+// Ends the open phase, if any. Phases also show up as CPU profiler zones.
+void beginStartupPhase(StartupTimeline& timeline, const char* name);
+void endStartupPhase(StartupTimeline& timeline);
+// Ends the open phase at the first call, later calls do nothing
+void markStartupFirstSwap(StartupTimeline& timeline);
+
+double getStartupMs(const StartupTimeline& timeline, int64_t ns);
+// Phases with durations and their share of the time from process start to the first swap
+void printStartupTimeline(const StartupTimeline& timeline);
+void drawStartupTimelineWindow(const StartupTimeline& timeline);
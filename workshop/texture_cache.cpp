@@ -0,0 +1,116 @@
+#include "texture_cache.hpp"
+
+#include <cstring>
+#include <format>
+#include <print>
+#include <string>
+
+namespace {
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+template <typename T>
+uint64_t hashValue(uint64_t hash, const T& value) {
+  return hashBytes(hash, &value, sizeof(value));
+}
+}  // namespace
+
+uint64_t computeTextureCacheKey(std::span<const std::byte> sourceFile, std::span<const BcFormat> formatsByNumChannels, bool generateMips, const MipGeneratorOptions& mipOptions, const BcEncoderOptions& encoderOptions) {
+  uint64_t hash = hashBytes(kFnvOffsetBasis, sourceFile.data(), sourceFile.size());
+  hash = hashValue(hash, kTextureCacheVersion);
+  hash = hashBytes(hash, formatsByNumChannels.data(), formatsByNumChannels.size_bytes());
+  hash = hashValue(hash, generateMips);
+  hash = hashValue(hash, mipOptions.filter);
+  hash = hashValue(hash, mipOptions.srgb);
+  // SIMD kernels round differently from the scalar ones, so entries are only shared between machines taking the same path
+  hash = hashValue(hash, generateMips && usesSimdMipKernels(mipOptions));
+  hash = hashValue(hash, encoderOptions.refineIterations);
+  hash = hashValue(hash, usesSimdBcKernels(encoderOptions));
+  return hash;
+}
+
+std::filesystem::path getTextureCachePath(const std::filesystem::path& cacheDir, uint64_t key) {
+  return cacheDir / std::format("{:016x}.gwtc", key);
+}
+
+std::optional<CachedTextureInfo> openCachedTexture(const std::filesystem::path& path, uint64_t key, std::ifstream& outFile) {
+  outFile.open(path, std::ios::binary);
+  if (!outFile.is_open())
+    return std::nullopt;
+
+  TextureCacheHeader header{};
+  outFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!outFile.good() || std::memcmp(header.magic, kTextureCacheMagic, sizeof(kTextureCacheMagic)) != 0 || header.version != kTextureCacheVersion || header.key != key || header.format > static_cast<uint32_t>(BcFormat::BC7) || header.numLevels == 0 || header.numLevels > 32) {
+    std::println("Ignoring invalid texture cache entry {}", path.string());
+    return std::nullopt;
+  }
+
+  std::vector<TextureCacheLevel> levels(header.numLevels);
+  outFile.read(reinterpret_cast<char*>(levels.data()), static_cast<std::streamsize>(sizeof(TextureCacheLevel) * levels.size()));
+  if (!outFile.good()) {
+    std::println("Truncated texture cache entry {}", path.string());
+    return std::nullopt;
+  }
+
+  CachedTextureInfo info;
+  info.format = static_cast<BcFormat>(header.format);
+  info.width = header.width;
+  info.height = header.height;
+  for (const TextureCacheLevel& level : levels) {
+    if (level.offset != info.dataSize || level.size != computeBcImageSize(info.format, level.width, level.height)) {
+      std::println("Corrupt level table in texture cache entry {}", path.string());
+      return std::nullopt;
+    }
+    info.levels.push_back({level.width, level.height, static_cast<size_t>(level.offset)});
+    info.dataSize += static_cast<size_t>(level.size);
+  }
+  return info;
+}
+
+bool writeCachedTexture(const std::filesystem::path& path, uint64_t key, const CachedTextureInfo& info, std::span<const std::byte> data) {
+  std::error_code error;
+  std::filesystem::create_directories(path.parent_path(), error);
+  std::filesystem::path tmpPath = path;
+  tmpPath += ".tmp";
+  {
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      std::println("Error opening texture cache entry for writing: {}", tmpPath.string());
+      return false;
+    }
+    TextureCacheHeader header{};
+    std::memcpy(header.magic, kTextureCacheMagic, sizeof(kTextureCacheMagic));
+    header.version = kTextureCacheVersion;
+    header.key = key;
+    header.format = static_cast<uint32_t>(info.format);
+    header.width = info.width;
+    header.height = info.height;
+    header.numLevels = static_cast<uint32_t>(info.levels.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const MipLevel& level : info.levels) {
+      const TextureCacheLevel entry{level.width, level.height, level.offset, computeBcImageSize(info.format, level.width, level.height)};
+      out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!out.good()) {
+      std::println("Error writing texture cache entry: {}", tmpPath.string());
+      return false;
+    }
+  }
+  std::filesystem::rename(tmpPath, path, error);
+  if (error) {
+    std::println("Error renaming texture cache entry {}: {}", path.string(), error.message());
+    std::filesystem::remove(tmpPath, error);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "bcn_encoder.hpp"
+#include "mip_generator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Block compressed mip chains written next to each other, in the spirit of KTX2 but without its generality:
+//   TextureCacheHeader | TextureCacheLevel[numLevels] | level data, largest level first
+// Level offsets are from the beginning of the level data. Files are named by their key, which changes whenever the
+// source bytes or any setting affecting the output changes, so stale entries are never read, only left behind.
+constexpr char kTextureCacheMagic[4] = {'G', 'W', 'T', 'C'};
+// Bump when the encoder output changes
+constexpr uint32_t kTextureCacheVersion = 1;
+
+struct TextureCacheHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t key;
+  uint32_t format;
+  uint32_t width;
+  uint32_t height;
+  uint32_t numLevels;
+};
+
+struct TextureCacheLevel {
+  uint32_t width;
+  uint32_t height;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct CachedTextureInfo {
+  BcFormat format{};
+  uint32_t width{};
+  uint32_t height{};
+  std::vector<MipLevel> levels;
+  size_t dataSize{};
+};
+
+// formatsByNumChannels[n - 1] is the format used for images with n channels
+uint64_t computeTextureCacheKey(std::span<const std::byte> sourceFile, std::span<const BcFormat> formatsByNumChannels, bool generateMips, const MipGeneratorOptions& mipOptions, const BcEncoderOptions& encoderOptions);
+std::filesystem::path getTextureCachePath(const std::filesystem::path& cacheDir, uint64_t key);
+
+// Read header and level table, leaving file positioned at the level data so that it can be read straight into its
+// destination. Return nullopt if there is no valid entry for key.
+std::optional<CachedTextureInfo> openCachedTexture(const std::filesystem::path& path, uint64_t key, std::ifstream& outFile);
+// Written to a temporary file first and renamed, so that a concurrent reader never sees a partial entry
+bool writeCachedTexture(const std::filesystem::path& path, uint64_t key, const CachedTextureInfo& info, std::span<const std::byte> data);
@@ -0,0 +1,514 @@
+#include "texture_streamer.hpp"
+
+#include "asset_pack.hpp"
+#include "cpu_memory.hpp"
+#include "cpu_profiler.hpp"
+#include "gpu_memory.hpp"
+#include "texture_cache.hpp"
+
+#include <OpenImageIO/imageio.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <print>
+
+namespace {
+constexpr size_t kStagingAlignment = 16;
+
+// Caller holds streamer.mutex
+std::optional<StagingRegion> tryAllocateStaging(TextureStreamer& streamer, size_t size) {
+  if (streamer.stagingAllocations.empty())
+    streamer.stagingHead = 0;
+
+  std::optional<size_t> offset;
+  const size_t head = streamer.stagingHead;
+  if (streamer.stagingAllocations.empty()) {
+    offset = 0;
+  } else {
+    // Live allocations span [tail, head), wrapping around the end of the buffer when head <= tail
+    const size_t tail = streamer.stagingAllocations.front().region.offset;
+    if (head > tail) {
+      if (head + size <= streamer.stagingSize)
+        offset = head;
+      else if (size <= tail)
+        offset = 0;
+    } else if (head + size <= tail) {
+      offset = head;
+    }
+  }
+  if (!offset)
+    return std::nullopt;
+
+  const StagingRegion region{*offset, size};
+  streamer.stagingHead = std::min((region.offset + region.size + kStagingAlignment - 1) / kStagingAlignment * kStagingAlignment, streamer.stagingSize);
+  streamer.stagingUsed += size;
+  streamer.stagingAllocations.push_back({region});
+  return region;
+}
+
+// Caller holds streamer.mutex
+StagingAllocation& findStagingAllocation(TextureStreamer& streamer, const StagingRegion& region) {
+  auto it = std::ranges::find(streamer.stagingAllocations, region.offset, [](const StagingAllocation& alloc) { return alloc.region.offset; });
+  assert(it != streamer.stagingAllocations.end());
+  return *it;
+}
+
+// Caller holds streamer.mutex
+void retireStaging(TextureStreamer& streamer) {
+  while (!streamer.stagingAllocations.empty()) {
+    StagingAllocation& front = streamer.stagingAllocations.front();
+    if (!front.released) {
+      if (front.fence == nullptr)
+        break;
+      const GLenum status = glClientWaitSync(front.fence, 0, 0);
+      if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        break;
+      glDeleteSync(front.fence);
+    }
+    streamer.stagingUsed -= front.region.size;
+    streamer.stagingAllocations.pop_front();
+  }
+}
+
+// Never waits. Staging is only released on the GL thread, which may itself be waiting for jobs queued behind a
+// blocked worker. Without a region the image stays on the heap and updateTextureStreamer copies it in later.
+std::optional<StagingRegion> allocateStaging(TextureStreamer& streamer, size_t size) {
+  std::scoped_lock lock(streamer.mutex);
+  return tryAllocateStaging(streamer, size);
+}
+
+std::array<BcFormat, 4> getBcFormatsByNumChannels(const TextureStreamer& streamer) {
+  std::array<BcFormat, 4> formats{BcFormat::BC4, BcFormat::BC5, streamer.rgbFormat, streamer.rgbaFormat};
+  for (BcFormat& format : formats) {
+    if (!streamer.s3tcSupported && (format == BcFormat::BC1 || format == BcFormat::BC3))
+      format = BcFormat::BC7;
+  }
+  return formats;
+}
+
+GLenum getBcInternalFormat(BcFormat format) {
+  switch (format) {
+    case BcFormat::BC1:
+      return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BcFormat::BC3:
+      return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BcFormat::BC4:
+      return GL_COMPRESSED_RED_RGTC1;
+    case BcFormat::BC5:
+      return GL_COMPRESSED_RG_RGTC2;
+    case BcFormat::BC7:
+      return GL_COMPRESSED_RGBA_BPTC_UNORM;
+  }
+  return 0;
+}
+
+uint32_t getBcNumChannels(BcFormat format) {
+  switch (format) {
+    case BcFormat::BC4:
+      return 1;
+    case BcFormat::BC5:
+      return 2;
+    case BcFormat::BC1:
+      return 3;
+    default:
+      return 4;
+  }
+}
+
+void setCompressedFormat(DecodedImage& image, BcFormat format) {
+  image.internalFormat = getBcInternalFormat(format);
+  image.pixelFormat = 0;
+  image.blockBytes = getBcBlockBytes(format);
+}
+
+// Read a cached compressed chain straight into staging, or onto the heap when staging is full. Return false if there is
+// no usable entry.
+bool loadCachedTexture(TextureStreamer& streamer, DecodedImage& image, const std::filesystem::path& cachePath, uint64_t cacheKey) {
+  std::ifstream file;
+  std::optional<CachedTextureInfo> info = openCachedTexture(cachePath, cacheKey, file);
+  if (!info || info->dataSize > streamer.stagingSize)
+    return false;
+  const std::optional<StagingRegion> region = allocateStaging(streamer, info->dataSize);
+  if (!region)
+    image.pixels.resize(info->dataSize);
+  file.read(reinterpret_cast<char*>(region ? streamer.stagingData + region->offset : image.pixels.data()), static_cast<std::streamsize>(info->dataSize));
+  if (!file.good()) {
+    std::println("Truncated texture cache entry {}", cachePath.string());
+    image.pixels = {};
+    if (region) {
+      std::scoped_lock lock(streamer.mutex);
+      findStagingAllocation(streamer, *region).released = true;
+    }
+    return false;
+  }
+  image.width = info->width;
+  image.height = info->height;
+  image.numChannels = getBcNumChannels(info->format);
+  setCompressedFormat(image, info->format);
+  if (region)
+    image.staging = *region;
+  image.levels = std::move(info->levels);
+  return true;
+}
+
+void decodeTexture(TextureStreamer& streamer, StreamedTexture& tex) {
+  CPU_PROFILE_ZONE("Decode texture");
+  MemoryTagScope memoryTag(MemoryTag::Textures);
+  const auto finish = [&] {
+    std::scoped_lock lock(streamer.mutex);
+    streamer.decoded.push_back(&tex);
+  };
+
+  {
+    std::scoped_lock lock(streamer.mutex);
+    if (streamer.stopping)
+      return;
+  }
+
+  // Only tex.path and tex.decoded are touched here, the GL thread may be using the rest of a restreamed texture
+  DecodedImage& image = tex.decoded;
+  image = {};
+  const std::array<BcFormat, 4> bcFormats = getBcFormatsByNumChannels(streamer);
+  uint64_t cacheKey{};
+  std::filesystem::path cachePath;
+  if (streamer.compress && !streamer.cacheDir.empty()) {
+    std::vector<std::byte> sourceFile;
+    if (readBinaryFile(tex.path, sourceFile)) {
+      cacheKey = computeTextureCacheKey(sourceFile, bcFormats, streamer.generateMips, streamer.mipOptions, streamer.encoderOptions);
+      cachePath = getTextureCachePath(streamer.cacheDir, cacheKey);
+      if (loadCachedTexture(streamer, image, cachePath, cacheKey))
+        return finish();
+    }
+  }
+
+  auto inp = OIIO::ImageInput::open(tex.path.string());
+  if (!inp) {
+    std::println("Error loading texture file: {}", OIIO::geterror());
+    return finish();
+  }
+  const OIIO::ImageSpec& spec = inp->spec();
+  const auto width = static_cast<uint32_t>(spec.width);
+  const auto height = static_cast<uint32_t>(spec.height);
+  const auto numChannels = static_cast<uint32_t>(std::min(spec.nchannels, 4));
+  const size_t rowBytes = size_t{width} * numChannels;
+  const size_t sizeBytes = rowBytes * height;
+  if (sizeBytes == 0) {
+    std::println("Texture {} is empty", tex.path.string());
+    return finish();
+  }
+
+  // Uncompressed images without mips are decoded straight into the mapped staging buffer. Otherwise they are processed
+  // in a heap copy, because reading back from the staging buffer can be very slow when it is write-combined memory.
+  const bool processOnHeap = streamer.generateMips || streamer.compress;
+  std::vector<std::byte> chain;
+  std::vector<MipLevel> levels{{width, height, 0}};
+  std::byte* decodeDst{};
+  if (streamer.generateMips)
+    levels = computeMipChainLayout(width, height, numChannels);
+  if (processOnHeap) {
+    chain.resize(computeMipChainSize(levels, numChannels));
+    decodeDst = chain.data();
+  }
+  if (!processOnHeap && sizeBytes > streamer.stagingSize) {
+    std::println("Texture {} of {} bytes does not fit into the staging buffer of {} bytes", tex.path.string(), sizeBytes, streamer.stagingSize);
+    return finish();
+  }
+
+  std::optional<StagingRegion> region;
+  if (!processOnHeap) {
+    if ((region = allocateStaging(streamer, sizeBytes))) {
+      decodeDst = streamer.stagingData + region->offset;
+    } else {
+      chain.resize(sizeBytes);
+      decodeDst = chain.data();
+    }
+  }
+
+  // GL expects the bottom row first, so rows are written upwards
+  const bool ok = inp->read_image(0, 0, 0, static_cast<int>(numChannels), OIIO::TypeDesc::UINT8, decodeDst + rowBytes * (height - 1), OIIO::AutoStride, -static_cast<OIIO::stride_t>(rowBytes));
+  if (!ok) {
+    std::println("Error decoding texture file {}: {}", tex.path.string(), inp->geterror());
+    if (region) {
+      std::scoped_lock lock(streamer.mutex);
+      findStagingAllocation(streamer, *region).released = true;
+    }
+    return finish();
+  }
+
+  if (streamer.generateMips) {
+    // Gray and gray-alpha images are more likely masks than colors
+    MipGeneratorOptions mipOptions = streamer.mipOptions;
+    mipOptions.srgb = mipOptions.srgb && numChannels >= 3;
+    generateMipChain(chain, levels, numChannels, mipOptions, streamer.jobs);
+  }
+
+  static constexpr GLenum internalFormats[] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+  static constexpr GLenum pixelFormats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+  image.internalFormat = internalFormats[numChannels - 1];
+  image.pixelFormat = pixelFormats[numChannels - 1];
+  if (streamer.compress) {
+    const BcFormat format = bcFormats[numChannels - 1];
+    CachedTextureInfo info;
+    info.format = format;
+    info.width = width;
+    info.height = height;
+    for (const MipLevel& level : levels) {
+      info.levels.push_back({level.width, level.height, info.dataSize});
+      info.dataSize += computeBcImageSize(format, level.width, level.height);
+    }
+    std::vector<std::byte> blocks(info.dataSize);
+    for (size_t levelIx = 0; levelIx < levels.size(); ++levelIx) {
+      const MipLevel& level = levels[levelIx];
+      encodeBcImage(format, chain.data() + level.offset, level.width, level.height, numChannels, blocks.data() + info.levels[levelIx].offset, streamer.encoderOptions, streamer.jobs);
+    }
+    if (!cachePath.empty())
+      writeCachedTexture(cachePath, cacheKey, info, blocks);
+    setCompressedFormat(image, format);
+    chain = std::move(blocks);
+    levels = std::move(info.levels);
+  }
+
+  // Processed on the heap, or decoded there because staging was full
+  if (!region) {
+    if (chain.size() > streamer.stagingSize) {
+      std::println("Texture {} of {} bytes does not fit into the staging buffer of {} bytes", tex.path.string(), chain.size(), streamer.stagingSize);
+      return finish();
+    }
+    if ((region = allocateStaging(streamer, chain.size())))
+      std::memcpy(streamer.stagingData + region->offset, chain.data(), chain.size());
+    else
+      image.pixels = std::move(chain);
+  }
+
+  image.width = width;
+  image.height = height;
+  image.numChannels = numChannels;
+  if (region)
+    image.staging = *region;
+  image.levels = std::move(levels);
+  finish();
+}
+}  // namespace
+
+bool initTextureStreamer(TextureStreamer& streamer, size_t stagingSizeBytes, JobSystem& jobs) {
+  glCreateBuffers(1, &streamer.stagingBuffer);
+  constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  trackedNamedBufferStorage(GpuMemoryCategory::Staging, streamer.stagingBuffer, static_cast<GLsizeiptr>(stagingSizeBytes), nullptr, flags);
+  streamer.stagingData = static_cast<std::byte*>(glMapNamedBufferRange(streamer.stagingBuffer, 0, static_cast<GLsizeiptr>(stagingSizeBytes), flags));
+  if (streamer.stagingData == nullptr) {
+    std::println("Failed to map texture staging buffer {} of size {} persistently!", streamer.stagingBuffer, stagingSizeBytes);
+    trackedDeleteBuffers(1, &streamer.stagingBuffer);
+    streamer.stagingBuffer = 0;
+    return false;
+  }
+  streamer.stagingSize = stagingSizeBytes;
+  streamer.s3tcSupported = GLAD_GL_EXT_texture_compression_s3tc != 0;
+  streamer.jobs = &jobs;
+  return true;
+}
+
+const StreamedTexture& requestTexture(TextureStreamer& streamer, const std::filesystem::path& path) {
+  std::error_code error;
+  const std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, error);
+  const std::string key = (error ? path : canonicalPath).string();
+  if (const auto it = streamer.texturesByPath.find(key); it != streamer.texturesByPath.end())
+    return *it->second;
+
+  StreamedTexture& tex = *streamer.textures.emplace_back(std::make_unique<StreamedTexture>());
+  streamer.texturesByPath.emplace(key, &tex);
+  tex.path = path;
+  glCreateTextures(GL_TEXTURE_2D, 1, &tex.texture);
+  streamer.jobs->submit([&streamer, &tex] { decodeTexture(streamer, tex); }, &streamer.pendingDecodes);
+  return tex;
+}
+
+void updateTextureStreamer(TextureStreamer& streamer, size_t uploadBudgetBytes) {
+  CPU_PROFILE_ZONE("Update texture streamer");
+  MemoryTagScope memoryTag(MemoryTag::Textures);
+  std::deque<StreamedTexture*> newlyDecoded;
+  {
+    std::scoped_lock lock(streamer.mutex);
+    retireStaging(streamer);
+    newlyDecoded.swap(streamer.decoded);
+    streamer.stagingUsedLastFrame = streamer.stagingUsed;
+  }
+  // Decoded while staging was full. They get it in decode order, as it is released.
+  for (StreamedTexture* tex : newlyDecoded) {
+    if (!tex->decoded.pixels.empty())
+      streamer.waitingForStaging.push_back(tex);
+  }
+  std::erase_if(newlyDecoded, [](const StreamedTexture* tex) { return !tex->decoded.pixels.empty(); });
+  while (!streamer.waitingForStaging.empty()) {
+    StreamedTexture* tex = streamer.waitingForStaging.front();
+    DecodedImage& image = tex->decoded;
+    std::optional<StagingRegion> region;
+    {
+      std::scoped_lock lock(streamer.mutex);
+      region = tryAllocateStaging(streamer, image.pixels.size());
+      streamer.stagingUsedLastFrame = streamer.stagingUsed;
+    }
+    if (!region)
+      break;
+    std::memcpy(streamer.stagingData + region->offset, image.pixels.data(), image.pixels.size());
+    image.staging = *region;
+    image.pixels = {};
+    newlyDecoded.push_back(tex);
+    streamer.waitingForStaging.pop_front();
+  }
+
+  for (StreamedTexture* tex : newlyDecoded) {
+    DecodedImage& image = tex->decoded;
+    if (image.levels.empty()) {
+      // A failed restream leaves the texture with its resident levels
+      if (!tex->restreaming)
+        tex->state = TextureState::Failed;
+      tex->restreaming = false;
+      continue;
+    }
+    tex->width = image.width;
+    tex->height = image.height;
+    tex->numChannels = image.numChannels;
+    tex->internalFormat = image.internalFormat;
+    tex->pixelFormat = image.pixelFormat;
+    tex->blockBytes = image.blockBytes;
+    tex->levels = std::move(image.levels);
+    tex->staging = image.staging;
+    tex->uploadLevel = 0;
+    tex->uploadRow = 0;
+    // Immutable storage cannot grow, restreamed chains go into a new texture object
+    tex->uploadTexture = tex->texture;
+    if (tex->restreaming)
+      glCreateTextures(GL_TEXTURE_2D, 1, &tex->uploadTexture);
+    const auto numLevels = static_cast<GLsizei>(tex->levels.size());
+    trackedTextureStorage2D(GpuMemoryCategory::Textures, tex->uploadTexture, numLevels, tex->internalFormat, static_cast<GLsizei>(tex->width), static_cast<GLsizei>(tex->height));
+    glTextureParameteri(tex->uploadTexture, GL_TEXTURE_MIN_FILTER, numLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTextureParameteri(tex->uploadTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (!tex->restreaming)
+      tex->state = TextureState::Uploading;
+    streamer.uploading.push_back(tex);
+  }
+
+  size_t uploadedBytes = 0;
+  if (!streamer.uploading.empty()) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamer.stagingBuffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    while (!streamer.uploading.empty() && uploadedBytes < uploadBudgetBytes) {
+      StreamedTexture& tex = *streamer.uploading.front();
+      const MipLevel& level = tex.levels[tex.uploadLevel];
+      const bool compressed = tex.blockBytes != 0;
+      const uint32_t rowHeight = compressed ? 4 : 1;
+      const uint32_t levelRows = (level.height + rowHeight - 1) / rowHeight;
+      const size_t rowBytes = compressed ? size_t{(level.width + 3) / 4} * tex.blockBytes : size_t{level.width} * tex.numChannels;
+      // At least one row per call, so that a budget smaller than a row still makes progress
+      const auto numRows = static_cast<uint32_t>(std::min<size_t>(levelRows - tex.uploadRow, std::max<size_t>(1, (uploadBudgetBytes - uploadedBytes) / rowBytes)));
+      const size_t srcOffset = tex.staging.offset + level.offset + rowBytes * tex.uploadRow;
+      const auto y = static_cast<GLint>(tex.uploadRow * rowHeight);
+      // Last block row can be partial
+      const auto height = static_cast<GLsizei>(std::min(numRows * rowHeight, level.height - tex.uploadRow * rowHeight));
+      if (compressed)
+        glCompressedTextureSubImage2D(tex.uploadTexture, static_cast<GLint>(tex.uploadLevel), 0, y, static_cast<GLsizei>(level.width), height, tex.internalFormat, static_cast<GLsizei>(rowBytes * numRows), reinterpret_cast<const void*>(srcOffset));
+      else
+        glTextureSubImage2D(tex.uploadTexture, static_cast<GLint>(tex.uploadLevel), 0, y, static_cast<GLsizei>(level.width), height, tex.pixelFormat, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(srcOffset));
+      uploadedBytes += rowBytes * numRows;
+      tex.uploadRow += numRows;
+      if (tex.uploadRow < levelRows)
+        continue;
+
+      tex.uploadRow = 0;
+      if (++tex.uploadLevel < tex.levels.size())
+        continue;
+
+      // Staging region can be reused once the GPU is done copying from it
+      const GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      {
+        std::scoped_lock lock(streamer.mutex);
+        findStagingAllocation(streamer, tex.staging).fence = fence;
+      }
+      if (tex.uploadTexture != tex.texture) {
+        trackedDeleteTextures(1, &tex.texture);
+        tex.texture = tex.uploadTexture;
+      }
+      tex.firstResidentLevel = 0;
+      tex.restreaming = false;
+      tex.state = TextureState::Ready;
+      streamer.uploading.pop_front();
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+  streamer.uploadedBytesLastFrame = uploadedBytes;
+  recordCpuCounter("Texture upload bytes", static_cast<double>(uploadedBytes));
+}
+
+size_t evictTextureLevels([[maybe_unused]] TextureStreamer& streamer, StreamedTexture& tex, uint32_t numLevels) {
+  if (tex.state != TextureState::Ready || tex.restreaming)
+    return 0;
+  const auto numResident = static_cast<uint32_t>(tex.levels.size()) - tex.firstResidentLevel;
+  numLevels = std::min(numLevels, numResident - 1);
+  if (numLevels == 0)
+    return 0;
+
+  const uint32_t first = tex.firstResidentLevel + numLevels;
+  const MipLevel& top = tex.levels[first];
+  GLuint smaller{};
+  glCreateTextures(GL_TEXTURE_2D, 1, &smaller);
+  trackedTextureStorage2D(GpuMemoryCategory::Textures, smaller, static_cast<GLsizei>(numResident - numLevels), tex.internalFormat, static_cast<GLsizei>(top.width), static_cast<GLsizei>(top.height));
+  glTextureParameteri(smaller, GL_TEXTURE_MIN_FILTER, numResident - numLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTextureParameteri(smaller, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  // Whole levels, so partial blocks at the small end of compressed chains are fine
+  for (uint32_t levelIx = first; levelIx < tex.levels.size(); ++levelIx) {
+    const MipLevel& level = tex.levels[levelIx];
+    glCopyImageSubData(tex.texture, GL_TEXTURE_2D, static_cast<GLint>(levelIx - tex.firstResidentLevel), 0, 0, 0, smaller, GL_TEXTURE_2D, static_cast<GLint>(levelIx - first), 0, 0, 0, static_cast<GLsizei>(level.width), static_cast<GLsizei>(level.height), 1);
+  }
+
+  const size_t freed = computeTextureStorageSize(tex.internalFormat, tex.levels[tex.firstResidentLevel].width, tex.levels[tex.firstResidentLevel].height, 1, numResident) - computeTextureStorageSize(tex.internalFormat, top.width, top.height, 1, numResident - numLevels);
+  trackedDeleteTextures(1, &tex.texture);
+  tex.texture = smaller;
+  tex.firstResidentLevel = first;
+  return freed;
+}
+
+void restreamTexture(TextureStreamer& streamer, StreamedTexture& tex) {
+  if (tex.state != TextureState::Ready || tex.restreaming || tex.firstResidentLevel == 0)
+    return;
+  tex.restreaming = true;
+  // Compressed chains come back from the texture cache without being encoded again
+  streamer.jobs->submit([&streamer, &tex] { decodeTexture(streamer, tex); }, &streamer.pendingDecodes);
+}
+
+void destroyTextureStreamer(TextureStreamer& streamer) {
+  {
+    std::scoped_lock lock(streamer.mutex);
+    streamer.stopping = true;
+  }
+  // Decodes that have not started yet return once they see stopping
+  if (streamer.jobs != nullptr)
+    streamer.jobs->wait(streamer.pendingDecodes);
+  streamer.jobs = nullptr;
+
+  for (StagingAllocation& alloc : streamer.stagingAllocations) {
+    if (alloc.fence != nullptr)
+      glDeleteSync(alloc.fence);
+  }
+  streamer.stagingAllocations.clear();
+  streamer.decoded.clear();
+  streamer.waitingForStaging.clear();
+  streamer.uploading.clear();
+  for (const auto& tex : streamer.textures) {
+    if (tex->restreaming && tex->uploadTexture != tex->texture)
+      trackedDeleteTextures(1, &tex->uploadTexture);
+    trackedDeleteTextures(1, &tex->texture);
+  }
+  streamer.textures.clear();
+  streamer.texturesByPath.clear();
+  if (streamer.stagingBuffer != 0) {
+    glUnmapNamedBuffer(streamer.stagingBuffer);
+    trackedDeleteBuffers(1, &streamer.stagingBuffer);
+  }
+  streamer.stagingBuffer = 0;
+  streamer.stagingData = nullptr;
+}
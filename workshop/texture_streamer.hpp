@@ -0,0 +1,141 @@
+#pragma once
+
+#include "bcn_encoder.hpp"
+#include "mip_generator.hpp"
+#include "job_system.hpp"
+
+#include <glad/gl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class TextureState : uint8_t {
+  Decoding,
+  Uploading,
+  Ready,
+  Failed,
+};
+
+// Byte range of the staging buffer owned by a single texture until the GPU has consumed it
+struct StagingRegion {
+  size_t offset{};
+  size_t size{};
+};
+
+// Written by a worker while decoding, and applied to its StreamedTexture on the GL thread. Empty levels when decoding
+// failed.
+struct DecodedImage {
+  uint32_t width{};
+  uint32_t height{};
+  uint32_t numChannels{};
+  GLenum internalFormat{};
+  GLenum pixelFormat{};
+  uint32_t blockBytes{};
+  std::vector<MipLevel> levels;
+  StagingRegion staging;
+  // Whole chain, when staging was full at decode time. Copied into staging on the GL thread once there is room.
+  std::vector<std::byte> pixels;
+};
+
+struct StreamedTexture {
+  std::filesystem::path path;
+  // Created at request time so that it can be referred to before its storage exists. Replaced by a new texture object
+  // when levels are evicted or streamed back in.
+  GLuint texture{};
+  TextureState state{TextureState::Decoding};
+  uint32_t width{};
+  uint32_t height{};
+  uint32_t numChannels{};
+  GLenum internalFormat{};
+  // 0 for block compressed textures
+  GLenum pixelFormat{};
+  // 0 for uncompressed textures
+  uint32_t blockBytes{};
+  // Full mip chain, even when the top levels are not resident. offsets are relative to the staging region.
+  std::vector<MipLevel> levels;
+  StagingRegion staging;
+  // Upload cursor, in rows of the current level. Block compressed textures are uploaded in rows of 4x4 blocks.
+  uint32_t uploadLevel{};
+  uint32_t uploadRow{};
+  // Uploads go here. Same as texture, except while streaming evicted levels back in.
+  GLuint uploadTexture{};
+  // Level 0 of texture is levels[firstResidentLevel]
+  uint32_t firstResidentLevel{};
+  // Ready, and decoding or uploading the full chain again
+  bool restreaming{};
+  // Maintained by the residency manager
+  uint64_t lastUsedFrame{};
+  DecodedImage decoded;
+};
+
+struct StagingAllocation {
+  StagingRegion region;
+  // Set once the GL thread issued the last upload reading from the region
+  GLsync fence{};
+  // Set when decoding failed and the region was never handed to the GL thread
+  bool released{};
+};
+
+// Decodes images in jobs straight into a persistently mapped pixel unpack buffer, or onto the heap while it is full so
+// that jobs never wait for the GL thread. Uploads them into immutable texture storage on the GL thread at frame
+// boundaries, at most uploadBudgetBytes per frame.
+struct TextureStreamer {
+  GLuint stagingBuffer{};
+  std::byte* stagingData{};
+  size_t stagingSize{};
+  JobSystem* jobs{};
+  // Decodes in flight
+  JobCounter pendingDecodes;
+  // Build the full mip chain on the workers instead of calling glGenerateMipmap on the GL thread
+  bool generateMips{true};
+  MipGeneratorOptions mipOptions;
+  // Block compress on the workers. 1 and 2 channel images become BC4 and BC5.
+  bool compress{true};
+  BcFormat rgbFormat{BcFormat::BC1};
+  BcFormat rgbaFormat{BcFormat::BC7};
+  BcEncoderOptions encoderOptions;
+  // Compressed mip chains are cached here, keyed by a hash of the source file. No caching when empty.
+  std::filesystem::path cacheDir;
+  // BC1 and BC3 fall back to BC7 without EXT_texture_compression_s3tc
+  bool s3tcSupported{};
+
+  // Everything below is guarded by mutex
+  std::mutex mutex;
+  bool stopping{};
+  // Ring allocator over the staging buffer. Regions are released in allocation order.
+  std::deque<StagingAllocation> stagingAllocations;
+  size_t stagingHead{};
+  size_t stagingUsed{};
+  std::deque<StreamedTexture*> decoded;
+
+  // GL thread only
+  std::vector<std::unique_ptr<StreamedTexture>> textures;
+  // Each file is decoded and its mip chain is built only once
+  std::unordered_map<std::string, StreamedTexture*> texturesByPath;
+  // Decoded onto the heap, waiting for staging space
+  std::deque<StreamedTexture*> waitingForStaging;
+  std::deque<StreamedTexture*> uploading;
+  size_t uploadedBytesLastFrame{};
+  size_t stagingUsedLastFrame{};
+};
+
+bool initTextureStreamer(TextureStreamer& streamer, size_t stagingSizeBytes, JobSystem& jobs);
+// Start decoding an image file in the background, unless it was requested before.
+// Returned texture stays valid until the streamer is destroyed.
+const StreamedTexture& requestTexture(TextureStreamer& streamer, const std::filesystem::path& path);
+// Call once per frame on the GL thread
+void updateTextureStreamer(TextureStreamer& streamer, size_t uploadBudgetBytes);
+// Drop up to numLevels of the largest resident levels of a Ready texture, keeping at least one. The remaining levels are
+// copied into a smaller texture object. Return the number of bytes freed.
+size_t evictTextureLevels(TextureStreamer& streamer, StreamedTexture& tex, uint32_t numLevels);
+// Decode a texture with evicted levels again and swap in the full chain once it is uploaded. The texture stays usable
+// with its resident levels meanwhile.
+void restreamTexture(TextureStreamer& streamer, StreamedTexture& tex);
+void destroyTextureStreamer(TextureStreamer& streamer);
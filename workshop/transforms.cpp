@@ -0,0 +1,17 @@
+#include "transforms.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+std::vector<glm::mat4> makeGridTransforms(uint32_t cellCnt, float spacing) {
+  std::vector<glm::mat4> transforms;
+  transforms.reserve(size_t{cellCnt} * cellCnt);
+  for (uint32_t i = 0; i < cellCnt; ++i) {
+    for (uint32_t j = 0; j < cellCnt; ++j) {
+      const float x = static_cast<float>(i) - static_cast<float>(cellCnt) / 2.f;
+      const float y = static_cast<float>(j) - static_cast<float>(cellCnt) / 2.f;
+      const glm::vec3 pos = {x, 0.f, y};
+      transforms.push_back(glm::translate(glm::mat4(1), spacing * pos));
+    }
+  }
+  return transforms;
+}
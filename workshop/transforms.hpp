@@ -0,0 +1,9 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// World transforms of cellCnt x cellCnt instances on the XZ plane, centered around the origin, row major
+std::vector<glm::mat4> makeGridTransforms(uint32_t cellCnt, float spacing);
@@ -0,0 +1,446 @@
+#include "virtual_texture.hpp"
+
+#include "cpu_memory.hpp"
+#include "cpu_profiler.hpp"
+#include "gpu_memory.hpp"
+#include "mip_generator.hpp"
+
+#include <OpenImageIO/imageio.h>
+
+#include <algorithm>
+#include <cstring>
+#include <print>
+
+namespace {
+// Matches the std430 layout of VirtualTexturePageTable in virtual_texture.frag
+struct PageTableHeader {
+  uint32_t info[4];
+  uint32_t levels[kVtMaxLevels][4];
+};
+
+constexpr uint32_t kPageResidentBit = 1u << 31;
+
+uint32_t encodePageTableEntry(uint32_t slot, uint32_t slotsPerSide, uint32_t level) {
+  return (slot % slotsPerSide) | ((slot / slotsPerSide) << 8) | (level << 16) | kPageResidentBit;
+}
+
+void writeTile(const uint8_t* level, uint32_t width, uint32_t height, uint32_t tileX, uint32_t tileY, uint8_t* outTile) {
+  for (uint32_t py = 0; py < kVtTileStride; ++py) {
+    const auto sy = static_cast<uint32_t>(std::clamp<int64_t>(int64_t{tileY} * kVtTileSize + py - kVtTileBorder, 0, height - 1));
+    for (uint32_t px = 0; px < kVtTileStride; ++px) {
+      const auto sx = static_cast<uint32_t>(std::clamp<int64_t>(int64_t{tileX} * kVtTileSize + px - kVtTileBorder, 0, width - 1));
+      std::memcpy(outTile + (size_t{py} * kVtTileStride + px) * 4, level + (size_t{sy} * width + sx) * 4, 4);
+    }
+  }
+}
+
+// Every non-resident page points at its closest resident ancestor. Pages of the last level are always resident.
+void rebuildPageTable(VirtualTexture& vt) {
+  const auto numLevels = static_cast<uint32_t>(vt.levels.size());
+  for (uint32_t levelIx = numLevels; levelIx-- > 0;) {
+    const VirtualTextureLevel& level = vt.levels[levelIx];
+    for (uint32_t ty = 0; ty < level.tilesY; ++ty) {
+      for (uint32_t tx = 0; tx < level.tilesX; ++tx) {
+        const uint32_t page = level.firstPage + ty * level.tilesX + tx;
+        if (vt.pages[page].slot >= 0) {
+          vt.pageTable[page] = encodePageTableEntry(static_cast<uint32_t>(vt.pages[page].slot), vt.slotsPerSide, levelIx);
+          continue;
+        }
+        const VirtualTextureLevel& parent = vt.levels[levelIx + 1];
+        vt.pageTable[page] = vt.pageTable[parent.firstPage + std::min(ty / 2, parent.tilesY - 1) * parent.tilesX + std::min(tx / 2, parent.tilesX - 1)];
+      }
+    }
+  }
+  glNamedBufferSubData(vt.pageTableBuffer, sizeof(PageTableHeader), static_cast<GLsizeiptr>(sizeof(uint32_t) * vt.pageTable.size()), vt.pageTable.data());
+  vt.pageTableDirty = false;
+}
+
+// Mark the page and the ancestors that serve as its fallback as used in this frame
+void touchPage(VirtualTexture& vt, uint32_t levelIx, uint32_t tx, uint32_t ty) {
+  for (; levelIx < vt.levels.size(); ++levelIx, tx /= 2, ty /= 2) {
+    const VirtualTextureLevel& level = vt.levels[levelIx];
+    VirtualTexturePage& page = vt.pages[level.firstPage + std::min(ty, level.tilesY - 1) * level.tilesX + std::min(tx, level.tilesX - 1)];
+    if (page.lastUsedFrame >= vt.frame)
+      break;
+    page.lastUsedFrame = vt.frame;
+  }
+}
+
+int32_t acquireStagingSlot(VirtualTexture& vt) {
+  for (size_t slotIx = 0; slotIx < vt.stagingSlots.size(); ++slotIx) {
+    VirtualTextureStagingSlot& slot = vt.stagingSlots[slotIx];
+    if (slot.inUse)
+      continue;
+    if (slot.fence != nullptr) {
+      const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+      if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        continue;
+      glDeleteSync(slot.fence);
+      slot.fence = nullptr;
+    }
+    slot.inUse = true;
+    return static_cast<int32_t>(slotIx);
+  }
+  return -1;
+}
+
+void loadTile(VirtualTexture& vt, uint32_t page, uint32_t stagingSlot) {
+  CPU_PROFILE_ZONE("Load virtual texture tile");
+  MemoryTagScope memoryTag(MemoryTag::VirtualTexture);
+  bool ok{};
+  {
+    std::scoped_lock fileLock(vt.fileMutex);
+    vt.file.seekg(static_cast<std::streamoff>(vt.tilesOffset + kVtTileBytes * page));
+    vt.file.read(reinterpret_cast<char*>(vt.stagingData + kVtTileBytes * stagingSlot), kVtTileBytes);
+    ok = vt.file.good();
+    vt.file.clear();
+  }
+  if (!ok)
+    std::println("Error reading virtual texture page {}", page);
+  std::scoped_lock lock(vt.mutex);
+  vt.loaded.push_back({page, stagingSlot, ok});
+}
+
+void processFeedback(VirtualTexture& vt, const uint32_t* requested) {
+  vt.lastFeedbackFrame = vt.frame;
+  std::vector<uint32_t> missing;
+  uint32_t numRequested = 0;
+  // Coarse levels first, so that a close fallback becomes resident before the finer pages
+  for (uint32_t levelIx = static_cast<uint32_t>(vt.levels.size()); levelIx-- > 0;) {
+    const VirtualTextureLevel& level = vt.levels[levelIx];
+    for (uint32_t ty = 0; ty < level.tilesY; ++ty) {
+      for (uint32_t tx = 0; tx < level.tilesX; ++tx) {
+        const uint32_t page = level.firstPage + ty * level.tilesX + tx;
+        if (requested[page] == 0)
+          continue;
+        ++numRequested;
+        touchPage(vt, levelIx, tx, ty);
+        if (vt.pages[page].slot < 0 && !vt.pages[page].loading)
+          missing.push_back(page);
+      }
+    }
+  }
+  vt.requestedPagesLastReadback = numRequested;
+
+  for (const uint32_t page : missing) {
+    const int32_t stagingSlot = acquireStagingSlot(vt);
+    if (stagingSlot < 0)
+      break;
+    vt.pages[page].loading = true;
+    vt.jobs->submit([&vt, page, stagingSlot] { loadTile(vt, page, static_cast<uint32_t>(stagingSlot)); }, &vt.pendingLoads);
+  }
+}
+
+// Free slot, or the least recently used one not seen in the latest feedback. -1 if every slot is in view.
+int32_t acquirePhysicalSlot(VirtualTexture& vt) {
+  int32_t bestSlot = -1;
+  uint64_t bestFrame = vt.lastFeedbackFrame;
+  for (size_t slotIx = 0; slotIx < vt.slotPages.size(); ++slotIx) {
+    const int32_t page = vt.slotPages[slotIx];
+    if (page < 0)
+      return static_cast<int32_t>(slotIx);
+    if (vt.pages[page].lastUsedFrame < bestFrame) {
+      bestFrame = vt.pages[page].lastUsedFrame;
+      bestSlot = static_cast<int32_t>(slotIx);
+    }
+  }
+  if (bestSlot >= 0) {
+    vt.pages[vt.slotPages[bestSlot]].slot = -1;
+    vt.slotPages[bestSlot] = -1;
+    --vt.residentPages;
+    ++vt.evictedPagesLastFrame;
+  }
+  return bestSlot;
+}
+
+void uploadTile(VirtualTexture& vt, uint32_t page, uint32_t slot, const void* pixels) {
+  const auto x = static_cast<GLint>(slot % vt.slotsPerSide * kVtTileStride);
+  const auto y = static_cast<GLint>(slot / vt.slotsPerSide * kVtTileStride);
+  glTextureSubImage2D(vt.physicalTexture, 0, x, y, kVtTileStride, kVtTileStride, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  vt.pages[page].slot = static_cast<int32_t>(slot);
+  vt.slotPages[slot] = static_cast<int32_t>(page);
+  ++vt.residentPages;
+  vt.pageTableDirty = true;
+}
+}  // namespace
+
+bool cookVirtualTexture(const std::filesystem::path& imagePath, const std::filesystem::path& outPath, JobSystem* jobs) {
+  CPU_PROFILE_ZONE("Cook virtual texture");
+  MemoryTagScope memoryTag(MemoryTag::VirtualTexture);
+  auto inp = OIIO::ImageInput::open(imagePath.string());
+  if (!inp) {
+    std::println("Error loading texture file: {}", OIIO::geterror());
+    return false;
+  }
+  const OIIO::ImageSpec& spec = inp->spec();
+  const auto width = static_cast<uint32_t>(spec.width);
+  const auto height = static_cast<uint32_t>(spec.height);
+  const auto numChannels = static_cast<uint32_t>(std::min(spec.nchannels, 4));
+  if (size_t{width} * height == 0) {
+    std::println("Texture {} is empty", imagePath.string());
+    return false;
+  }
+
+  // Like the streamer, bottom row first
+  const size_t rowBytes = size_t{width} * numChannels;
+  std::vector<uint8_t> pixels(rowBytes * height);
+  if (!inp->read_image(0, 0, 0, static_cast<int>(numChannels), OIIO::TypeDesc::UINT8, pixels.data() + rowBytes * (height - 1), OIIO::AutoStride, -static_cast<OIIO::stride_t>(rowBytes))) {
+    std::println("Error decoding texture file {}: {}", imagePath.string(), inp->geterror());
+    return false;
+  }
+
+  std::vector<MipLevel> mipLevels = computeMipChainLayout(width, height, 4);
+  const auto lastLevel = std::ranges::find_if(mipLevels, [](const MipLevel& level) { return level.width <= kVtTileSize && level.height <= kVtTileSize; });
+  mipLevels.erase(lastLevel + 1, mipLevels.end());
+  if (mipLevels.size() > kVtMaxLevels) {
+    std::println("Texture {} is too large for a virtual texture with {} levels", imagePath.string(), kVtMaxLevels);
+    return false;
+  }
+  std::vector<std::byte> chain(computeMipChainSize(mipLevels, 4));
+  auto* base = reinterpret_cast<uint8_t*>(chain.data());
+  for (size_t i = 0; i < size_t{width} * height; ++i) {
+    const uint8_t* src = pixels.data() + i * numChannels;
+    uint8_t* dst = base + i * 4;
+    dst[0] = src[0];
+    dst[1] = numChannels >= 3 ? src[1] : src[0];
+    dst[2] = numChannels >= 3 ? src[2] : src[0];
+    dst[3] = numChannels == 4 ? src[3] : (numChannels == 2 ? src[1] : 255);
+  }
+  generateMipChain(chain, mipLevels, 4, {}, jobs);
+
+  std::vector<VirtualTextureLevel> levels;
+  uint32_t numPages = 0;
+  for (const MipLevel& mip : mipLevels) {
+    const VirtualTextureLevel& level = levels.emplace_back(mip.width, mip.height, (mip.width + kVtTileSize - 1) / kVtTileSize, (mip.height + kVtTileSize - 1) / kVtTileSize, numPages);
+    numPages += level.tilesX * level.tilesY;
+  }
+
+  std::error_code error;
+  std::filesystem::create_directories(outPath.parent_path(), error);
+  std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    std::println("Error opening virtual texture for writing: {}", outPath.string());
+    return false;
+  }
+  VirtualTextureHeader header{};
+  std::memcpy(header.magic, kVirtualTextureMagic, sizeof(kVirtualTextureMagic));
+  header.version = kVirtualTextureVersion;
+  header.width = width;
+  header.height = height;
+  header.numLevels = static_cast<uint32_t>(levels.size());
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(levels.data()), static_cast<std::streamsize>(sizeof(VirtualTextureLevel) * levels.size()));
+  std::vector<uint8_t> tile(kVtTileBytes);
+  for (size_t levelIx = 0; levelIx < levels.size(); ++levelIx) {
+    const VirtualTextureLevel& level = levels[levelIx];
+    for (uint32_t ty = 0; ty < level.tilesY; ++ty) {
+      for (uint32_t tx = 0; tx < level.tilesX; ++tx) {
+        writeTile(base + mipLevels[levelIx].offset, level.width, level.height, tx, ty, tile.data());
+        out.write(reinterpret_cast<const char*>(tile.data()), static_cast<std::streamsize>(tile.size()));
+      }
+    }
+  }
+  if (!out.good()) {
+    std::println("Error writing virtual texture: {}", outPath.string());
+    return false;
+  }
+  std::println("Cooked {} into {} pages over {} levels: {}", imagePath.string(), numPages, levels.size(), outPath.string());
+  return true;
+}
+
+bool initVirtualTexture(VirtualTexture& vt, const std::filesystem::path& cookedPath, JobSystem& jobs, uint32_t slotsPerSide, uint32_t numStagingTiles) {
+  vt.file.open(cookedPath, std::ios::binary);
+  if (!vt.file.is_open()) {
+    std::println("Error opening virtual texture: {}", cookedPath.string());
+    return false;
+  }
+  VirtualTextureHeader header{};
+  vt.file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!vt.file.good() || std::memcmp(header.magic, kVirtualTextureMagic, sizeof(kVirtualTextureMagic)) != 0 || header.version != kVirtualTextureVersion || header.numLevels == 0 || header.numLevels > kVtMaxLevels) {
+    std::println("Invalid virtual texture file: {}", cookedPath.string());
+    return false;
+  }
+  vt.levels.resize(header.numLevels);
+  vt.file.read(reinterpret_cast<char*>(vt.levels.data()), static_cast<std::streamsize>(sizeof(VirtualTextureLevel) * vt.levels.size()));
+  const VirtualTextureLevel& last = vt.levels.back();
+  vt.numPages = last.firstPage + last.tilesX * last.tilesY;
+  vt.tilesOffset = sizeof(VirtualTextureHeader) + sizeof(VirtualTextureLevel) * vt.levels.size();
+  std::error_code error;
+  if (!vt.file.good() || std::filesystem::file_size(cookedPath, error) < vt.tilesOffset + kVtTileBytes * vt.numPages) {
+    std::println("Truncated virtual texture file: {}", cookedPath.string());
+    return false;
+  }
+  vt.width = header.width;
+  vt.height = header.height;
+
+  const uint32_t numLastLevelPages = last.tilesX * last.tilesY;
+  const uint32_t numSlots = slotsPerSide * slotsPerSide;
+  if (slotsPerSide > 256 || numSlots <= numLastLevelPages) {
+    std::println("Physical virtual texture of {}x{} slots cannot hold the {} pages of the last level", slotsPerSide, slotsPerSide, numLastLevelPages);
+    return false;
+  }
+  vt.slotsPerSide = slotsPerSide;
+  const auto physicalSize = static_cast<GLsizei>(slotsPerSide * kVtTileStride);
+  glCreateTextures(GL_TEXTURE_2D, 1, &vt.physicalTexture);
+  trackedTextureStorage2D(GpuMemoryCategory::Textures, vt.physicalTexture, 1, GL_RGBA8, physicalSize, physicalSize);
+  glTextureParameteri(vt.physicalTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTextureParameteri(vt.physicalTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTextureParameteri(vt.physicalTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTextureParameteri(vt.physicalTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  PageTableHeader tableHeader{};
+  tableHeader.info[0] = vt.width;
+  tableHeader.info[1] = vt.height;
+  tableHeader.info[2] = header.numLevels;
+  tableHeader.info[3] = slotsPerSide;
+  for (size_t levelIx = 0; levelIx < vt.levels.size(); ++levelIx) {
+    tableHeader.levels[levelIx][0] = vt.levels[levelIx].tilesX;
+    tableHeader.levels[levelIx][1] = vt.levels[levelIx].tilesY;
+    tableHeader.levels[levelIx][2] = vt.levels[levelIx].firstPage;
+  }
+  glCreateBuffers(1, &vt.pageTableBuffer);
+  trackedNamedBufferStorage(GpuMemoryCategory::StorageBuffers, vt.pageTableBuffer, static_cast<GLsizeiptr>(sizeof(PageTableHeader) + sizeof(uint32_t) * vt.numPages), nullptr, GL_DYNAMIC_STORAGE_BIT);
+  glNamedBufferSubData(vt.pageTableBuffer, 0, sizeof(tableHeader), &tableHeader);
+
+  const auto feedbackBytes = static_cast<GLsizeiptr>(sizeof(uint32_t) * vt.numPages);
+  glCreateBuffers(1, &vt.feedbackBuffer);
+  trackedNamedBufferStorage(GpuMemoryCategory::StorageBuffers, vt.feedbackBuffer, feedbackBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+  glClearNamedBufferData(vt.feedbackBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+  constexpr GLbitfield readFlags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  for (VirtualTextureReadback& readback : vt.readbacks) {
+    glCreateBuffers(1, &readback.buffer);
+    trackedNamedBufferStorage(GpuMemoryCategory::Staging, readback.buffer, feedbackBytes, nullptr, readFlags);
+    readback.data = static_cast<const uint32_t*>(glMapNamedBufferRange(readback.buffer, 0, feedbackBytes, readFlags));
+  }
+
+  const auto stagingBytes = static_cast<GLsizeiptr>(kVtTileBytes * numStagingTiles);
+  constexpr GLbitfield writeFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glCreateBuffers(1, &vt.stagingBuffer);
+  trackedNamedBufferStorage(GpuMemoryCategory::Staging, vt.stagingBuffer, stagingBytes, nullptr, writeFlags);
+  vt.stagingData = static_cast<std::byte*>(glMapNamedBufferRange(vt.stagingBuffer, 0, stagingBytes, writeFlags));
+  if (vt.stagingData == nullptr || std::ranges::any_of(vt.readbacks, [](const VirtualTextureReadback& readback) { return readback.data == nullptr; })) {
+    std::println("Failed to map virtual texture staging or readback buffers persistently!");
+    destroyVirtualTexture(vt);
+    return false;
+  }
+  vt.stagingSlots.resize(numStagingTiles);
+
+  vt.pages.resize(vt.numPages);
+  vt.slotPages.assign(numSlots, -1);
+  vt.pageTable.resize(vt.numPages);
+
+  // The last level is read synchronously and pinned by a lastUsedFrame that never looks old
+  std::vector<std::byte> tile(kVtTileBytes);
+  for (uint32_t page = last.firstPage; page < vt.numPages; ++page) {
+    vt.file.seekg(static_cast<std::streamoff>(vt.tilesOffset + kVtTileBytes * page));
+    vt.file.read(reinterpret_cast<char*>(tile.data()), kVtTileBytes);
+    if (!vt.file.good()) {
+      std::println("Error reading virtual texture page {}", page);
+      destroyVirtualTexture(vt);
+      return false;
+    }
+    vt.pages[page].lastUsedFrame = UINT64_MAX;
+    uploadTile(vt, page, page - last.firstPage, tile.data());
+  }
+  rebuildPageTable(vt);
+
+  vt.jobs = &jobs;
+  return true;
+}
+
+void bindVirtualTexture(const VirtualTexture& vt) {
+  glBindTextureUnit(kVtPhysicalTextureUnit, vt.physicalTexture);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kVtPageTableBinding, vt.pageTableBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kVtFeedbackBinding, vt.feedbackBuffer);
+}
+
+void updateVirtualTexture(VirtualTexture& vt, uint32_t maxUploadsPerFrame) {
+  CPU_PROFILE_ZONE("Update virtual texture");
+  MemoryTagScope memoryTag(MemoryTag::VirtualTexture);
+  ++vt.frame;
+  vt.uploadedPagesLastFrame = 0;
+  vt.evictedPagesLastFrame = 0;
+
+  // Oldest copy in the ring. If the GPU has not caught up yet, feedback keeps accumulating until the next frame.
+  VirtualTextureReadback& readback = vt.readbacks[vt.readbackIx];
+  if (readback.fence != nullptr) {
+    const GLenum status = glClientWaitSync(readback.fence, 0, 0);
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+      glDeleteSync(readback.fence);
+      readback.fence = nullptr;
+      processFeedback(vt, readback.data);
+    }
+  }
+  if (readback.fence == nullptr) {
+    // Fragment shader writes to the feedback SSBO have to land before the copy
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glCopyNamedBufferSubData(vt.feedbackBuffer, readback.buffer, 0, 0, static_cast<GLsizeiptr>(sizeof(uint32_t) * vt.numPages));
+    glClearNamedBufferData(vt.feedbackBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    vt.readbackIx = (vt.readbackIx + 1) % static_cast<uint32_t>(vt.readbacks.size());
+  }
+
+  std::deque<LoadedTile> tiles;
+  {
+    std::scoped_lock lock(vt.mutex);
+    const size_t count = std::min<size_t>(maxUploadsPerFrame, vt.loaded.size());
+    tiles.assign(vt.loaded.begin(), vt.loaded.begin() + static_cast<std::ptrdiff_t>(count));
+    vt.loaded.erase(vt.loaded.begin(), vt.loaded.begin() + static_cast<std::ptrdiff_t>(count));
+  }
+  if (!tiles.empty()) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, vt.stagingBuffer);
+    for (const LoadedTile& tile : tiles) {
+      vt.pages[tile.page].loading = false;
+      VirtualTextureStagingSlot& stagingSlot = vt.stagingSlots[tile.stagingSlot];
+      stagingSlot.inUse = false;
+      // Pages that are dropped here are requested again by the next feedback that still sees them
+      const int32_t slot = tile.ok ? acquirePhysicalSlot(vt) : -1;
+      if (slot < 0)
+        continue;
+      uploadTile(vt, tile.page, static_cast<uint32_t>(slot), reinterpret_cast<const void*>(kVtTileBytes * tile.stagingSlot));
+      stagingSlot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      ++vt.uploadedPagesLastFrame;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+
+  if (vt.pageTableDirty)
+    rebuildPageTable(vt);
+}
+
+void destroyVirtualTexture(VirtualTexture& vt) {
+  // Loads in flight write into the staging buffer and the loaded queue
+  if (vt.jobs != nullptr)
+    vt.jobs->wait(vt.pendingLoads);
+  vt.jobs = nullptr;
+  vt.loaded.clear();
+  vt.file.close();
+
+  for (VirtualTextureReadback& readback : vt.readbacks) {
+    if (readback.fence != nullptr)
+      glDeleteSync(readback.fence);
+    if (readback.buffer != 0) {
+      glUnmapNamedBuffer(readback.buffer);
+      trackedDeleteBuffers(1, &readback.buffer);
+    }
+    readback = {};
+  }
+  for (VirtualTextureStagingSlot& slot : vt.stagingSlots) {
+    if (slot.fence != nullptr)
+      glDeleteSync(slot.fence);
+  }
+  vt.stagingSlots.clear();
+  if (vt.stagingBuffer != 0) {
+    glUnmapNamedBuffer(vt.stagingBuffer);
+    trackedDeleteBuffers(1, &vt.stagingBuffer);
+  }
+  trackedDeleteBuffers(1, &vt.pageTableBuffer);
+  trackedDeleteBuffers(1, &vt.feedbackBuffer);
+  trackedDeleteTextures(1, &vt.physicalTexture);
+  vt.stagingBuffer = vt.pageTableBuffer = vt.feedbackBuffer = vt.physicalTexture = 0;
+  vt.stagingData = nullptr;
+  vt.pages.clear();
+  vt.slotPages.clear();
+  vt.pageTable.clear();
+  vt.residentPages = 0;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "job_system.hpp"
+
+#include <glad/gl.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Cooked file layout:
+//   VirtualTextureHeader | VirtualTextureLevel[numLevels] | tiles, level by level, row by row, bottom row first
+// Every tile is kVtTileStride x kVtTileStride RGBA8 texels: kVtTileSize texels of payload surrounded by a border of
+// kVtTileBorder texels copied from the neighbors (clamped at the image edges), so that bilinear filtering in the
+// physical texture never bleeds into the neighboring slot. The last level is the first one that fits into one tile.
+constexpr char kVirtualTextureMagic[4] = {'G', 'W', 'V', 'T'};
+constexpr uint32_t kVirtualTextureVersion = 1;
+constexpr uint32_t kVtTileSize = 128;
+constexpr uint32_t kVtTileBorder = 2;
+constexpr uint32_t kVtTileStride = kVtTileSize + 2 * kVtTileBorder;
+constexpr size_t kVtTileBytes = size_t{kVtTileStride} * kVtTileStride * 4;
+constexpr uint32_t kVtMaxLevels = 16;
+
+struct VirtualTextureHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t numLevels;
+  uint32_t reserved;
+};
+
+struct VirtualTextureLevel {
+  uint32_t width;
+  uint32_t height;
+  uint32_t tilesX;
+  uint32_t tilesY;
+  // Pages are numbered across all levels, finest level first
+  uint32_t firstPage;
+};
+
+// Cut an image into tiles of its whole mip chain. Mips are built with the gamma-correct CPU generator.
+bool cookVirtualTexture(const std::filesystem::path& imagePath, const std::filesystem::path& outPath, JobSystem* jobs);
+
+// Shader side bindings, see virtual_texture.frag
+constexpr GLuint kVtPhysicalTextureUnit = 0;
+constexpr GLuint kVtPageTableBinding = 0;
+constexpr GLuint kVtFeedbackBinding = 1;
+
+struct VirtualTexturePage {
+  // Physical slot holding the page, -1 when not resident
+  int32_t slot{-1};
+  // A worker is reading the tile
+  bool loading{};
+  // Frame in which the page, or a finer page falling back to it, was last seen in the feedback
+  uint64_t lastUsedFrame{};
+};
+
+// Copy of the feedback buffer made at the end of a frame and read by the CPU a few frames later
+struct VirtualTextureReadback {
+  GLuint buffer{};
+  const uint32_t* data{};
+  GLsync fence{};
+};
+
+struct VirtualTextureStagingSlot {
+  // Set after the upload from this slot was issued
+  GLsync fence{};
+  bool inUse{};
+};
+
+struct LoadedTile {
+  uint32_t page{};
+  uint32_t stagingSlot{};
+  bool ok{};
+};
+
+// Page based virtual texture. The main pass marks the pages it samples in a feedback buffer, which is read back
+// asynchronously. Missing pages are read from the cooked file by jobs into a mapped staging buffer and copied into
+// free or least recently used slots of a fixed size physical texture. An indirection table maps every page to the
+// slot of the page itself or of its closest resident ancestor, so that GPU memory stays bounded by the physical texture
+// no matter how large the virtual one is.
+struct VirtualTexture {
+  // Cooked file
+  uint32_t width{};
+  uint32_t height{};
+  std::vector<VirtualTextureLevel> levels;
+  uint32_t numPages{};
+  size_t tilesOffset{};
+
+  uint32_t slotsPerSide{};
+  GLuint physicalTexture{};
+  // std430: uvec4 {width, height, numLevels, slotsPerSide}, uvec4 levels[kVtMaxLevels] {tilesX, tilesY, firstPage},
+  // uint entries[numPages]
+  GLuint pageTableBuffer{};
+  // One uint per page, non-zero when sampled
+  GLuint feedbackBuffer{};
+  std::array<VirtualTextureReadback, 3> readbacks{};
+  uint32_t readbackIx{};
+
+  GLuint stagingBuffer{};
+  std::byte* stagingData{};
+  std::vector<VirtualTextureStagingSlot> stagingSlots;
+
+  // Job side. Loads share the file, so reading a tile holds fileMutex.
+  JobSystem* jobs{};
+  JobCounter pendingLoads;
+  std::mutex fileMutex;
+  std::ifstream file;
+  std::mutex mutex;
+  std::deque<LoadedTile> loaded;
+
+  // GL thread only
+  std::vector<VirtualTexturePage> pages;
+  // Page held by each physical slot, -1 for free slots
+  std::vector<int32_t> slotPages;
+  std::vector<uint32_t> pageTable;
+  bool pageTableDirty{};
+  uint64_t frame{};
+  // Pages not seen since this frame's feedback are eviction candidates
+  uint64_t lastFeedbackFrame{};
+  uint32_t residentPages{};
+  uint32_t requestedPagesLastReadback{};
+  uint32_t uploadedPagesLastFrame{};
+  uint32_t evictedPagesLastFrame{};
+};
+
+// Pages of the last level are loaded right away and stay resident, so every lookup has a fallback
+bool initVirtualTexture(VirtualTexture& vt, const std::filesystem::path& cookedPath, JobSystem& jobs, uint32_t slotsPerSide = 16, uint32_t numStagingTiles = 32);
+void bindVirtualTexture(const VirtualTexture& vt);
+// Call once per frame on the GL thread, after all passes sampling the virtual texture
+void updateVirtualTexture(VirtualTexture& vt, uint32_t maxUploadsPerFrame);
+void destroyVirtualTexture(VirtualTexture& vt);